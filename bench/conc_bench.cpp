@@ -0,0 +1,211 @@
+#include <time.h>
+#include <pthread.h>
+
+#include "../src/list.h"
+#include "../src/list_conc.h"
+
+LogFileData log_file = {"log"};
+
+static const size_t THREADS[] = {1, 2, 4, 8, 16, 32, 64};
+static const size_t READ_PERCENTS[] = {100, 90, 50};
+
+static const size_t LIST_SIZE = 1000;   //< initial number of elements, keys are in [0, 2 * LIST_SIZE)
+
+static const double DEFAULT_DURATION = 0.2;     //< seconds for one measurement
+
+/**
+ * @brief Baseline: ENGINE_NODES list under one mutex
+ */
+struct LockedList {
+    List list = {};
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+};
+
+struct BenchThread {
+    pthread_t thread = {};
+
+    ListConc*   conc   = nullptr;
+    LockedList* locked = nullptr;
+
+    size_t read_percent = 0;
+    uint64_t rand = 0;
+
+    const int* is_stopped = nullptr;
+    size_t ops = 0;
+};
+
+static double time_now_() {
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rand_next_(uint64_t* state) {
+    // xorshift64
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+/**
+ * @brief Read - search of random key. Write - key is deleted if it is found, otherwise it is inserted
+ * after random key (at the beginning if there is no such key), so list size stays around LIST_SIZE
+ */
+static void conc_op_(BenchThread* data) {
+    uint64_t r = rand_next_(&data->rand);
+    Elem_t key = (Elem_t)((r >> 8) % (2 * LIST_SIZE));
+
+    list_conc_enter();
+
+    ListConcNode* ptr = nullptr;
+    list_find_by_value(data->conc, key, &ptr);
+
+    if (r % 100 >= data->read_percent) {
+        if (ptr != nullptr) {
+            list_delete(data->conc, ptr);
+        } else {
+            ListConcNode* pos = nullptr;
+            list_find_by_value(data->conc, (Elem_t)((r >> 32) % (2 * LIST_SIZE)), &pos);
+
+            if (list_insert_after(data->conc, pos, key) != List::OK)
+                list_pushfront(data->conc, key);
+        }
+    }
+
+    list_conc_exit();
+}
+
+static void locked_op_(BenchThread* data) {
+    uint64_t r = rand_next_(&data->rand);
+    Elem_t key = (Elem_t)((r >> 8) % (2 * LIST_SIZE));
+
+    pthread_mutex_lock(&data->locked->mutex);
+
+    List* list = &data->locked->list;
+
+    ListNode* ptr = nullptr;
+    list_find_by_value(list, key, &ptr);
+
+    if (r % 100 >= data->read_percent) {
+        if (ptr != nullptr) {
+            list_delete(list, ptr);
+        } else {
+            ListNode* pos = nullptr;
+            list_find_by_value(list, (Elem_t)((r >> 32) % (2 * LIST_SIZE)), &pos);
+
+            ListNode* inserted = nullptr;
+            list_insert_after(list, pos, key, &inserted);
+        }
+    }
+
+    pthread_mutex_unlock(&data->locked->mutex);
+}
+
+static void* bench_thread_(void* arg) {
+    BenchThread* data = (BenchThread*)arg;
+
+    while (!__atomic_load_n(data->is_stopped, __ATOMIC_RELAXED)) {
+        if (data->conc != nullptr)
+            conc_op_(data);
+        else
+            locked_op_(data);
+
+        data->ops++;
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Runs threads for duration seconds
+ *
+ * @return double operations per second
+ */
+static double bench_run_(ListConc* conc, LockedList* locked, const size_t threads_cnt,
+                         const size_t read_percent, const double duration) {
+    BenchThread threads[64] = {};
+    int is_stopped = 0;
+
+    size_t started = 0;
+    for (; started < threads_cnt; started++) {
+        threads[started].conc = conc;
+        threads[started].locked = locked;
+        threads[started].read_percent = read_percent;
+        threads[started].rand = 0x9E3779B97F4A7C15ull * (started + 1);
+        threads[started].is_stopped = &is_stopped;
+
+        if (pthread_create(&threads[started].thread, nullptr, bench_thread_, &threads[started]) != 0)
+            break;
+    }
+
+    double begin = time_now_();
+
+    timespec sleep_time = {(time_t)duration, (long)((duration - (double)(time_t)duration) * 1e9)};
+    nanosleep(&sleep_time, nullptr);
+
+    __atomic_store_n(&is_stopped, 1, __ATOMIC_RELAXED);
+
+    size_t ops = 0;
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i].thread, nullptr);
+        ops += threads[i].ops;
+    }
+
+    double time = time_now_() - begin;
+
+    if (started != threads_cnt)
+        fprintf(stderr, "only %zu threads started\n", started);
+
+    return (double)ops / time;
+}
+
+int main(int argc, const char* argv[]) {
+    double duration = DEFAULT_DURATION;
+    if (argc > 1)
+        duration = atof(argv[1]);
+
+    printf("list size %zu, %.2f s per measurement\n\n", LIST_SIZE, duration);
+    printf("%8s %8s %16s %16s %8s\n", "threads", "read, %", "mutex, ops/s", "conc, ops/s", "speedup");
+
+    Elem_t elems[LIST_SIZE] = {};
+    for (size_t i = 0; i < LIST_SIZE; i++)
+        elems[i] = (Elem_t)(2 * i);
+
+    for (size_t read_i = 0; read_i < sizeof(READ_PERCENTS) / sizeof(*READ_PERCENTS); read_i++) {
+        for (size_t threads_i = 0; threads_i < sizeof(THREADS) / sizeof(*THREADS); threads_i++) {
+            size_t threads_cnt = THREADS[threads_i];
+            size_t read_percent = READ_PERCENTS[read_i];
+
+            LockedList locked = {};
+            list_ctor(&locked.list, List::ENGINE_NODES);
+            list_set_verify_level(&locked.list, List::VERIFY_OFF);
+            list_from_array(&locked.list, elems, LIST_SIZE);
+
+            double locked_ops = bench_run_(nullptr, &locked, threads_cnt, read_percent, duration);
+
+            list_dtor(&locked.list);
+
+            ListConc conc = {};
+            list_ctor(&conc);
+            for (size_t i = 0; i < LIST_SIZE; i++)
+                list_pushback(&conc, elems[i]);
+
+            double conc_ops = bench_run_(&conc, nullptr, threads_cnt, read_percent, duration);
+
+            if (list_verify(&conc) != List::OK)
+                fprintf(stderr, "verification failed\n");
+
+            list_dtor(&conc);
+
+            printf("%8zu %8zu %16.0f %16.0f %8.2f\n", threads_cnt, read_percent,
+                   locked_ops, conc_ops, conc_ops / locked_ops);
+        }
+
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,778 @@
+#include <time.h>
+#include <string.h>
+
+#include "../src/list.h"
+
+LogFileData log_file = {"log"};
+
+/**
+ * @brief Benchmark settings (command line)
+ */
+struct BenchSettings {
+    static const size_t MAX_SIZES = 16;
+
+    size_t sizes[MAX_SIZES] = {10, 100, 1000, 10000, 100000, 1000000, 10000000};
+    size_t sizes_cnt = 7;
+
+    bool engines[2] = {true, true};     //< ENGINE_NODES, ENGINE_ARRAY
+
+    List::VerifyLevel verify_level = List::VERIFY_OFF;
+
+    bool order_index = false;
+    bool value_index = false;
+
+    List::DumpFormat dump_format = List::DUMP_BINARY;
+
+    double time = 0.05;                 //< seconds for one measurement (untimed preparation included)
+
+    const char* ops = nullptr;          //< comma separated names of measured operations, nullptr - all
+    const char* json = nullptr;         //< json results file
+};
+
+/**
+ * @brief Limits of one measurement
+ */
+struct BenchLimits {
+    static const size_t MAX_BATCH   = 4096;     //< operations in one timed sample
+    static const size_t MIN_SAMPLES = 5;
+    static const size_t MAX_SAMPLES = 1000;
+
+    static constexpr double MIN_SAMPLE_TIME = 20e-6;   //< batch is doubled until sample takes that long
+
+    static const size_t MAX_BINARY_DUMP_SIZE = 100000;
+    static const size_t MAX_HTML_DUMP_SIZE   = 1000;
+};
+
+/**
+ * @brief Measured list and its helper arrays. Every operation leaves list with n elements
+ * with values [0, n) (mutations are undone out of timed part)
+ */
+struct BenchList {
+    List list = {};
+    size_t n = 0;
+
+    Elem_t* values = nullptr;       //< [0, n) in initial order
+
+    ListNode** handles = nullptr;   //< all handles in logical order (if not dirty)
+    bool is_dirty = true;
+
+    ListNode** scratch = nullptr;   //< MAX_BATCH handles
+    Elem_t*    elems   = nullptr;   //< MAX_BATCH values
+
+    size_t seq_i = 0;               //< position of sequential access pattern
+    uint64_t rand = 0x9E3779B97F4A7C15ull;
+};
+
+typedef double (*BenchOpFunc)(BenchList* bench, size_t batch, bool is_random);
+
+/**
+ * @brief Measured operation. Function returns time of timed part
+ */
+struct BenchOp {
+    const char* name = nullptr;
+    BenchOpFunc func = nullptr;
+
+    bool has_random  = false;   //< random and sequential patterns are measured
+    bool is_mutating = false;   //< batch is limited by list size
+    bool is_shrinking = false;  //< batch can't be greater than list size
+    bool is_single   = false;   //< one operation per sample
+};
+
+/**
+ * @brief Result of one measurement
+ */
+struct BenchResult {
+    double median = 0;      //< seconds per operation
+    double p99    = 0;
+    double ops_per_sec = 0;
+
+    size_t samples = 0;
+    size_t batch   = 0;
+};
+
+static volatile size_t bench_sink = 0;     //< results of read operations, so they are not optimised out
+
+static double time_now_() {
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rand_next_(BenchList* bench) {
+    // xorshift64
+    bench->rand ^= bench->rand << 13;
+    bench->rand ^= bench->rand >> 7;
+    bench->rand ^= bench->rand << 17;
+
+    return bench->rand;
+}
+
+static size_t rand_index_(BenchList* bench) {
+    return (size_t)(rand_next_(bench) % bench->n);
+}
+
+/**
+ * @brief Collects handles in logical order if they were invalidated
+ */
+static void bench_handles_(BenchList* bench) {
+    if (!bench->is_dirty)
+        return;
+
+    ListNode* ptr = bench->list.head;
+    for (size_t i = 0; i < bench->n && ptr != nullptr; i++) {
+        bench->handles[i] = ptr;
+        ptr = list_node_next(&bench->list, ptr);
+    }
+
+    bench->is_dirty = false;
+}
+
+static double op_insert_after_(BenchList* bench, size_t batch, bool is_random) {
+    bench_handles_(bench);
+
+    for (size_t i = 0; i < batch; i++)
+        bench->scratch[i] = bench->handles[is_random ? rand_index_(bench) : bench->seq_i % bench->n];
+
+    bench->seq_i++;
+
+    ListNode* pos = bench->scratch[0];
+
+    double begin = time_now_();
+
+    for (size_t i = 0; i < batch; i++) {
+        if (is_random)
+            pos = bench->scratch[i];
+
+        list_insert_after(&bench->list, pos, (Elem_t)(bench->n + i), &bench->scratch[i]);
+
+        // sequential pattern: every element is inserted after the previous one
+        pos = bench->scratch[i];
+    }
+
+    double time = time_now_() - begin;
+
+    for (size_t i = 0; i < batch; i++)
+        list_delete(&bench->list, bench->scratch[i]);
+
+    return time;
+}
+
+// the same insertions as op_insert_after_, applied by one transaction
+static double op_txn_insert_after_(BenchList* bench, size_t batch, bool is_random) {
+    bench_handles_(bench);
+
+    for (size_t i = 0; i < batch; i++)
+        bench->scratch[i] = bench->handles[is_random ? rand_index_(bench) : bench->seq_i % bench->n];
+
+    bench->seq_i++;
+
+    ListNode* pos = bench->scratch[0];
+    ListTxn txn = {};
+
+    double begin = time_now_();
+
+    list_txn_begin(&bench->list, &txn, batch);
+
+    for (size_t i = 0; i < batch; i++) {
+        if (is_random)
+            pos = bench->scratch[i];
+
+        list_txn_insert_after(&txn, pos, (Elem_t)(bench->n + i), &bench->scratch[i]);
+
+        pos = bench->scratch[i];
+    }
+
+    list_txn_commit(&txn);
+
+    double time = time_now_() - begin;
+
+    for (size_t i = 0; i < batch; i++)
+        list_delete(&bench->list, bench->scratch[i]);
+
+    return time;
+}
+
+static double op_pushback_(BenchList* bench, size_t batch, bool) {
+    double begin = time_now_();
+
+    for (size_t i = 0; i < batch; i++)
+        list_pushback(&bench->list, (Elem_t)(bench->n + i), &bench->scratch[i]);
+
+    double time = time_now_() - begin;
+
+    for (size_t i = 0; i < batch; i++)
+        list_delete(&bench->list, bench->scratch[i]);
+
+    return time;
+}
+
+static double op_pushfront_(BenchList* bench, size_t batch, bool) {
+    double begin = time_now_();
+
+    for (size_t i = 0; i < batch; i++)
+        list_pushfront(&bench->list, (Elem_t)(bench->n + i), &bench->scratch[i]);
+
+    double time = time_now_() - begin;
+
+    for (size_t i = 0; i < batch; i++)
+        list_delete(&bench->list, bench->scratch[i]);
+
+    return time;
+}
+
+static double op_delete_(BenchList* bench, size_t batch, bool is_random) {
+    bench_handles_(bench);
+
+    // random pattern: distinct victims are chosen by partial shuffle
+    for (size_t i = 0; i < batch; i++) {
+        if (is_random) {
+            size_t j = i + (size_t)(rand_next_(bench) % (bench->n - i));
+
+            ListNode* tmp = bench->handles[i];
+            bench->handles[i] = bench->handles[j];
+            bench->handles[j] = tmp;
+        }
+
+        bench->scratch[i] = bench->handles[i];
+        bench->elems[i] = list_node_elem(&bench->list, bench->scratch[i]);
+    }
+
+    double begin = time_now_();
+
+    for (size_t i = 0; i < batch; i++)
+        list_delete(&bench->list, bench->scratch[i]);
+
+    double time = time_now_() - begin;
+
+    ListNode* inserted = nullptr;
+    for (size_t i = 0; i < batch; i++)
+        list_pushback(&bench->list, bench->elems[i], &inserted);
+
+    bench->is_dirty = true;
+
+    return time;
+}
+
+static double op_clear_(BenchList* bench, size_t, bool) {
+    double begin = time_now_();
+
+    list_clear(&bench->list);
+
+    double time = time_now_() - begin;
+
+    list_from_array(&bench->list, bench->values, bench->n);
+
+    bench->is_dirty = true;
+
+    return time;
+}
+
+static double op_find_by_value_(BenchList* bench, size_t batch, bool is_random) {
+    for (size_t i = 0; i < batch; i++)
+        bench->elems[i] = (Elem_t)(is_random ? rand_index_(bench) : bench->seq_i++ % bench->n);
+
+    size_t found = 0;
+
+    double begin = time_now_();
+
+    for (size_t i = 0; i < batch; i++) {
+        ListNode* ptr = nullptr;
+        list_find_by_value(&bench->list, bench->elems[i], &ptr);
+
+        found += ptr != nullptr;
+    }
+
+    double time = time_now_() - begin;
+
+    bench_sink = bench_sink + found;
+
+    return time;
+}
+
+static double op_find_by_logical_index_(BenchList* bench, size_t batch, bool is_random) {
+    for (size_t i = 0; i < batch; i++)
+        bench->elems[i] = (Elem_t)(is_random ? rand_index_(bench) : bench->seq_i++ % bench->n);
+
+    size_t found = 0;
+
+    double begin = time_now_();
+
+    for (size_t i = 0; i < batch; i++) {
+        ListNode* ptr = nullptr;
+        list_find_by_logical_index(&bench->list, (ssize_t)bench->elems[i], &ptr);
+
+        found += ptr != nullptr;
+    }
+
+    double time = time_now_() - begin;
+
+    bench_sink = bench_sink + found;
+
+    return time;
+}
+
+static double op_logical_index_by_ptr_(BenchList* bench, size_t batch, bool is_random) {
+    bench_handles_(bench);
+
+    for (size_t i = 0; i < batch; i++)
+        bench->scratch[i] = bench->handles[is_random ? rand_index_(bench) : bench->seq_i++ % bench->n];
+
+    ssize_t sum = 0;
+
+    double begin = time_now_();
+
+    for (size_t i = 0; i < batch; i++) {
+        ssize_t logical_i = 0;
+        list_logical_index_by_ptr(&bench->list, bench->scratch[i], &logical_i);
+
+        sum += logical_i;
+    }
+
+    double time = time_now_() - begin;
+
+    bench_sink = bench_sink + (size_t)sum;
+
+    return time;
+}
+
+static bool bench_is_odd_(void*, const Elem_t elem) {
+    return elem % 2 != 0;
+}
+
+// half of elements are removed in one walk, list is rebuilt between samples
+static double op_remove_if_(BenchList* bench, size_t, bool) {
+    double begin = time_now_();
+
+    list_remove_if(&bench->list, bench_is_odd_, nullptr);
+
+    double time = time_now_() - begin;
+
+    list_from_array(&bench->list, bench->values, bench->n);
+
+    bench->is_dirty = true;
+
+    return time;
+}
+
+// sort of shuffled list (values are shuffled and restored between samples)
+static double op_sort_(BenchList* bench, size_t, bool) {
+    for (size_t i = bench->n - 1; i > 0; i--) {
+        size_t j = (size_t)(rand_next_(bench) % (i + 1));
+
+        Elem_t tmp = bench->values[i];
+        bench->values[i] = bench->values[j];
+        bench->values[j] = tmp;
+    }
+
+    list_from_array(&bench->list, bench->values, bench->n);
+
+    double begin = time_now_();
+
+    list_sort(&bench->list);
+
+    double time = time_now_() - begin;
+
+    for (size_t i = 0; i < bench->n; i++)
+        bench->values[i] = (Elem_t)i;
+
+    list_from_array(&bench->list, bench->values, bench->n);
+
+    bench->is_dirty = true;
+
+    return time;
+}
+
+// full traversal with cursor (see List::prefetch_distance)
+// nodes are scattered by sorting shuffled elements, then linearized
+static double op_linearize_(BenchList* bench, size_t, bool) {
+    for (size_t i = bench->n - 1; i > 0; i--) {
+        size_t j = (size_t)(rand_next_(bench) % (i + 1));
+
+        Elem_t tmp = bench->values[i];
+        bench->values[i] = bench->values[j];
+        bench->values[j] = tmp;
+    }
+
+    list_from_array(&bench->list, bench->values, bench->n);
+    list_sort(&bench->list);
+
+    double begin = time_now_();
+
+    list_linearize(&bench->list);
+
+    double time = time_now_() - begin;
+
+    for (size_t i = 0; i < bench->n; i++)
+        bench->values[i] = (Elem_t)i;
+
+    list_from_array(&bench->list, bench->values, bench->n);
+
+    bench->is_dirty = true;
+
+    return time;
+}
+
+static double op_walk_(BenchList* bench, size_t, bool) {
+    size_t sum = 0;
+
+    double begin = time_now_();
+
+    for (ListNode* ptr : list_range(&bench->list))
+        sum += (size_t)list_node_elem(&bench->list, ptr);
+
+    double time = time_now_() - begin;
+
+    bench_sink = bench_sink + sum;
+
+    return time;
+}
+
+#ifdef DEBUG
+
+// dumps exist only in debug build
+static double op_dump_(BenchList* bench, size_t, bool) {
+    double begin = time_now_();
+
+    list_dump(&bench->list, VAR_CODE_DATA(bench->list));
+
+    return time_now_() - begin;
+}
+
+#endif //< #ifdef DEBUG
+
+static const BenchOp BENCH_OPS[] = {
+    {"insert_after",            op_insert_after_,          true,  true,  false, false},
+    {"txn_insert_after",        op_txn_insert_after_,      true,  true,  false, false},
+    {"pushback",                op_pushback_,              false, true,  false, false},
+    {"pushfront",               op_pushfront_,             false, true,  false, false},
+    {"delete",                  op_delete_,                true,  true,  true,  false},
+    {"clear",                   op_clear_,                 false, true,  false, true},
+    {"find_by_value",           op_find_by_value_,         true,  false, false, false},
+    {"find_by_logical_index",   op_find_by_logical_index_, true,  false, false, false},
+    {"logical_index_by_ptr",    op_logical_index_by_ptr_,  true,  false, false, false},
+    {"remove_if",               op_remove_if_,             false, true,  false, true},
+    {"sort",                    op_sort_,                  false, true,  false, true},
+    {"linearize",               op_linearize_,             false, true,  false, true},
+    {"walk",                    op_walk_,                  false, false, false, true},
+#ifdef DEBUG
+    {"dump",                    op_dump_,                  false, false, false, true},
+#endif //< #ifdef DEBUG
+};
+
+static int double_cmp_(const void* a, const void* b) {
+    double a_val = *(const double*)a;
+    double b_val = *(const double*)b;
+
+    return (a_val > b_val) - (a_val < b_val);
+}
+
+/**
+ * @brief Chooses batch, so that sample is long enough for timer, then takes samples until time is out
+ */
+static bool bench_measure_(BenchList* bench, const BenchOp* op, const bool is_random,
+                           const double time_limit, BenchResult* result) {
+    size_t max_batch = op->is_single ? 1 : BenchLimits::MAX_BATCH;
+    // list size changes by no more than ~12%
+    if (op->is_mutating)
+        max_batch = MIN(max_batch, MAX(16, bench->n / 8));
+    if (op->is_shrinking)
+        max_batch = MIN(max_batch, bench->n);
+
+    size_t batch = 1;
+    while (op->func(bench, batch, is_random) < BenchLimits::MIN_SAMPLE_TIME && batch * 2 <= max_batch)
+        batch *= 2;
+
+    double* samples = (double*)calloc(BenchLimits::MAX_SAMPLES, sizeof(double));
+    if (samples == nullptr)
+        return false;
+
+    double total = 0;
+    size_t cnt = 0;
+
+    double begin = time_now_();
+
+    while (cnt < BenchLimits::MAX_SAMPLES &&
+           (cnt < BenchLimits::MIN_SAMPLES || time_now_() - begin < time_limit)) {
+        double time = op->func(bench, batch, is_random);
+
+        total += time;
+        samples[cnt++] = time / (double)batch;
+    }
+
+    qsort(samples, cnt, sizeof(double), double_cmp_);
+
+    result->median = samples[cnt / 2];
+    result->p99 = samples[MIN(cnt - 1, cnt * 99 / 100)];
+    result->ops_per_sec = (double)(cnt * batch) / total;
+    result->samples = cnt;
+    result->batch = batch;
+
+    free(samples);
+
+    return true;
+}
+
+static double bench_bytes_per_elem_(const List* list) {
+    size_t bytes = sizeof(List);
+
+    if (list->engine == List::ENGINE_ARRAY) {
+        bytes += list->arr.capacity * (sizeof(Elem_t) + 2 * sizeof(ListArrayLink));
+    } else {
+        bytes += sizeof(ObjPool) + list->pool->capacity * list->pool->obj_size;
+
+        for (ObjPoolChunk* chunk = list->pool->chunks; chunk != nullptr; chunk = chunk->next)
+            bytes += sizeof(ObjPoolChunk);
+    }
+
+    ListIndexStats stats = {};
+    if (list->order_index != nullptr && list_order_index_stats(list, &stats) == List::OK)
+        bytes += stats.memory;
+    if (list->value_index != nullptr && list_value_index_stats(list, &stats) == List::OK)
+        bytes += stats.memory;
+
+    return list->size > 0 ? (double)bytes / (double)list->size : (double)bytes;
+}
+
+static bool bench_list_ctor_(BenchList* bench, const List::Engine engine, const size_t n,
+                             const BenchSettings* settings) {
+    bench->n = n;
+
+    bench->values  = (Elem_t*)   calloc(n, sizeof(Elem_t));
+    bench->handles = (ListNode**)calloc(n, sizeof(ListNode*));
+    bench->scratch = (ListNode**)calloc(BenchLimits::MAX_BATCH, sizeof(ListNode*));
+    bench->elems   = (Elem_t*)   calloc(BenchLimits::MAX_BATCH, sizeof(Elem_t));
+
+    if (bench->values == nullptr || bench->handles == nullptr ||
+        bench->scratch == nullptr || bench->elems == nullptr)
+        return false;
+
+    for (size_t i = 0; i < n; i++)
+        bench->values[i] = (Elem_t)i;
+
+    if (list_ctor(&bench->list, engine) != List::OK)
+        return false;
+
+    list_set_verify_level(&bench->list, settings->verify_level);
+
+    if (list_from_array(&bench->list, bench->values, n) != List::OK)
+        return false;
+
+    if (settings->order_index && list_order_index_enable(&bench->list) != List::OK)
+        return false;
+
+    if (settings->value_index && list_value_index_enable(&bench->list) != List::OK)
+        return false;
+
+    return true;
+}
+
+static void bench_list_dtor_(BenchList* bench) {
+    if (list_is_initialised(&bench->list))
+        list_dtor(&bench->list);
+
+    free(bench->values);
+    free(bench->handles);
+    free(bench->scratch);
+    free(bench->elems);
+
+    *bench = {};
+}
+
+static bool bench_is_op_selected_(const BenchSettings* settings, const char* name) {
+    if (settings->ops == nullptr)
+        return true;
+
+    size_t len = strlen(name);
+
+    for (const char* str = settings->ops; str != nullptr; str = strchr(str, ',')) {
+        if (*str == ',')
+            str++;
+
+        if (strncmp(str, name, len) == 0 && (str[len] == ',' || str[len] == '\0'))
+            return true;
+    }
+
+    return false;
+}
+
+static const char* verify_level_name_(const List::VerifyLevel level) {
+    switch (level) {
+        case List::VERIFY_OFF:      return "off";
+        case List::VERIFY_LIGHT:    return "light";
+        case List::VERIFY_SAMPLED:  return "sampled";
+        case List::VERIFY_FULL:     return "full";
+        default:                    return "unknown";
+    }
+}
+
+static bool bench_parse_args_(const int argc, const char* argv[], BenchSettings* settings) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = strchr(arg, '=');
+        value = value ? value + 1 : "";
+
+        if (strncmp(arg, "--sizes=", 8) == 0) {
+            settings->sizes_cnt = 0;
+
+            const char* str = value;
+            while (*str != '\0') {
+                char* end = nullptr;
+                double size = strtod(str, &end);
+
+                if (end == str || size < 1 || settings->sizes_cnt == BenchSettings::MAX_SIZES)
+                    return false;
+
+                settings->sizes[settings->sizes_cnt++] = (size_t)size;
+                str = (*end == ',') ? end + 1 : end;
+            }
+        } else if (strncmp(arg, "--engine=", 9) == 0) {
+            settings->engines[List::ENGINE_NODES] = strcmp(value, "array") != 0;
+            settings->engines[List::ENGINE_ARRAY] = strcmp(value, "nodes") != 0;
+        } else if (strncmp(arg, "--verify=", 9) == 0) {
+            bool is_found = false;
+
+            for (int level = List::VERIFY_OFF; level <= List::VERIFY_FULL; level++) {
+                if (strcmp(value, verify_level_name_((List::VerifyLevel)level)) == 0) {
+                    settings->verify_level = (List::VerifyLevel)level;
+                    is_found = true;
+                }
+            }
+
+            if (!is_found)
+                return false;
+        } else if (strncmp(arg, "--index=", 8) == 0) {
+            settings->order_index = strcmp(value, "order") == 0 || strcmp(value, "all") == 0;
+            settings->value_index = strcmp(value, "value") == 0 || strcmp(value, "all") == 0;
+        } else if (strncmp(arg, "--dump=", 7) == 0) {
+            settings->dump_format = strcmp(value, "html") == 0 ? List::DUMP_HTML : List::DUMP_BINARY;
+        } else if (strncmp(arg, "--time=", 7) == 0) {
+            settings->time = atof(value);
+        } else if (strncmp(arg, "--ops=", 6) == 0) {
+            settings->ops = value;
+        } else if (strncmp(arg, "--json=", 7) == 0) {
+            settings->json = value;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void bench_usage_() {
+    printf("usage: list_bench [--sizes=10,1e3,...] [--engine=nodes|array|all] "
+           "[--verify=off|light|sampled|full]\n"
+           "                  [--index=none|order|value|all] [--dump=binary|html] [--time=seconds]\n"
+           "                  [--ops=name,...] [--json=file]\n");
+}
+
+int main(int argc, const char* argv[]) {
+    BenchSettings settings = {};
+    if (!bench_parse_args_(argc, argv, &settings)) {
+        bench_usage_();
+        return 1;
+    }
+
+#ifdef DEBUG
+    const char* build = "debug";
+#else //< #ifndef DEBUG
+    const char* build = "release";
+#endif //< #ifdef DEBUG
+
+    log_open_file(&log_file, "wb");
+
+#ifdef DEBUG
+    list_set_dump_format(settings.dump_format);
+#endif //< #ifdef DEBUG
+
+    FILE* json = nullptr;
+    if (settings.json != nullptr) {
+        json = fopen(settings.json, "wb");
+        if (json == nullptr) {
+            perror("Error opening json file");
+            return 1;
+        }
+
+        fprintf(json, "{\n  \"build\": \"%s\",\n  \"verify\": \"%s\",\n  \"order_index\": %s,\n"
+                      "  \"value_index\": %s,\n  \"results\": [",
+                build, verify_level_name_(settings.verify_level),
+                settings.order_index ? "true" : "false", settings.value_index ? "true" : "false");
+    }
+
+    printf("build %s, verify %s\n\n", build, verify_level_name_(settings.verify_level));
+    printf("%-22s %-6s %-6s %10s %12s %12s %14s %10s\n",
+           "operation", "access", "engine", "size", "median, ns", "p99, ns", "ops/s", "bytes/elem");
+
+    bool is_first = true;
+
+    for (size_t size_i = 0; size_i < settings.sizes_cnt; size_i++) {
+        for (int engine = List::ENGINE_NODES; engine <= List::ENGINE_ARRAY; engine++) {
+            if (!settings.engines[engine])
+                continue;
+
+            const char* engine_name = (engine == List::ENGINE_ARRAY) ? "array" : "nodes";
+            size_t n = MAX(1, settings.sizes[size_i]);
+
+            BenchList bench = {};
+            if (!bench_list_ctor_(&bench, (List::Engine)engine, n, &settings)) {
+                fprintf(stderr, "can't build list of %zu elements\n", n);
+                bench_list_dtor_(&bench);
+                continue;
+            }
+
+            double bytes_per_elem = bench_bytes_per_elem_(&bench.list);
+
+            for (size_t op_i = 0; op_i < sizeof(BENCH_OPS) / sizeof(*BENCH_OPS); op_i++) {
+                const BenchOp* op = &BENCH_OPS[op_i];
+
+                if (!bench_is_op_selected_(&settings, op->name))
+                    continue;
+
+#ifdef DEBUG
+                if (op->func == op_dump_ &&
+                    n > (settings.dump_format == List::DUMP_HTML ? BenchLimits::MAX_HTML_DUMP_SIZE
+                                                                 : BenchLimits::MAX_BINARY_DUMP_SIZE))
+                    continue;
+#endif //< #ifdef DEBUG
+
+                for (int is_random = 0; is_random <= (int)op->has_random; is_random++) {
+                    BenchResult result = {};
+                    if (!bench_measure_(&bench, op, is_random, settings.time, &result))
+                        continue;
+
+                    const char* access = is_random ? "random" : "seq";
+
+                    printf("%-22s %-6s %-6s %10zu %12.1f %12.1f %14.0f %10.1f\n", op->name, access,
+                           engine_name, n, result.median * 1e9, result.p99 * 1e9, result.ops_per_sec,
+                           bytes_per_elem);
+                    fflush(stdout);
+
+                    if (json == nullptr)
+                        continue;
+
+                    fprintf(json, "%s\n    {\"op\": \"%s\", \"access\": \"%s\", \"engine\": \"%s\", "
+                                  "\"size\": %zu, \"median_ns\": %.1f, \"p99_ns\": %.1f, "
+                                  "\"ops_per_sec\": %.0f, \"bytes_per_elem\": %.2f, "
+                                  "\"samples\": %zu, \"batch\": %zu}",
+                            is_first ? "" : ",", op->name, access, engine_name, n,
+                            result.median * 1e9, result.p99 * 1e9, result.ops_per_sec,
+                            bytes_per_elem, result.samples, result.batch);
+
+                    is_first = false;
+                }
+            }
+
+            bench_list_dtor_(&bench);
+        }
+    }
+
+    if (json != nullptr) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+    }
+
+    log_close_file(&log_file);
+
+    return 0;
+}
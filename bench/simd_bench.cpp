@@ -0,0 +1,162 @@
+#include <time.h>
+
+#include "../src/list.h"
+#include "../src/utils/simd_search.h"
+
+LogFileData log_file = {"log"};
+
+static const size_t SIZES[] = {1000, 100000, 10000000};
+
+static const size_t TOTAL_ELEMS = 200000000;   //< elements scanned by each measurement
+
+static double time_now_() {
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t reps_(const size_t n) {
+    return TOTAL_ELEMS / n > 0 ? TOTAL_ELEMS / n : 1;
+}
+
+/**
+ * @brief Fills list with distinct values. Searched value is absent, so the whole list is scanned
+ */
+static bool fill_list_(List* list, const size_t n) {
+    Elem_t* elems = (Elem_t*)calloc(n, sizeof(Elem_t));
+    if (elems == nullptr)
+        return false;
+
+    for (size_t i = 0; i < n; i++)
+        elems[i] = (Elem_t)i;
+
+    bool ret = list_from_array(list, elems, n) == List::OK;
+
+    free(elems);
+
+    return ret;
+}
+
+static double bench_find_(const List* list, const size_t n) {
+    size_t reps = reps_(n);
+    size_t found = 0;
+
+    double begin = time_now_();
+
+    for (size_t i = 0; i < reps; i++) {
+        ListNode* ptr = nullptr;
+        list_find_by_value(list, -1 - (Elem_t)(i & 1), &ptr);
+        found += ptr != nullptr;
+    }
+
+    double time = (time_now_() - begin) / (double)reps;
+
+    if (found != 0)
+        fprintf(stderr, "unexpected match\n");
+
+    return time;
+}
+
+static double bench_count_(const List* list, const size_t n) {
+    size_t reps = reps_(n);
+    size_t total = 0;
+
+    double begin = time_now_();
+
+    for (size_t i = 0; i < reps; i++) {
+        size_t count = 0;
+        list_count_value(list, (Elem_t)(i % n), &count);
+        total += count;
+    }
+
+    double time = (time_now_() - begin) / (double)reps;
+
+    if (total != reps)
+        fprintf(stderr, "unexpected count\n");
+
+    return time;
+}
+
+static double bench_verify_(const List* list, const size_t n) {
+    size_t reps = reps_(n) / 16 > 0 ? reps_(n) / 16 : 1;
+    int res = List::OK;
+
+    double begin = time_now_();
+
+    for (size_t i = 0; i < reps; i++)
+        res |= list_verify(list);
+
+    double time = (time_now_() - begin) / (double)reps;
+
+    if (res != List::OK)
+        fprintf(stderr, "verification failed\n");
+
+    return time;
+}
+
+static const char* level_name_(const SimdLevel level) {
+    switch (level) {
+        case SIMD_SCALAR:   return "scalar";
+        case SIMD_SSE2:     return "sse2";
+        case SIMD_AVX2:     return "avx2";
+        default:            return "unknown";
+    }
+}
+
+static void print_row_(const char* engine, const size_t n, const double find, const double count,
+                       const double verify) {
+    printf("%-14s %10zu %12.3f %12.3f %12.3f\n", engine, n, find * 1e6, count * 1e6, verify * 1e6);
+}
+
+int main() {
+    printf("SIMD level detected: %s\n\n", level_name_(simd_detect_level()));
+    printf("%-14s %10s %12s %12s %12s\n", "engine", "size", "find, us", "count, us", "verify, us");
+
+    for (size_t size_i = 0; size_i < sizeof(SIZES) / sizeof(*SIZES); size_i++) {
+        size_t n = SIZES[size_i];
+
+        // current scalar loop: logical walk over nodes
+        List nodes_list = {};
+        list_ctor(&nodes_list, List::ENGINE_NODES);
+        list_set_verify_level(&nodes_list, List::VERIFY_OFF);
+
+        if (!fill_list_(&nodes_list, n)) {
+            fprintf(stderr, "allocation failed\n");
+            return 1;
+        }
+
+        print_row_("nodes", n, bench_find_(&nodes_list, n), bench_count_(&nodes_list, n),
+                   bench_verify_(&nodes_list, n));
+
+        list_dtor(&nodes_list);
+
+        // physical scan of contiguous elements
+        List arr_list = {};
+        list_ctor(&arr_list, List::ENGINE_ARRAY);
+        list_set_verify_level(&arr_list, List::VERIFY_OFF);
+
+        if (!fill_list_(&arr_list, n)) {
+            fprintf(stderr, "allocation failed\n");
+            return 1;
+        }
+
+        for (int level = SIMD_SCALAR; level <= simd_detect_level(); level++) {
+            simd_set_level((SimdLevel)level);
+
+            char name[32] = {};
+            snprintf(name, sizeof(name), "array/%s", level_name_((SimdLevel)level));
+
+            print_row_(name, n, bench_find_(&arr_list, n), bench_count_(&arr_list, n),
+                       bench_verify_(&arr_list, n));
+        }
+
+        simd_set_level(SIMD_AVX2);
+
+        list_dtor(&arr_list);
+
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include <time.h>
+
+#include "../src/list.h"
+#include "../src/list_unrolled.h"
+
+LogFileData log_file = {"log"};
+
+static const size_t SIZES[] = {1000, 100000, 1000000};
+
+static const size_t TOTAL_ELEMS = 100000000;    //< elements walked by each walk measurement
+static const size_t RANDOM_OPS  = 20000;        //< lookups and insertions by each random measurement
+
+static double time_now_() {
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t reps_(const size_t n) {
+    return TOTAL_ELEMS / n > 0 ? TOTAL_ELEMS / n : 1;
+}
+
+static uint64_t rand_next_(uint64_t* state) {
+    // xorshift64
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+static volatile size_t bench_sink = 0;     //< results of read operations, so they are not optimised out
+
+/**
+ * @brief Measured times (seconds per operation) and memory of one list
+ */
+struct UnrolledBenchResult {
+    double bytes_per_elem = 0;
+    double walk           = 0;  //< full walk
+    double find           = 0;  //< search of absent value
+    double by_index       = 0;  //< random logical index lookup
+    double churn          = 0;  //< insertion after random element and its deletion
+};
+
+static size_t list_bytes_(const List* list) {
+    if (list->engine == List::ENGINE_ARRAY)
+        return sizeof(List) + list->arr.capacity * (sizeof(Elem_t) + 2 * sizeof(ListArrayLink));
+
+    return sizeof(List) + sizeof(ObjPool) + list->pool->capacity * list->pool->obj_size;
+}
+
+static UnrolledBenchResult bench_list_(const Elem_t* elems, const size_t n, const List::Engine engine) {
+    UnrolledBenchResult result = {};
+
+    List list = {};
+    list_ctor(&list, engine);
+    list_set_verify_level(&list, List::VERIFY_OFF);
+
+    if (list_from_array(&list, elems, n) != List::OK) {
+        list_dtor(&list);
+        return result;
+    }
+
+    result.bytes_per_elem = (double)list_bytes_(&list) / (double)n;
+
+    size_t reps = reps_(n);
+    size_t sum = 0;
+
+    double begin = time_now_();
+    for (size_t rep = 0; rep < reps; rep++) {
+        for (ListNode* ptr : list_range(&list))
+            sum += (size_t)list_node_elem(&list, ptr);
+    }
+    result.walk = (time_now_() - begin) / (double)reps;
+
+    begin = time_now_();
+    for (size_t rep = 0; rep < reps; rep++) {
+        ListNode* ptr = nullptr;
+        list_find_by_value(&list, -1, &ptr);
+        sum += ptr != nullptr;
+    }
+    result.find = (time_now_() - begin) / (double)reps;
+
+    uint64_t rand = 0x9E3779B97F4A7C15;
+    size_t ops = MIN(RANDOM_OPS, reps);
+
+    begin = time_now_();
+    for (size_t i = 0; i < ops; i++) {
+        ListNode* ptr = nullptr;
+        list_find_by_logical_index(&list, (ssize_t)(rand_next_(&rand) % n), &ptr);
+        sum += (size_t)list_node_elem(&list, ptr);
+    }
+    result.by_index = (time_now_() - begin) / (double)ops;
+
+    begin = time_now_();
+    for (size_t i = 0; i < ops; i++) {
+        ListNode* ptr = nullptr;
+        list_find_by_logical_index(&list, (ssize_t)(rand_next_(&rand) % n), &ptr);
+
+        ListNode* inserted = nullptr;
+        list_insert_after(&list, ptr, (Elem_t)i, &inserted);
+        list_delete(&list, inserted);
+    }
+    result.churn = (time_now_() - begin) / (double)ops;
+
+    bench_sink = bench_sink + sum;
+
+    list_dtor(&list);
+
+    return result;
+}
+
+static UnrolledBenchResult bench_unrolled_(const Elem_t* elems, const size_t n) {
+    UnrolledBenchResult result = {};
+
+    ListUnrolled list = {};
+    list_ctor(&list);
+
+    if (list_append_array(&list, elems, n) != List::OK) {
+        list_dtor(&list);
+        return result;
+    }
+
+    result.bytes_per_elem = (double)list_memory_usage(&list) / (double)n;
+
+    size_t reps = reps_(n);
+    size_t sum = 0;
+
+    double begin = time_now_();
+    for (size_t rep = 0; rep < reps; rep++) {
+        for (ListUnrolledBlock* block = list.head; block != nullptr; block = block->next) {
+            for (size_t i = 0; i < block->count; i++)
+                sum += (size_t)block->elems[i];
+        }
+    }
+    result.walk = (time_now_() - begin) / (double)reps;
+
+    begin = time_now_();
+    for (size_t rep = 0; rep < reps; rep++) {
+        ListUnrolledPos pos = {};
+        list_find_by_value(&list, -1, &pos);
+        sum += pos.block != nullptr;
+    }
+    result.find = (time_now_() - begin) / (double)reps;
+
+    uint64_t rand = 0x9E3779B97F4A7C15;
+    size_t ops = MIN(RANDOM_OPS, reps);
+
+    begin = time_now_();
+    for (size_t i = 0; i < ops; i++) {
+        ListUnrolledPos pos = {};
+        list_find_by_logical_index(&list, (ssize_t)(rand_next_(&rand) % n), &pos);
+        sum += (size_t)list_node_elem(&list, pos);
+    }
+    result.by_index = (time_now_() - begin) / (double)ops;
+
+    begin = time_now_();
+    for (size_t i = 0; i < ops; i++) {
+        ListUnrolledPos pos = {};
+        list_find_by_logical_index(&list, (ssize_t)(rand_next_(&rand) % n), &pos);
+
+        ListUnrolledPos inserted = {};
+        list_insert_after(&list, pos, (Elem_t)i, &inserted);
+        list_delete(&list, inserted);
+    }
+    result.churn = (time_now_() - begin) / (double)ops;
+
+    bench_sink = bench_sink + sum;
+
+    if (list_verify(&list) != List::OK)
+        fprintf(stderr, "unrolled list is damaged\n");
+
+    list_dtor(&list);
+
+    return result;
+}
+
+static void print_result_(const char* name, const size_t n, const UnrolledBenchResult* result) {
+    printf("%-10s %10zu %10.1f %14.1f %14.1f %14.1f %14.1f\n", name, n, result->bytes_per_elem,
+           result->walk * 1e9, result->find * 1e9, result->by_index * 1e9, result->churn * 1e9);
+}
+
+int main() {
+    printf("%-10s %10s %10s %14s %14s %14s %14s\n",
+           "list", "size", "bytes/elem", "walk, ns", "find, ns", "by index, ns", "churn, ns");
+
+    for (size_t size_i = 0; size_i < sizeof(SIZES) / sizeof(*SIZES); size_i++) {
+        size_t n = SIZES[size_i];
+
+        Elem_t* elems = (Elem_t*)calloc(n, sizeof(Elem_t));
+        if (elems == nullptr) {
+            fprintf(stderr, "Can't allocate %zu elements\n", n);
+            return 1;
+        }
+
+        for (size_t i = 0; i < n; i++)
+            elems[i] = (Elem_t)i;
+
+        UnrolledBenchResult nodes    = bench_list_(elems, n, List::ENGINE_NODES);
+        UnrolledBenchResult array    = bench_list_(elems, n, List::ENGINE_ARRAY);
+        UnrolledBenchResult unrolled = bench_unrolled_(elems, n);
+
+        print_result_("nodes",    n, &nodes);
+        print_result_("array",    n, &array);
+        print_result_("unrolled", n, &unrolled);
+
+        free(elems);
+    }
+
+    return 0;
+}
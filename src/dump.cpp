@@ -1,149 +1,94 @@
-#include "list.h"
+#include "list_internal.h"
+#include "list_snapshot.h"
 
 extern LogFileData log_file;
 
-#define LOG_(...) log_printf(&log_file, __VA_ARGS__)
-
 #ifdef DEBUG
 
-void list_dump(const List* list, const VarCodeData call_data) {
-    assert(list);
-
-    LOG_(HTML_BEGIN);
-
-    LOG_("    list_dump() called from %s:%d %s\n"
-         "    %s[%p] initialised in %s:%d %s \n",
-         call_data.file, call_data.line, call_data.func,
-         list->var_data.name, list,
-         list->var_data.file, list->var_data.line, list->var_data.func);
-
-    LOG_("    {\n");
-    LOG_("    size           = %zd\n", list->size);
-    LOG_("    head           = %p\n",  list->head);
-    LOG_("    tail           = %p\n",  list->tail);
-    LOG_("        {\n");
+static List::DumpFormat dump_format = List::DUMP_HTML;
 
-    if (!is_ptr_valid(list->head)) {
-        if (!list_is_initialised(list))
-            LOG_(HTML_RED("        can't read (invalid pointer)\n"));
+static int snapshots_fd = -1;
+static size_t snapshots_cnt = 0;
 
-        LOG_("        }\n"
-             "    }\n" HTML_END);
-        return;
-    }
-
-    LOG_("        "" %*s | %*s | %*s | elem\n", -14, "ptr", -14, "prev", -14, "next");
-
-    ListNode* ptr = list->head;
-    ssize_t log_i = 0;
-    LIST_FOREACH(*list, ptr, log_i) {
-        LOG_("        "" %14p | %14p | %14p | " ELEM_T_PRINTF "\n",
-                         ptr, ptr->prev, ptr->next, ptr->elem);
-    }
-
-    LOG_("        }\n"
-         "    }\n" HTML_END);
-
-    char img_filename[log_file.MAX_FILENAME_LEN] = {};
-
-    list_dump_dot(list, img_filename);
+#endif //< #ifdef DEBUG
 
-    LOG_("<img src=\"../../%s\">\n", img_filename);
+void list_set_dump_format(const List::DumpFormat format) {
+#ifdef DEBUG
+    dump_format = format;
+#else //< #ifndef DEBUG
+    (void)format;   //< lists aren't dumped in release
+#endif //< #ifdef DEBUG
 }
-#undef LOG_
-
-#define FPRINTF_(...) if (fprintf(file, __VA_ARGS__) == 0) return false
-bool list_dump_dot(const List* list, char* img_filename) {
-    #define BACKGROUND_COLOR "\"#1f1f1f\""
-    #define FONT_COLOR       "\"#000000\""
-    #define NODE_PREFIX      "elem_"
-    #define NODE_PARAMS      "shape=\"record\", style=\"filled\", fillcolor=\"#6e7681\""
-    #define ZERO_NODE_PARAMS "shape=\"record\", style=\"filled\", fillcolor=\"#6e7681\", color=yellow"
-
-    assert(list);
 
-    static size_t dot_number = 0;
-
-    char dot_filename[log_file.MAX_FILENAME_LEN] = {};
-
-    size_t str_len = strncat_len(dot_filename, log_file.timestamp_dir, log_file.MAX_FILENAME_LEN);
-    snprintf(dot_filename + str_len, log_file.MAX_FILENAME_LEN - str_len,
-             "%zd", dot_number);
-    str_len = strncat_len(dot_filename, ".dot", log_file.MAX_FILENAME_LEN);
-
-    FILE* file = fopen(dot_filename, "wb");
-    if (file == nullptr)
-        return false;
+#ifdef DEBUG
 
-    FPRINTF_("digraph List{\n"
-             "    graph [bgcolor=" BACKGROUND_COLOR "];\n"
-             "    node[color=white, fontcolor=" FONT_COLOR ", fontsize=14];\n");
+/**
+ * @brief Appends snapshot to snapshots file in log dir. File stays open
+ */
+static void list_dump_binary_(const ListSnapshot* snapshot) {
+    assert(snapshot);
 
-    FPRINTF_(NODE_PREFIX "zero [" ZERO_NODE_PARAMS ", label=\" head = %p | "
-                                                           "tail = %p\"];\n",
-             list->head, list->tail);
+    if (snapshots_fd < 0) {
+        if (!log_create_dir(log_file.dir) || !log_create_timestamp_dir(&log_file))
+            return;
 
-    ListNode* ptr = list->head;
-    ssize_t log_i = 0;
+        char filename[log_file.MAX_FILENAME_LEN] = {};
 
-    LIST_FOREACH(*list, ptr, log_i) {
-        FPRINTF_(NODE_PREFIX "%zd [" NODE_PARAMS ", label=\" <p>prev = %p | {<i>ptr = %p |", log_i, ptr->prev, ptr);
+        strncat_len(filename, log_file.timestamp_dir, log_file.MAX_FILENAME_LEN);
+        strncat_len(filename, LIST_SNAPSHOTS_FILENAME, log_file.MAX_FILENAME_LEN);
 
-        if (ptr->elem == ListNode::POISON) {
-            FPRINTF_("<e>elem = PZN} | ");
-        } else {
-            FPRINTF_("<e>elem = " ELEM_T_PRINTF "} | ", ptr->elem);
+        snapshots_fd = open(filename, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (snapshots_fd < 0) {
+            perror("Error opening snapshots file");
+            return;
         }
-
-        FPRINTF_("<n>next = %p}\"", ptr->next);
-
-        FPRINTF_("];\n");
     }
 
-    FPRINTF_(NODE_PREFIX "zero");
-    for (log_i = 0; log_i < list->size; log_i++) {
-        FPRINTF_("->" NODE_PREFIX "%zd", log_i);
+    if (!list_snapshot_write(snapshots_fd, snapshot)) {
+        perror("Error writing snapshot");
+        return;
     }
-    FPRINTF_(" [weight=10000, color=transparent, arrowtail=none];\n");
 
-    ptr = list->head;
-    log_i = 0;
+    log_printf(&log_file, HTML_TEXT("list_dump() snapshot #%zu written to " LIST_SNAPSHOTS_FILENAME "\n"),
+               snapshots_cnt++);
+}
+
+void list_dump(const List* list, const VarCodeData call_data) {
+    assert(list);
 
-    LIST_FOREACH(*list, ptr, log_i) {
-        if (ptr->next != nullptr)
-            FPRINTF_(NODE_PREFIX "%zd:<n>->" NODE_PREFIX "%zd:<n> [color=green];\n", log_i, log_i + 1);
+    ListSnapshot snapshot = {};
 
-        if (ptr->prev != nullptr)
-            FPRINTF_(NODE_PREFIX "%zd:<p>->" NODE_PREFIX "%zd:<p> [color=blue];\n", log_i, log_i - 1);
+    if (!list_snapshot_take(list, call_data, &snapshot)) {
+        log_printf(&log_file, HTML_TEXT(HTML_RED("list_dump(): can't allocate snapshot\n")));
+        return;
     }
 
-    FPRINTF_("head [shape=rect, label=\"HEAD\", color=yellow, fillcolor=\"#7293ba\",style=filled];\n");
-    FPRINTF_("tail [shape=rect, label=\"TAIL\", color=yellow, fillcolor=\"#7293ba\",style=filled];\n");
+    if (dump_format == List::DUMP_BINARY)
+        list_dump_binary_(&snapshot);
+    else
+        list_snapshot_render(&snapshot);
 
-    FPRINTF_("head->tail[weight=100, color=transparent];");
+    list_snapshot_dtor(&snapshot);
+
+#ifdef LIST_STATS
+    list_stats_dump(list);
+#endif //< #ifdef LIST_STATS
+}
 
-    FPRINTF_("{rank=same; head; " NODE_PREFIX "0}\n");
-    FPRINTF_("{rank=same; tail; " NODE_PREFIX "%zd}\n", list->size - 1);
+bool list_dump_dot(const List* list, char* img_filename) {
+    assert(list);
 
-    FPRINTF_("}\n");
+    ListSnapshot snapshot = {};
 
-    if (fclose(file) != 0) {
-        perror("Error closing file");
+    if (!list_snapshot_take(list, VAR_CODE_DATA(), &snapshot))
         return false;
-    }
 
-    str_len = strncat_len(img_filename, log_file.timestamp_dir, log_file.MAX_FILENAME_LEN);
-    snprintf(img_filename + str_len, log_file.MAX_FILENAME_LEN - str_len, "%zd", dot_number++);
-    str_len = strncat_len(img_filename, ".svg", log_file.MAX_FILENAME_LEN);
+    bool ret = list_snapshot_render_dot(&snapshot, img_filename);
 
-    if (!create_img(dot_filename, img_filename)) {
-        fprintf(stderr, "Error creating dot graph\n");
-        return false;
-    }
+    list_snapshot_dtor(&snapshot);
 
-    return true;
+    return ret;
 }
-#undef FPRINTF_
 
 #endif //< #ifdef DEBUG
 
@@ -162,6 +107,9 @@ void list_print_error(const int err_code) {
         PRINT_ERR_(NEGATIVE_SIZE,       "Negative list.size");
         PRINT_ERR_(INVALID_PTR_GIVEN,   "Invalid pointer given");
         PRINT_ERR_(DAMAGED_PATH,        "List is damaged. Invalid path");
+        PRINT_ERR_(INDEX_MISMATCH,      "Index doesn't match list");
+        PRINT_ERR_(FILE_ERR,            "Can't read or write list file");
+        PRINT_ERR_(CHECKSUM_MISMATCH,   "List data doesn't match file checksum");
     }
 }
 #undef PRINT_ERR_
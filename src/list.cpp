@@ -1,21 +1,101 @@
-#include "list.h"
+#include "list_internal.h"
 
 extern LogFileData log_file;
 
-#define CHECK_AND_RETURN(clause_, error_, ...)  if (clause_) {          \
-                                                    res |= error_;      \
-                                                    LIST_OK(list, res); \
-                                                    __VA_ARGS__;        \
-                                                    return res;         \
-                                                }
+static bool list_array_find_by_value_(const List* list, const Elem_t elem, ListNode** ptr);
 
-int list_ctor(List* list) {
+// more matches are cheaper to resolve by logical walk
+static const size_t MAX_RANKED_MATCHES = 64;
+
+/**
+ * @brief list_visit() context of searches by value
+ */
+struct ListFindContext {
+    const List* list = nullptr;
+    Elem_t elem = ListNode::POISON;
+
+    ListNode** ptrs = nullptr;  //< found elements
+    size_t max_cnt  = 0;        //< ptrs capacity
+    bool is_first_only = false; //< walk is stopped on the first found element
+
+    size_t found    = 0;        //< total number of found elements
+
+    size_t visited  = 0;        //< number of visited nodes
+};
+
+static bool list_find_visitor_(void* ctx, ListNode* const* nodes, const size_t n) {
+    ListFindContext* find = (ListFindContext*)ctx;
+    const List* list = find->list;
+
+    for (size_t i = 0; i < n; i++) {
+        if (list_node_elem(list, nodes[i]) != find->elem)
+            continue;
+
+        if (find->found < find->max_cnt)
+            find->ptrs[find->found] = nodes[i];
+
+        find->found++;
+
+        if (find->is_first_only) {
+            find->visited += i + 1;
+            return false;
+        }
+    }
+
+    find->visited += n;
+
+    return true;
+}
+
+static void list_pool_release_(List* list) {
+    assert(list);
+
+    if (list->pool == nullptr)
+        return;
+
+    if (--list->pool->refs == 0) {
+        obj_pool_dtor(list->pool);
+        free(list->pool);
+    }
+
+    list->pool = nullptr;
+}
+
+/**
+ * @brief Frees storage allocated by list_ctor() (list stays uninitialised)
+ */
+static void list_storage_release_(List* list) {
+    assert(list);
+
+    if (list->engine == List::ENGINE_ARRAY)
+        list_array_dtor(list);
+    else
+        list_pool_release_(list);
+}
+
+int list_ctor(List* list, const List::Engine engine) {
     assert(list);
 
     int res = list->OK;
 
     CHECK_AND_RETURN(list_is_initialised(list), list->ALREADY_INITIALISED);
 
+    list->engine = engine;
+
+    if (engine == List::ENGINE_ARRAY) {
+        list_array_ctor(list);
+    } else {
+        list->pool = (ObjPool*)calloc(1, sizeof(ObjPool));
+        CHECK_AND_RETURN(list->pool == nullptr, list->ALLOC_ERR);
+
+        obj_pool_ctor(list->pool, sizeof(ListNode));
+    }
+
+#ifdef LIST_STATS
+    list->stats = (ListStats*)calloc(1, sizeof(ListStats));
+    CHECK_AND_RETURN(list->stats == nullptr, list->ALLOC_ERR, list_storage_release_(list));
+#endif //< #ifdef LIST_STATS
+
     list->size = 0;
 
     return res | LIST_ASSERT(list);
@@ -25,34 +105,81 @@ int list_dtor(List* list) {
     int res = LIST_VERIFY(list);
     LIST_OK(list, res);
 
-    list_clear(list);
+    list_release_nodes(list, false);
+
+    list_order_index_disable(list);
+    list_value_index_disable(list);
+
+#ifdef LIST_STATS
+    FREE(list->stats);
+#endif //< #ifdef LIST_STATS
+
+    list_storage_release_(list);
 
     list->size = list->UNITIALISED_VAL;
 
     return res;
 }
 
+int list_reserve(List* list, const size_t n) {
+    int res = LIST_ASSERT(list);
+
+    if (n <= (size_t)list->size)
+        return res;
+
+    CHECK_AND_RETURN(!list_node_reserve(list, n - (size_t)list->size), list->ALLOC_ERR);
+
+    return res;
+}
+
+int list_share_pool(List* list, List* donor) {
+    int res = LIST_ASSERT(list);
+    res |= LIST_ASSERT(donor);
+
+    CHECK_AND_RETURN(list->engine != List::ENGINE_NODES || donor->engine != List::ENGINE_NODES ||
+                     list->size != 0, list->INVALID_PTR_GIVEN);
+
+    if (list->pool == donor->pool)
+        return res;
+
+    list_pool_release_(list);
+
+    list->pool = donor->pool;
+    list->pool->refs++;
+
+    return res;
+}
+
 int list_find_by_logical_index(const List* list, ssize_t logical_i, ListNode** ptr) {
     assert(ptr);
     int res = LIST_ASSERT(list);
 
+    LIST_STATS_TIMER(list, OP_LOOKUP);
+    LIST_STATS_ADD(list, lookups, 1);
+
     CHECK_AND_RETURN(logical_i >= list->size || logical_i < 0, list->INVALID_PTR_GIVEN, {
                                                                *ptr = nullptr;});
 
-    *ptr = list->head;
-    ssize_t log_i = 0;
-    LIST_FOREACH(*list, *ptr, log_i) {
-        if (logical_i-- == 0) {
-            return res;
-        }
-    }
+    if (list->order_index != nullptr && list_order_index_find(list, logical_i, ptr))
+        return res;
 
-    LIST_IS_FOREACH_VALID(*list, log_i, {
-        res |= list->DAMAGED_PATH;
-        LIST_OK(list, res);
-    });
+    // walk from the nearest end
+    bool is_backward = logical_i >= list->size / 2;
+    ssize_t steps = is_backward ? list->size - 1 - logical_i : logical_i;
 
-    *ptr = nullptr;
+    ListCursor cursor = {};
+    list_begin(list, &cursor, is_backward ? list->tail : list->head);
+
+    while (cursor.steps < steps && list_cursor_step(&cursor, is_backward)) {}
+
+    LIST_STATS_ADD(list, nodes_traversed, (size_t)cursor.steps + 1);
+
+    *ptr = cursor.node;
+    if (*ptr != nullptr)
+        return res;
+
+    res |= list->DAMAGED_PATH;
+    LIST_OK(list, res);
 
     return res;
 }
@@ -61,23 +188,141 @@ int list_find_by_value(const List* list, const Elem_t elem, ListNode** ptr) {
     assert(ptr);
     int res = LIST_ASSERT(list);
 
+    LIST_STATS_TIMER(list, OP_LOOKUP);
+    LIST_STATS_ADD(list, lookups, 1);
+
     CHECK_AND_RETURN(elem == ListNode::POISON, list->POISON_VAL_FOUND, {
                                                *ptr = nullptr;});
 
-    *ptr = list->head;
-    ssize_t log_i = 0;
-    LIST_FOREACH(*list, *ptr, log_i) {
-        if ((*ptr)->elem == elem) {
-            return res;
-        }
+    if (list->value_index != nullptr && list_value_index_find(list, elem, ptr))
+        return res;
+
+    if (list->engine == List::ENGINE_ARRAY && list_array_find_by_value_(list, elem, ptr))
+        return res;
+
+    *ptr = nullptr;
+
+    ListFindContext find = {list, elem, ptr, 1, true};
+
+    int walk_res = list_visit(list, list_find_visitor_, &find);
+
+    LIST_STATS_ADD(list, nodes_traversed, find.visited);
+
+    if (walk_res != list->OK) {
+        res |= walk_res;
+        LIST_OK(list, res);
     }
 
-    LIST_IS_FOREACH_VALID(*list, log_i, {
-        res |= list->DAMAGED_PATH;
+    return res;
+}
+
+int list_count_value(const List* list, const Elem_t elem, size_t* count) {
+    assert(count);
+    int res = LIST_ASSERT(list);
+
+    LIST_STATS_TIMER(list, OP_LOOKUP);
+    LIST_STATS_ADD(list, lookups, 1);
+
+    if (list->value_index != nullptr && list_value_index_count(list, elem, count))
+        return res;
+
+    if (list->engine == List::ENGINE_ARRAY) {
+        // free slots are poisoned, so physical scan counts only used slots
+        *count = (elem == ListNode::POISON) ? 0 :
+                 int_count(list->arr.elem, list->arr.capacity, elem);
+
+        return res;
+    }
+
+    ListFindContext find = {list, elem};
+
+    int walk_res = list_visit(list, list_find_visitor_, &find);
+
+    LIST_STATS_ADD(list, nodes_traversed, find.visited);
+
+    *count = find.found;
+
+    if (walk_res != list->OK) {
+        res |= walk_res;
         LIST_OK(list, res);
-    });
+    }
 
-    *ptr = nullptr;
+    return res;
+}
+
+/**
+ * @brief ENGINE_ARRAY search. Elements are scanned physically with vector kernels,
+ * logical order is needed only if there are several matches
+ *
+ * @return false if logical walk is needed
+ */
+static bool list_array_find_by_value_(const List* list, const Elem_t elem, ListNode** ptr) {
+    assert(list);
+    assert(list->engine == List::ENGINE_ARRAY);
+    assert(ptr);
+
+    // zero slot and free slots are poisoned, so every match is a used slot
+    const Elem_t* elems = list->arr.elem;
+    const size_t capacity = list->arr.capacity;
+
+    size_t slot = int_find_first(elems, capacity, elem);
+    if (slot == capacity) {
+        *ptr = nullptr;
+        return true;
+    }
+
+    size_t next_slot = slot + 1 + int_find_first(elems + slot + 1, capacity - slot - 1, elem);
+    if (next_slot == capacity) {
+        *ptr = list_array_handle(slot);
+        return true;
+    }
+
+    if (list->order_index == nullptr)
+        return false;
+
+    // several matches: physical slots are mapped to logical indexes by order index
+    ssize_t best_rank = -1;
+    size_t matches = 0;
+
+    for (; slot < capacity; slot = slot + 1 + int_find_first(elems + slot + 1, capacity - slot - 1, elem)) {
+        if (++matches > MAX_RANKED_MATCHES)
+            return false;
+
+        ssize_t rank = -1;
+        if (!list_order_index_rank(list, list_array_handle(slot), &rank) || rank < 0)
+            return false;
+
+        if (best_rank < 0 || rank < best_rank)
+            best_rank = rank;
+    }
+
+    return list_order_index_find(list, best_rank, ptr);
+}
+
+int list_find_all_by_value(const List* list, const Elem_t elem,
+                           ListNode** ptrs, const size_t max_cnt, size_t* found) {
+    assert(ptrs || max_cnt == 0);
+    assert(found);
+    int res = LIST_ASSERT(list);
+
+    LIST_STATS_TIMER(list, OP_LOOKUP);
+    LIST_STATS_ADD(list, lookups, 1);
+
+    if (list->value_index != nullptr && list_value_index_find_all(list, elem, ptrs, max_cnt, found))
+        return res;
+
+    ListFindContext find = {list, elem, ptrs, max_cnt};
+
+    int walk_res = list_visit(list, list_find_visitor_, &find);
+
+    LIST_STATS_ADD(list, nodes_traversed, find.visited);
+
+    *found = find.found;
+
+    if (walk_res != list->OK) {
+        res |= walk_res;
+        LIST_OK(list, res);
+    }
 
     return res;
 }
@@ -86,21 +331,29 @@ int list_logical_index_by_ptr(const List* list, const ListNode* ptr, ssize_t* lo
     assert(logical_i);
     int res = LIST_ASSERT(list);
 
+    LIST_STATS_TIMER(list, OP_LOOKUP);
+    LIST_STATS_ADD(list, lookups, 1);
+
     CHECK_AND_RETURN(ptr == nullptr, list->INVALID_PTR_GIVEN);
 
-    ListNode* cur_ptr = list->head;
-    ssize_t log_i = 0;
-    LIST_FOREACH(*list, cur_ptr, log_i) {
-        if (cur_ptr == ptr) {
-            *logical_i = log_i;
+    if (list->order_index != nullptr && list_order_index_rank(list, ptr, logical_i))
+        return res;
+
+    ListCursor cursor = {};
+    for (list_begin(list, &cursor); cursor.node != nullptr; list_next(&cursor)) {
+        if (cursor.node == ptr) {
+            LIST_STATS_ADD(list, nodes_traversed, (size_t)cursor.steps + 1);
+            *logical_i = cursor.steps;
             return res;
         }
     }
 
-    LIST_IS_FOREACH_VALID(*list, log_i, {
+    LIST_STATS_ADD(list, nodes_traversed, (size_t)cursor.steps);
+
+    if (cursor.steps != list->size) {
         res |= list->DAMAGED_PATH;
         LIST_OK(list, res);
-    });
+    }
 
     *logical_i = -1;
 
@@ -109,119 +362,294 @@ int list_logical_index_by_ptr(const List* list, const ListNode* ptr, ssize_t* lo
 
 #define CHECK_ERR_(clause, err) if (clause) res |= err
 
-int list_verify(const List* list) {
+/**
+ * @brief list_visit() context of list_verify_links()
+ */
+struct ListVerifyContext {
+    const List* list = nullptr;
+    bool check_poison = false;
+
+    ListNode* prev = nullptr;   //< last node of previous batch
+    int res = List::OK;
+};
+
+static bool list_verify_visitor_(void* ctx, ListNode* const* nodes, const size_t n) {
+    ListVerifyContext* verify = (ListVerifyContext*)ctx;
+    const List* list = verify->list;
+
+    int res = List::OK;
+    ListNode* prev = verify->prev;
+
+    for (size_t i = 0; i < n; i++) {
+        CHECK_ERR_(verify->check_poison && list_node_elem(list, nodes[i]) == ListNode::POISON,
+                   list->POISON_VAL_FOUND);
+        CHECK_ERR_(list_node_prev(list, nodes[i]) != prev, list->DAMAGED_PATH);
+
+        prev = nodes[i];
+    }
+
+    verify->prev = prev;
+    verify->res |= res;
+
+    return true;
+}
+
+int list_verify_links(const List* list, const bool check_poison) {
+    assert(list);
+
+    // handles are checked by cursor frontier before their links are read
+    ListVerifyContext verify = {list, check_poison};
+
+    int res = list_visit(list, list_verify_visitor_, &verify, true);
+
+    return res | verify.res;
+}
+
+/**
+ * @brief Full check
+ *
+ * @param list
+ * @param threads links are walked serially if it is 1, in parallel otherwise (0 - number of CPUs)
+ */
+static int list_verify_(const List* list, const size_t threads) {
     assert(list);
 
     int res = list->OK;
 
     CHECK_AND_RETURN(!list_is_initialised(list), list->UNITIALISED);
 
+    LIST_STATS_TIMER(list, OP_VERIFY);
+
     CHECK_ERR_(list->size < 0, list->NEGATIVE_SIZE);
 
-    ListNode* prev_ptr = nullptr;
+    // ENGINE_ARRAY: zero slot and free slots are poisoned, so poison check is one physical scan
+    bool check_poison = true;
+    if (list->engine == List::ENGINE_ARRAY && list->size >= 0 && list->arr.capacity > 0)
+        check_poison = int_count(list->arr.elem, list->arr.capacity, ListNode::POISON) !=
+                       list->arr.capacity - (size_t)list->size;
 
-    ListNode* ptr = list->head;
-    ssize_t log_i = 0;
-    LIST_FOREACH(*list, ptr, log_i) {
-        if (!is_ptr_valid(ptr)) {
-            res |= list->INVALID_NODE_PTR;
-            res |= list->DAMAGED_PATH;
-            break;
-        }
+    if (threads != 1 && list->size > 0)
+        res |= list_verify_links_parallel(list, check_poison, threads);
+    else
+        res |= list_verify_links(list, check_poison);
 
-        CHECK_ERR_(ptr->elem == ListNode::POISON, list->POISON_VAL_FOUND);
-        CHECK_ERR_(ptr->prev != prev_ptr, list->DAMAGED_PATH);
+    if (res == list->OK)
+        res |= list_indexes_verify(list);
 
-        prev_ptr = ptr;
-    }
+    return res;
+}
+
+int list_verify(const List* list) {
+    assert(list);
+
+    return list_verify_(list, list->size >= List::PARALLEL_VERIFY_MIN_SIZE ? 0 : 1);
+}
+
+int list_verify_parallel(const List* list, const size_t threads) {
+    assert(list);
+
+    return list_verify_(list, threads);
+}
 
-    CHECK_ERR_(log_i != list->size, list->DAMAGED_PATH);
+static int list_verify_window_(const List* list) {
+    assert(list);
+
+    int res = list->OK;
+
+    if (list->size == 0)
+        return res;
+
+    uint64_t rand = list_verify_rand(list);
+
+    if (list->engine != List::ENGINE_ARRAY)
+        return list_verify_window_walk(list, rand);
+
+    // random physical window: only used slots are checked
+    size_t index = 1 + (size_t)(rand % (list->arr.capacity - 1));
+
+    for (size_t i = 0; i < List::VERIFY_WINDOW && res == list->OK; i++, index++) {
+        if (index >= list->arr.capacity)
+            index = 1;
+
+        if (list->arr.prev[index] != ListArray::FREE_SLOT)
+            res |= list_verify_node_links(list, list_array_handle(index));
+    }
 
     return res;
 }
+
+int list_check(const List* list) {
+    assert(list);
+
+    LIST_STATS_ADD(list, checks, 1);
+
+    return list_check_by_level(list, list_verify_window_);
+}
 #undef CHECK_ERR_
 
+void list_set_verify_level(List* list, const List::VerifyLevel level, const size_t period) {
+    assert(list);
+    assert(period > 0);
+
+    list->verify_level  = level;
+    list->verify_period = period;
+    list->verify_cnt    = 0;
+}
+
 int list_insert_after(List* list, ListNode* ptr, const Elem_t elem, ListNode** inserted_ptr) {
     assert(inserted_ptr);
     int res = LIST_ASSERT(list);
 
-    *inserted_ptr = (ListNode*)calloc(1, sizeof(ListNode));
-
-    (*inserted_ptr)->prev = ptr;
+    LIST_STATS_TIMER(list, OP_INSERT);
 
-    if (ptr == nullptr) {
-        (*inserted_ptr)->next = list->head;
+    *inserted_ptr = list_node_alloc(list);
 
-        if (list->head != nullptr)
-            list->head->prev = *inserted_ptr;
-    } else {
-        (*inserted_ptr)->next = ptr->next;
+    CHECK_AND_RETURN(*inserted_ptr == nullptr, list->ALLOC_ERR);
 
-        if (ptr->next != nullptr)
-            ptr->next->prev = *inserted_ptr;
+    ListNode* node = *inserted_ptr;
+    ListNode* next = (ptr == nullptr) ? list->head : list_node_next(list, ptr);
 
-        ptr->next = *inserted_ptr;
-    }
+    list_node_set_prev(list, node, ptr);
+    list_node_set_next(list, node, next);
 
-    if ((*inserted_ptr)->prev == nullptr)
-        list->head = *inserted_ptr;
+    if (ptr == nullptr)
+        list->head = node;
+    else
+        list_node_set_next(list, ptr, node);
 
-    if ((*inserted_ptr)->next == nullptr)
-        list->tail = *inserted_ptr;
+    if (next == nullptr)
+        list->tail = node;
+    else
+        list_node_set_prev(list, next, node);
 
-    (*inserted_ptr)->elem = elem;
+    list_node_set_elem(list, node, elem);
 
     list->size++;
 
-    return res | LIST_ASSERT(list);
+    LIST_STATS_ADD(list, inserts, 1);
+
+    list_indexes_on_insert(list, ptr, node);
+
+    list_relayout_on_change(list, inserted_ptr);
+
+    res |= LIST_ASSERT(list);
+
+    return res;
 }
 
 int list_delete(List* list, ListNode* ptr) {
     int res = LIST_ASSERT(list);
 
+    LIST_STATS_TIMER(list, OP_DELETE);
+
     CHECK_AND_RETURN(ptr == nullptr, list->INVALID_PTR_GIVEN);
 
-    if (ptr->next == nullptr)
-        list->tail = ptr->prev;
-    else
-        (ptr->next)->prev = ptr->prev;
+    list_indexes_on_delete(list, ptr);
+
+    ListNode* prev = list_node_prev(list, ptr);
+    ListNode* next = list_node_next(list, ptr);
 
-    if (ptr->prev == nullptr)
-        list->head = ptr->next;
+    if (next == nullptr)
+        list->tail = prev;
     else
-        (ptr->prev)->next = ptr->next;
+        list_node_set_prev(list, next, prev);
 
-    ptr->elem = ListNode::POISON;
+    if (prev == nullptr)
+        list->head = next;
+    else
+        list_node_set_next(list, prev, next);
 
-    FREE(ptr);
+    list_node_free(list, ptr);
 
     list->size--;
 
-    return res | LIST_ASSERT(list);
+    LIST_STATS_ADD(list, deletes, 1);
+
+    list_relayout_on_change(list, nullptr);
+
+    res |= LIST_ASSERT(list);
+
+    return res;
+}
+
+void list_release_nodes(List* list, const bool async) {
+    assert(list);
+
+    LIST_STATS_ADD(list, deletes, (size_t)MAX(list->size, 0));
+
+    if (list->engine == List::ENGINE_ARRAY) {
+        // mapped arrays are unmapped by list_array_dtor()
+        if (async && list->arr.mapping == nullptr) {
+            bg_free(list->arr.elem);
+            bg_free(list->arr.next);
+            bg_free(list->arr.prev);
+
+            list->arr.elem = nullptr;
+            list->arr.next = nullptr;
+            list->arr.prev = nullptr;
+        }
+
+        list_array_dtor(list);
+
+    } else if (list->pool->refs == 1) {
+        // all nodes in pool belong to this list
+        ObjPoolChunk* chunks = obj_pool_detach(list->pool);
+
+        if (async)
+            bg_free_chain(chunks, offsetof(ObjPoolChunk, next));
+        else
+            obj_pool_free_chunks(chunks);
+
+    } else {
+        // shared pool: nodes are returned to free list one by one
+        ListNode* ptr = list->head;
+        while (ptr != nullptr) {
+            ListNode* next = list_node_next(list, ptr);
+            list_node_free(list, ptr);
+            ptr = next;
+        }
+    }
+
+    list->head = nullptr;
+    list->tail = nullptr;
+    list->size = 0;
+
+    list_indexes_on_clear(list);
 }
 
 int list_clear(List* list) {
     int res = LIST_ASSERT(list);
 
-    while (list->size > 0) {
-        res |= list_delete(list, list->head);
-        LIST_OK(list, res);
-    }
+    LIST_STATS_TIMER(list, OP_DELETE);
 
-    return res | LIST_ASSERT(list);
+    list_release_nodes(list, false);
+
+    res |= LIST_ASSERT(list);
+
+    return res;
+}
+
+int list_clear_async(List* list) {
+    int res = LIST_ASSERT(list);
+
+    LIST_STATS_TIMER(list, OP_DELETE);
+
+    list_release_nodes(list, true);
+
+    res |= LIST_ASSERT(list);
+
+    return res;
 }
 
 #ifdef DEBUG
 
-int list_ctor_debug(List* list, const VarCodeData var_data) {
+int list_ctor_debug(List* list, const VarCodeData var_data, const List::Engine engine) {
     assert(list);
 
     list->var_data = var_data;
 
-    return list_ctor(list);
+    return list_ctor(list, engine);
 }
 
 #endif //< #ifdef DEBUG
 
-
-#undef CHECK_AND_RETURN
@@ -5,16 +5,17 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <assert.h>
+#include <stdint.h>
 
 #include "utils/macros.h"
 #include "log/log.h"
 #include "utils/html.h"
 #include "utils/ptr_valid.h"
+#include "utils/obj_pool.h"
+#include "utils/bg_free.h"
 #include "log/graph_log.h"
 
-#define DEBUG
-
-typedef int Elem_t;
+typedef int Elem_t; //< ENGINE_ARRAY search uses int kernels from utils/simd_search.h
 
 #define ELEM_T_PRINTF "%d"
 
@@ -33,12 +34,148 @@ const ListNode POISON_LIST_NODE = {nullptr,
                                    ListNode::POISON,
                                    nullptr};
 
+typedef uint32_t ListArrayLink;     //< ENGINE_ARRAY link: physical slot index
+
+/**
+ * @brief Storage of array engine. Elements and links are kept in separate arrays,
+ * links are 32-bit physical indices (12 bytes per element with int elements).
+ * Slot 0 is reserved and means "no element"
+ */
+struct ListArray {
+    static const ListArrayLink FREE_SLOT = UINT32_MAX;  //< prev value of free slot
+
+    static const size_t DEFAULT_CAPACITY = 16;          //< capacity after first allocation
+    static const size_t MAX_CAPACITY     = FREE_SLOT;   //< slot indices must be less than FREE_SLOT
+
+    Elem_t*        elem = nullptr;  //< elements
+    ListArrayLink* next = nullptr;  //< next element index (free slots are chained by next too)
+    ListArrayLink* prev = nullptr;  //< previous element index (FREE_SLOT for free slots)
+
+    size_t capacity = 0;        //< number of slots (including reserved zero slot)
+    size_t free     = 0;        //< first free slot index. 0 if there is no free slots
+
+    void*  mapping      = nullptr;  //< file mapping (list_load_mmap()), arrays point into it
+    size_t mapping_size = 0;
+};
+
+/**
+ * @brief Memory and update cost of optional list index
+ */
+struct ListIndexStats {
+    size_t memory       = 0;    //< bytes used by index
+    size_t updates      = 0;    //< number of incremental updates (insertions and deletions)
+    size_t update_steps = 0;    //< elementary update steps (tree rotations, hash probes)
+    size_t rebuilds     = 0;    //< number of full rebuilds
+    double rebuild_time = 0;    //< seconds spent in rebuilds
+};
+
+/**
+ * @brief Log-linear latency histogram: every power of two nanoseconds is split into SUB_BUCKETS
+ * equal buckets, so relative error of percentiles is below 1 / SUB_BUCKETS
+ */
+struct ListLatencyHist {
+    static const size_t SUB_BUCKETS_BITS = 2;
+    static const size_t SUB_BUCKETS      = 1 << SUB_BUCKETS_BITS;
+    static const size_t MAX_POWER        = 40;      //< longer latencies (~18 min) are put to the last bucket
+    static const size_t BUCKETS          = MAX_POWER * SUB_BUCKETS;
+
+    uint64_t buckets[BUCKETS] = {};
+
+    uint64_t count    = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns   = 0;
+};
+
+/**
+ * @brief Operation counters of list (collected only if LIST_STATS is defined, see list_stats())
+ */
+struct ListStats {
+    // operations with latency histograms
+    enum Op {
+        OP_INSERT = 0,  //< list_insert_after(), list_insert_range_after()
+        OP_DELETE = 1,  //< list_delete(), list_clear(), list_remove_if(), list_partition(), list_unique()
+        OP_LOOKUP = 2,  //< searches by value, by logical index and logical index by handle
+        OP_VERIFY = 3,  //< full list_verify()
+        OPS_CNT,
+    };
+
+    size_t inserts         = 0;     //< inserted elements
+    size_t deletes         = 0;     //< deleted elements (including cleared ones)
+    size_t lookups         = 0;     //< OP_LOOKUP calls
+    size_t nodes_traversed = 0;     //< nodes walked by lookups (index lookups walk none)
+
+    size_t node_allocs     = 0;     //< nodes taken from storage
+    size_t storage_allocs  = 0;     //< storage growths (pool chunks, array reallocations)
+
+    size_t checks          = 0;     //< list_check() calls (LIST_ASSERT, LIST_VERIFY)
+    size_t verifies        = 0;     //< full checks
+    double verify_time     = 0;     //< seconds spent in full checks
+
+    ListLatencyHist latency[OPS_CNT] = {};
+};
+
+struct ListOrderIndex;
+struct ListValueIndex;
+
+/**
+ * @brief Handle translation callback of list_linearize(). Called once for every node
+ * in logical order, old handle is invalid after relayout. ENGINE_ARRAY new handles may equal old
+ * handles of other nodes, so handles must be translated by their values before relayout
+ *
+ * @param ctx
+ * @param old_ptr handle before relayout
+ * @param new_ptr handle of the same element after relayout
+ */
+typedef void (*ListRemap)(void* ctx, ListNode* old_ptr, ListNode* new_ptr);
+
+#ifndef LIST_DEFAULT_VERIFY_LEVEL
+// verification level of new lists. May be redefined with compiler flag
+#define LIST_DEFAULT_VERIFY_LEVEL VERIFY_LIGHT
+#endif //< #ifndef LIST_DEFAULT_VERIFY_LEVEL
+
 /**
  * @brief Specifies List data
  */
 struct List {
     static const ssize_t UNITIALISED_VAL = -1;  //< default value
 
+    // storage engines
+    enum Engine {
+        ENGINE_NODES = 0,   //< every node is separate object from pool, handles are pointers
+        ENGINE_ARRAY = 1,   //< elements and links in contiguous arrays, handles are indices
+    };
+
+    // runtime verification levels (used by LIST_VERIFY and LIST_ASSERT)
+    enum VerifyLevel {
+        VERIFY_OFF     = 0, //< no checks
+        VERIFY_LIGHT   = 1, //< O(1) head, tail and size checks
+        VERIFY_SAMPLED = 2, //< light checks, window of nodes and full check every verify_period call
+        VERIFY_FULL    = 3, //< list_verify() on every call
+    };
+
+    // list_dump() output formats
+    enum DumpFormat {
+        DUMP_HTML   = 0,    //< html text and graph image (default)
+        DUMP_BINARY = 1,    //< binary snapshot in log dir, rendered later by list_render tool
+    };
+
+    static const size_t DEFAULT_VERIFY_PERIOD = 64;    //< full check period in VERIFY_SAMPLED mode
+    static const size_t VERIFY_WINDOW         = 16;    //< number of nodes checked by sampled check
+
+    static const size_t  VERIFY_SPLITTERS         = 64;        //< nodes splitting list for parallel verification
+    static const ssize_t PARALLEL_VERIFY_MIN_SIZE = 1 << 16;   //< list_verify() is parallel from this size
+
+    static const ssize_t PARALLEL_SORT_MIN_SIZE  = 1 << 15;   //< list_sort() with threads is parallel from this size
+
+    static const size_t DEFAULT_PREFETCH_DISTANCE = 8;     //< nodes prefetched ahead of cursor
+    static const size_t MAX_PREFETCH_DISTANCE     = 64;
+    static const size_t VISIT_BATCH               = 64;    //< nodes passed to list_visit() callback at once
+
+    static const size_t RELAYOUT_MIN_CHANGES = 1024;    //< insertions and deletions between automatic
+                                                        //< fragmentation checks (at least list size)
+    static const size_t FRAGMENTATION_MAX_DISTANCE = 1024;  //< neighbour distance limit in fragmentation,
+                                                            //< farther nodes cost the same misses
+
     // error codes
     enum Results {
         OK                   = 0x000000,
@@ -51,6 +188,9 @@ struct List {
         NEGATIVE_SIZE        = 0x001000,
         INVALID_PTR_GIVEN    = 0x020000,
         DAMAGED_PATH         = 0x040000,
+        INDEX_MISMATCH       = 0x080000,
+        FILE_ERR             = 0x100000,
+        CHECKSUM_MISMATCH    = 0x200000,
     };
 
     ListNode* head = nullptr;   //< List head pointer
@@ -58,6 +198,31 @@ struct List {
 
     ssize_t size     = UNITIALISED_VAL;     //< number of elements in list
 
+    Engine engine = ENGINE_NODES;   //< storage engine (chosen in constructor)
+
+    ObjPool* pool = nullptr;    //< ListNode allocator, may be shared (ENGINE_NODES)
+    ListArray arr = {};         //< arrays (ENGINE_ARRAY)
+
+    ListOrderIndex* order_index = nullptr;  //< optional logical index lookup structure
+    ListValueIndex* value_index = nullptr;  //< optional value lookup structure
+
+    VerifyLevel verify_level = LIST_DEFAULT_VERIFY_LEVEL;  //< runtime verification level
+    size_t verify_period = DEFAULT_VERIFY_PERIOD;           //< see VERIFY_SAMPLED
+
+    mutable size_t   verify_cnt  = 0;                       //< number of level checks done
+    mutable uint64_t verify_rand = 0x9E3779B97F4A7C15;      //< sampled check random state
+
+    size_t prefetch_distance = DEFAULT_PREFETCH_DISTANCE;  //< see ListCursor
+
+    double    relayout_threshold = 0;           //< fragmentation triggering list_linearize(), 0 - off
+    ListRemap relayout_remap     = nullptr;     //< handle translation of automatic relayout
+    void*     relayout_ctx       = nullptr;
+    size_t    relayout_changes   = 0;           //< insertions and deletions since last fragmentation check
+
+#ifdef LIST_STATS
+    ListStats* stats = nullptr;     //< operation counters (make stats=1)
+#endif //< #ifdef LIST_STATS
+
 #ifdef DEBUG
     VarCodeData var_data;   //< keeps data about list variable (name, file, line number)
 #endif // #ifdef DEBUG
@@ -76,8 +241,365 @@ inline bool list_is_initialised(const List* list) {
              list->head == nullptr && list->tail == nullptr);
 }
 
+/**
+ * @brief Converts ENGINE_ARRAY handle to physical index
+ *
+ * @param node
+ * @return size_t
+ */
+inline size_t list_array_index(const ListNode* node) {
+    return (size_t)(uintptr_t)node;
+}
+
+/**
+ * @brief Converts physical index to ENGINE_ARRAY handle
+ *
+ * @param index
+ * @return ListNode*
+ */
+inline ListNode* list_array_handle(const size_t index) {
+    return (ListNode*)(uintptr_t)index;
+}
+
+/**
+ * @brief Returns next element handle. ListNode* is opaque handle for ENGINE_ARRAY,
+ * so use this instead of node->next
+ *
+ * @param list
+ * @param node
+ * @return ListNode*
+ */
+inline ListNode* list_node_next(const List* list, const ListNode* node) {
+    if (list->engine == List::ENGINE_ARRAY)
+        return list_array_handle(list->arr.next[list_array_index(node)]);
+
+    return node->next;
+}
+
+/**
+ * @brief Returns previous element handle
+ *
+ * @param list
+ * @param node
+ * @return ListNode*
+ */
+inline ListNode* list_node_prev(const List* list, const ListNode* node) {
+    if (list->engine == List::ENGINE_ARRAY)
+        return list_array_handle(list->arr.prev[list_array_index(node)]);
+
+    return node->prev;
+}
+
+/**
+ * @brief Returns element value
+ *
+ * @param list
+ * @param node
+ * @return Elem_t
+ */
+inline Elem_t list_node_elem(const List* list, const ListNode* node) {
+    if (list->engine == List::ENGINE_ARRAY)
+        return list->arr.elem[list_array_index(node)];
+
+    return node->elem;
+}
+
+/**
+ * @brief Checks if handle points to used slot
+ *
+ * @param list
+ * @param node
+ * @return true
+ * @return false
+ */
+bool list_array_is_handle_valid(const List* list, const ListNode* node);
+
+/**
+ * @brief Checks if node handle may be accessed
+ *
+ * @param list
+ * @param node
+ * @return true
+ * @return false
+ */
+inline bool list_node_is_valid(const List* list, const ListNode* node) {
+    if (list->engine == List::ENGINE_ARRAY)
+        return list_array_is_handle_valid(list, node);
+
+    return is_ptr_valid(node);
+}
+
+/**
+ * @brief Prefetches node data (links and element) to cache
+ *
+ * @param list
+ * @param node
+ */
+inline void list_node_prefetch(const List* list, const ListNode* node) {
+    if (list->engine == List::ENGINE_ARRAY) {
+        size_t index = list_array_index(node);
+
+        __builtin_prefetch(&list->arr.next[index]);
+        __builtin_prefetch(&list->arr.prev[index]);
+        __builtin_prefetch(&list->arr.elem[index]);
+    } else {
+        __builtin_prefetch(node);
+    }
+}
+
+/**
+ * @brief Traversal position. Links are followed by frontier, which runs list->prefetch_distance
+ * nodes ahead of cursor and prefetches nodes, so cursor node is in cache when it is reached.
+ * Walk stops after list->size + 1 nodes, so damaged list (cycle) is walked in finite time
+ */
+struct ListCursor {
+    const List* list = nullptr;
+
+    ListNode* node  = nullptr;  //< current node, nullptr - walk is finished
+    ListNode* ahead = nullptr;  //< frontier (nullptr - end of list is reached by frontier)
+
+    ssize_t steps       = 0;    //< logical distance passed by cursor (number of visited nodes after walk)
+    ssize_t ahead_steps = 0;    //< logical distance passed by frontier
+
+    bool is_backward = false;   //< frontier direction
+    bool is_checked  = false;   //< frontier checks handles before reading links (see list_node_is_valid())
+    bool is_invalid  = false;   //< frontier stopped at invalid handle
+};
+
+/**
+ * @brief Moves frontier up to prefetch distance ahead of cursor (at least one node)
+ *
+ * @param cursor
+ */
+inline void list_cursor_advance(ListCursor* cursor) {
+    const List* list = cursor->list;
+    ssize_t distance = (ssize_t)MAX(1, MIN(list->prefetch_distance, List::MAX_PREFETCH_DISTANCE));
+
+    while (cursor->ahead != nullptr && !cursor->is_invalid &&
+           cursor->ahead_steps < cursor->steps + distance && cursor->ahead_steps <= list->size) {
+        ListNode* ahead = cursor->is_backward ? list_node_prev(list, cursor->ahead) :
+                                                list_node_next(list, cursor->ahead);
+
+        cursor->ahead = ahead;
+        cursor->ahead_steps++;
+
+        if (ahead == nullptr)
+            break;
+
+        if (cursor->is_checked && !list_node_is_valid(list, ahead)) {
+            cursor->is_invalid = true;
+            break;
+        }
+
+        if (list->prefetch_distance > 0)
+            list_node_prefetch(list, ahead);
+    }
+}
+
+/**
+ * @brief Places cursor at node. List is not checked
+ *
+ * @param list
+ * @param cursor
+ * @param node first node of walk, nullptr - list head
+ * @param is_checked node handles are checked before their links are read (for damaged lists)
+ */
+inline void list_begin(const List* list, ListCursor* cursor, ListNode* node = nullptr,
+                       const bool is_checked = false) {
+    *cursor = {};
+
+    cursor->list = list;
+    cursor->node = (node == nullptr) ? list->head : node;
+
+    cursor->ahead = cursor->node;
+    cursor->is_checked = is_checked;
+
+    if (cursor->node == nullptr)
+        return;
+
+    if (is_checked && !list_node_is_valid(list, cursor->node)) {
+        cursor->is_invalid = true;
+        cursor->node = nullptr;
+        return;
+    }
+
+    list_cursor_advance(cursor);
+}
+
+/**
+ * @brief Moves cursor one step in given direction. Handle read by frontier is checked if needed
+ *
+ * @return true cursor is at node
+ * @return false walk is finished (end of list, invalid handle or more than size + 1 nodes)
+ */
+inline bool list_cursor_step(ListCursor* cursor, const bool is_backward) {
+    if (cursor->node == nullptr)
+        return false;
+
+    const List* list = cursor->list;
+
+    if (cursor->is_backward != is_backward) {
+        // frontier is restarted from cursor in other direction
+        cursor->is_backward = is_backward;
+        cursor->ahead = cursor->node;
+        cursor->ahead_steps = cursor->steps;
+        cursor->is_invalid = false;
+
+        list_cursor_advance(cursor);
+    }
+
+    // nodes behind frontier are checked, frontier node may be not
+    cursor->steps++;
+
+    if (cursor->steps > list->size)
+        cursor->node = nullptr;
+    else if (cursor->steps == cursor->ahead_steps)
+        cursor->node = cursor->is_invalid ? nullptr : cursor->ahead;
+    else
+        cursor->node = is_backward ? list_node_prev(list, cursor->node) : list_node_next(list, cursor->node);
+
+    list_cursor_advance(cursor);
+
+    return cursor->node != nullptr;
+}
+
+/**
+ * @brief Moves cursor to next node
+ *
+ * @param cursor
+ * @return true cursor is at node
+ * @return false walk is finished
+ */
+inline bool list_next(ListCursor* cursor) {
+    return list_cursor_step(cursor, false);
+}
+
+/**
+ * @brief Moves cursor to previous node
+ *
+ * @param cursor
+ * @return true cursor is at node
+ * @return false walk is finished
+ */
+inline bool list_prev(ListCursor* cursor) {
+    return list_cursor_step(cursor, true);
+}
+
+/**
+ * @brief Forward iterator over node handles (for (ListNode* node : list_range(list)))
+ */
+struct ListIterator {
+    ListCursor cursor = {};
+
+    ListNode* operator*() const { return cursor.node; }
+
+    ListIterator& operator++() {
+        list_next(&cursor);
+        return *this;
+    }
+
+    ListIterator& operator--() {
+        list_prev(&cursor);
+        return *this;
+    }
+
+    bool operator==(const ListIterator& other) const { return cursor.node == other.cursor.node; }
+    bool operator!=(const ListIterator& other) const { return cursor.node != other.cursor.node; }
+};
+
+struct ListRange {
+    const List* list = nullptr;
+    ListNode* first = nullptr;      //< nullptr - list head
+
+    ListIterator begin() const {
+        ListIterator it = {};
+        list_begin(list, &it.cursor, first);
+
+        return it;
+    }
+
+    ListIterator end() const { return {}; }
+};
+
+/**
+ * @brief Range of list nodes for range-based for loop
+ *
+ * @param list
+ * @param first first node, nullptr - list head
+ * @return ListRange
+ */
+inline ListRange list_range(const List* list, ListNode* first = nullptr) {
+    return {list, first};
+}
+
+/**
+ * @brief list_visit() callback. Gets nodes in logical order by batches
+ *
+ * @param ctx
+ * @param nodes
+ * @param n
+ * @return true continue walk
+ * @return false stop walk
+ */
+typedef bool (*ListVisitor)(void* ctx, ListNode* const* nodes, const size_t n);
+
+/**
+ * @brief Elements comparator for list_sort() and list_merge_sorted()
+ *
+ * @param a
+ * @param b
+ * @return int negative if a goes before b, 0 if they are equal, positive if a goes after b
+ */
+typedef int (*ListCmp)(const Elem_t a, const Elem_t b);
+
+/**
+ * @brief Element predicate for list_remove_if() and list_partition()
+ *
+ * @param ctx
+ * @param elem
+ * @return true element matches
+ * @return false
+ */
+typedef bool (*ListPred)(void* ctx, const Elem_t elem);
+
+/**
+ * @brief Staged operation of transaction
+ */
+struct ListTxnOp {
+    enum Type {
+        INSERT = 0,
+        DELETE = 1,
+    };
+
+    Type type = INSERT;
+
+    ListNode* node = nullptr;   //< inserted or deleted node
+    ListNode* ptr  = nullptr;   //< INSERT: node is inserted after it (nullptr - at the beginning)
+
+    ListNode* prev = nullptr;   //< DELETE: neighbours of node when it was unlinked (for rollback)
+    ListNode* next = nullptr;
+};
+
+/**
+ * @brief Transaction: insertions and deletions staged in log and applied by list_txn_commit() at once.
+ * List must not be changed by other functions while transaction is open
+ */
+struct ListTxn {
+    static const size_t DEFAULT_CAPACITY = 16;  //< log capacity after first staged operation
+
+    List* list = nullptr;       //< nullptr - transaction is not open
+
+    ListTxnOp* ops = nullptr;   //< log in staging order
+    size_t ops_cnt      = 0;
+    size_t ops_capacity = 0;
+
+    int error = 0;              //< staging error (ALLOC_ERR), commit aborts transaction
+};
+
+// plain link walk without prefetching (ListT<T>, List uses ListCursor)
 #define LIST_FOREACH(list_, ptr_, log_i_)                                               \
-    for (; ptr_ != nullptr && log_i_ <= (list_).size; ptr_ = (ptr_)->next, (log_i_)++)
+    for (; ptr_ != nullptr && log_i_ <= (list_).size;                                   \
+           ptr_ = list_node_next(&(list_), ptr_), (log_i_)++)
 
 #define LIST_IS_FOREACH_VALID(list_, log_i_, ...)   do {    \
             if (log_i_ != (list_).size) {                   \
@@ -89,9 +611,10 @@ inline bool list_is_initialised(const List* list) {
  * @brief (Use macros LIST_CTOR) List constructor
  *
  * @param list
+ * @param engine storage engine
  * @return int
  */
-int list_ctor(List* list);
+int list_ctor(List* list, const List::Engine engine = List::ENGINE_NODES);
 
 /**
  * @brief List destructor
@@ -101,6 +624,26 @@ int list_ctor(List* list);
  */
 int list_dtor(List* list);
 
+/**
+ * @brief Preallocates memory for n elements, so next insertions won't call malloc
+ *
+ * @param list
+ * @param n total number of elements
+ * @return int
+ */
+int list_reserve(List* list, const size_t n);
+
+/**
+ * @brief Makes list allocate nodes from donor's pool. Nodes of lists with common pool
+ * may be moved between them by list_splice() without copying.
+ * Both lists must have ENGINE_NODES, list must be empty
+ *
+ * @param list
+ * @param donor
+ * @return int
+ */
+int list_share_pool(List* list, List* donor);
+
 /**
  * @brief Inserts element after ptr
  *
@@ -122,7 +665,10 @@ int list_insert_after(List* list, ListNode* ptr, const Elem_t elem, ListNode** i
  * @return int
  */
 inline int list_insert_before(List* list, ListNode* ptr, const Elem_t elem, ListNode** inserted_ptr) {
-    return list_insert_after(list, ptr->prev, elem, inserted_ptr);
+    if (ptr == nullptr)
+        return list_insert_after(list, list->tail, elem, inserted_ptr);
+
+    return list_insert_after(list, list_node_prev(list, ptr), elem, inserted_ptr);
 }
 
 /**
@@ -149,6 +695,97 @@ inline int list_pushfront(List* list, const Elem_t elem, ListNode** inserted_ptr
     return list_insert_before(list, list->head, elem, inserted_ptr);
 }
 
+/**
+ * @brief Inserts n elements after ptr (nullptr - at the beginning).
+ * Memory for all elements is allocated at once
+ *
+ * @param list
+ * @param ptr
+ * @param elems
+ * @param n
+ * @param last_inserted (optional) returns last inserted element (ptr if n == 0)
+ * @return int
+ */
+int list_insert_range_after(List* list, ListNode* ptr, const Elem_t* elems, const size_t n,
+                            ListNode** last_inserted = nullptr);
+
+/**
+ * @brief Saves list to file in ENGINE_ARRAY layout: elements in logical order, links are slot indices.
+ * File may be loaded with list_load_mmap(). File is written next to path and renamed over it,
+ * so path may be mapped (even by list itself) and old file is kept if save fails
+ *
+ * @param list
+ * @param path
+ * @return int FILE_ERR if file can't be written
+ */
+int list_save(const List* list, const char* path);
+
+/**
+ * @brief Constructs ENGINE_ARRAY list which arrays are private mapping of file saved by list_save().
+ * Nothing is copied on load: pages are copied by OS on first change.
+ * Arrays are moved to heap when list grows. File checksum and link ranges are checked once on load
+ * (reads whole file), so loaded list is verified as any other one
+ *
+ * @param list uninitialised list. It is constructed even on error (as empty list)
+ * @param path
+ * @return int FILE_ERR if file can't be mapped, has wrong format or links out of arrays,
+ * CHECKSUM_MISMATCH if file data doesn't match its checksum
+ */
+int list_load_mmap(List* list, const char* path);
+
+/**
+ * @brief Replaces list content with array elements. Old nodes are released at once and new ones
+ * are allocated by one reservation, list is checked only before and after rebuild
+ *
+ * @param list
+ * @param elems
+ * @param n
+ * @return int
+ */
+int list_from_array(List* list, const Elem_t* elems, const size_t n);
+
+/**
+ * @brief Moves elements [first, last] from src to dst after pos (nullptr - at the beginning).
+ * If src is dst or they share pool (see list_share_pool()), nodes are relinked in O(1)
+ * (plus O(k) walk to count elements, if count is not given).
+ * Otherwise elements are copied to dst with one allocation and deleted from src
+ *
+ * @param dst
+ * @param pos must not be in [first, last]
+ * @param src
+ * @param first
+ * @param last must be reachable from first
+ * @param count (optional) number of elements in [first, last]
+ * @return int
+ */
+int list_splice(List* dst, ListNode* pos, List* src, ListNode* first, ListNode* last,
+                const ssize_t count = -1);
+
+/**
+ * @brief Sorts list by bottom-up merge sort in O(n log n). Nodes are relinked, elements are not
+ * moved and nothing is allocated, so handles stay valid. Sort is stable.
+ * With several threads lists of PARALLEL_SORT_MIN_SIZE and more elements are split into equal runs,
+ * which are sorted and then merged pairwise in parallel
+ *
+ * @param list
+ * @param cmp nullptr - ascending order
+ * @param threads 1 - serial sort, 0 - number of CPUs
+ * @return int
+ */
+int list_sort(List* list, ListCmp cmp = nullptr, const size_t threads = 1);
+
+/**
+ * @brief Merges sorted src into sorted dst in O(n + m), src becomes empty. Equal elements
+ * of dst go first. If lists share pool (see list_share_pool()), nodes are relinked,
+ * otherwise src elements are copied to dst with one allocation
+ *
+ * @param dst
+ * @param src must not be dst
+ * @param cmp nullptr - ascending order
+ * @return int
+ */
+int list_merge_sorted(List* dst, List* src, ListCmp cmp = nullptr);
+
 /**
  * @brief Deletes element by physical index
  *
@@ -159,7 +796,7 @@ inline int list_pushfront(List* list, const Elem_t elem, ListNode** inserted_ptr
 int list_delete(List* list, ListNode* ptr);
 
 /**
- * @brief Deletes all elements
+ * @brief Deletes all elements. List is verified once, node storage is released in bulk
  *
  * @param list
  * @return int
@@ -167,13 +804,200 @@ int list_delete(List* list, ListNode* ptr);
 int list_clear(List* list);
 
 /**
- * @brief (Use macros LIST_VERIFY) Verifies list data and fields
+ * @brief Deletes all elements like list_clear(), but node storage is freed in background thread.
+ * If pool is shared (see list_share_pool()), nodes are returned to it synchronously
+ *
+ * @param list
+ * @return int
+ */
+int list_clear_async(List* list);
+
+/**
+ * @brief Deletes all elements matching pred in one walk. List is verified once,
+ * nodes are freed after walk, indexes are rebuilt on next use
+ *
+ * @param list
+ * @param pred called once for every element in logical order
+ * @param ctx pred argument
+ * @param removed (optional) number of deleted elements
+ * @return int
+ */
+int list_remove_if(List* list, ListPred pred, void* ctx, size_t* removed = nullptr);
+
+/**
+ * @brief Moves all elements matching pred to the end of out in one walk, keeping their order.
+ * If lists share pool (see list_share_pool()), nodes are relinked, otherwise elements are copied
+ *
+ * @param list
+ * @param pred called once for every element in logical order
+ * @param ctx pred argument
+ * @param out initialised list, not list itself
+ * @param moved (optional) number of moved elements
+ * @return int ALLOC_ERR if copy can't be allocated: elements from failed one stay in list
+ */
+int list_partition(List* list, ListPred pred, void* ctx, List* out, size_t* moved = nullptr);
+
+/**
+ * @brief Deletes elements equal to previous one in one walk (all duplicates, if list is sorted)
+ *
+ * @param list
+ * @param removed (optional) number of deleted elements
+ * @return int
+ */
+int list_unique(List* list, size_t* removed = nullptr);
+
+/**
+ * @brief Opens transaction. List is verified once here and once by list_txn_commit(),
+ * staging functions don't verify it
+ *
+ * @param list
+ * @param txn closed transaction
+ * @param expected_ops (optional) number of operations: log and nodes for them are allocated at once
+ * @return int ALLOC_ERR if reservation failed (transaction is not opened)
+ */
+int list_txn_begin(List* list, ListTxn* txn, const size_t expected_ops = 0);
+
+/**
+ * @brief Stages insertion. Node is allocated now, but it is linked by list_txn_commit(),
+ * so its handle may be used by next staged operations only
+ *
+ * @param txn
+ * @param ptr node in list or inserted by staged operation, nullptr - at the beginning
+ * @param elem
+ * @param inserted_ptr handle of new node
+ * @return int ALLOC_ERR if node can't be allocated: list_txn_commit() will abort transaction
+ */
+int list_txn_insert_after(ListTxn* txn, ListNode* ptr, const Elem_t elem, ListNode** inserted_ptr);
+
+/**
+ * @brief Stages deletion. Node is freed by list_txn_commit()
+ *
+ * @param txn
+ * @param ptr node in list or inserted by staged operation
+ * @return int INVALID_PTR_GIVEN for nullptr or ALLOC_ERR if log can't grow:
+ * list_txn_commit() will abort transaction
+ */
+int list_txn_delete(ListTxn* txn, ListNode* ptr);
+
+/**
+ * @brief Applies staged operations in one pass and verifies list once. If operation refers to node
+ * which isn't linked at that moment or check fails, applied operations are undone in reverse order,
+ * so list has exactly the same links as before. Transaction is closed in any case
+ *
+ * @param txn
+ * @param applied (optional) number of applied operations (0 if transaction was rolled back)
+ * @return int INVALID_PTR_GIVEN, staging error or check result if transaction was rolled back
+ */
+int list_txn_commit(ListTxn* txn, size_t* applied = nullptr);
+
+/**
+ * @brief Drops staged operations and frees staged nodes. List is not changed. Transaction is closed
+ *
+ * @param txn
+ * @return int
+ */
+int list_txn_abort(ListTxn* txn);
+
+/**
+ * @brief Walks list from head to tail with cursor and passes nodes to visitor by batches of
+ * List::VISIT_BATCH nodes. List is not checked before walk (walk is a part of checks),
+ * but path is checked by walk itself
+ *
+ * @param list
+ * @param visitor
+ * @param ctx visitor argument
+ * @param is_checked node handles are checked before their links are read (damaged lists)
+ * @return int DAMAGED_PATH if path doesn't match size, head and tail, INVALID_NODE_PTR if
+ * invalid handle is found (is_checked only). OK if visitor stopped walk
+ */
+int list_visit(const List* list, ListVisitor visitor, void* ctx, const bool is_checked = false);
+
+/**
+ * @brief Sets number of nodes prefetched ahead of cursors (see ListCursor)
+ *
+ * @param list
+ * @param distance 0 - no prefetching, at most List::MAX_PREFETCH_DISTANCE
+ */
+void list_set_prefetch_distance(List* list, const size_t distance);
+
+/**
+ * @brief Moves nodes to new storage in logical order, so walks read memory sequentially.
+ * All handles become invalid, remap is called for every node to translate handles kept by caller.
+ * ENGINE_NODES list gets its own pool: if pool was shared (see list_share_pool()), list stops sharing it.
+ * Indexes are rebuilt on next use
+ *
+ * @param list
+ * @param remap (optional) handle translation callback
+ * @param ctx remap argument
+ * @return int ALLOC_ERR if new storage can't be allocated (list is not changed)
+ */
+int list_linearize(List* list, ListRemap remap = nullptr, void* ctx = nullptr);
+
+/**
+ * @brief Returns mean physical distance between logical neighbours in nodes, every distance is limited
+ * by List::FRAGMENTATION_MAX_DISTANCE (1 - list is linear, greater values - walks jump over memory)
+ *
+ * @param list
+ * @param fragmentation returnable value. 1 for lists with less than 2 elements
+ * @return int
+ */
+int list_fragmentation(const List* list, double* fragmentation);
+
+/**
+ * @brief Enables automatic list_linearize() by list_insert_after() and list_delete(). Fragmentation is
+ * checked after every max(size, List::RELAYOUT_MIN_CHANGES) of them, so check costs O(1) per operation.
+ * Relayout invalidates handles kept by caller, so remap is required to translate them (handle returned
+ * by list_insert_after() which triggered relayout is already translated). Lists sharing pool are not
+ * relayouted automatically
+ *
+ * @param list
+ * @param threshold fragmentation relayout is started from, 0 - off
+ * @param remap handle translation callback, may be nullptr only if threshold is 0
+ * @param ctx remap argument
+ * @return int INVALID_PTR_GIVEN if relayout is enabled without remap (settings are not changed)
+ */
+int list_set_relayout(List* list, const double threshold, ListRemap remap, void* ctx = nullptr);
+
+/**
+ * @brief Verifies list data and fields. Full O(n) check
  *
  * @param list
  * @return int
  */
 int list_verify(const List* list);
 
+/**
+ * @brief Full check like list_verify() (same results), but list is split into segments which
+ * are checked in parallel and then stitched from head to tail. Segments start at nodes found near
+ * evenly spaced physical positions of storage (pool chunks or arrays) on every call, so nothing has to be
+ * maintained by changing functions. If any segment or stitch check fails, list is walked again serially
+ * to report exactly the same errors. list_verify() calls it for lists of PARALLEL_VERIFY_MIN_SIZE
+ * and more elements
+ *
+ * @param list
+ * @param threads 0 - number of CPUs
+ * @return int
+ */
+int list_verify_parallel(const List* list, const size_t threads = 0);
+
+/**
+ * @brief (Use macros LIST_VERIFY) Verifies list according to list->verify_level
+ *
+ * @param list
+ * @return int
+ */
+int list_check(const List* list);
+
+/**
+ * @brief Sets runtime verification level
+ *
+ * @param list
+ * @param level
+ * @param period full check period for VERIFY_SAMPLED level
+ */
+void list_set_verify_level(List* list, const List::VerifyLevel level,
+                           const size_t period = List::DEFAULT_VERIFY_PERIOD);
+
 /**
  * @brief Returns ptr to element with given value (the first one)
  *
@@ -184,6 +1008,29 @@ int list_verify(const List* list);
  */
 int list_find_by_value(const List* list, const Elem_t elem, ListNode** ptr);
 
+/**
+ * @brief Returns number of elements with given value. O(1) with value index, O(n) without
+ *
+ * @param list
+ * @param elem
+ * @param count returnable value
+ * @return int
+ */
+int list_count_value(const List* list, const Elem_t elem, size_t* count);
+
+/**
+ * @brief Returns all elements with given value in logical order
+ *
+ * @param list
+ * @param elem
+ * @param ptrs buffer for max_cnt elements
+ * @param max_cnt
+ * @param found returnable value. Total number of elements with given value (may be > max_cnt)
+ * @return int
+ */
+int list_find_all_by_value(const List* list, const Elem_t elem,
+                           ListNode** ptrs, const size_t max_cnt, size_t* found);
+
 /**
  * @brief Returns logical index of element with specified ptr
  *
@@ -205,7 +1052,90 @@ int list_find_by_logical_index(const List* list, ssize_t logical_i, ListNode** p
 
 
 /**
- * @brief (Use LIST_DUMP macros) Dumps list data to log
+ * @brief Enables order-statistic index: list_find_by_logical_index() and
+ * list_logical_index_by_ptr() become O(log n), insertion and deletion cost O(log n) more.
+ * Index is built in O(n log n)
+ *
+ * @param list
+ * @return int
+ */
+int list_order_index_enable(List* list);
+
+/**
+ * @brief Disables order-statistic index and frees its memory
+ *
+ * @param list
+ */
+void list_order_index_disable(List* list);
+
+/**
+ * @brief Returns memory and update cost of order-statistic index
+ *
+ * @param list
+ * @param stats
+ * @return int INVALID_PTR_GIVEN if index is not enabled
+ */
+int list_order_index_stats(const List* list, ListIndexStats* stats);
+
+/**
+ * @brief Enables hash value index: list_find_by_value() and list_count_value() become
+ * expected O(1), insertion and deletion cost expected O(1) more. Index is built in O(n) and
+ * rebuilt by operations changing list without per-element updates (sort, splice, filter, relayout).
+ * Elements with equal values are kept in logical order while they are inserted at list ends.
+ * After an element is inserted in the middle next to equal ones, lookups of its value are
+ * O(k log n) with order index (k - number of equal elements) and O(n) list walk without it,
+ * until the next rebuild. Lookups never change index
+ *
+ * @param list
+ * @return int
+ */
+int list_value_index_enable(List* list);
+
+/**
+ * @brief Disables value index and frees its memory
+ *
+ * @param list
+ */
+void list_value_index_disable(List* list);
+
+/**
+ * @brief Returns memory, update and rebuild cost of value index
+ *
+ * @param list
+ * @param stats
+ * @return int INVALID_PTR_GIVEN if index is not enabled
+ */
+int list_value_index_stats(const List* list, ListIndexStats* stats);
+
+/**
+ * @brief Returns operation counters and latency histograms of list.
+ * They are collected only if library is built with LIST_STATS defined (make stats=1),
+ * otherwise counting code is compiled out
+ *
+ * @param list
+ * @param stats
+ * @return int INVALID_PTR_GIVEN if stats are not collected (stats are zeroed)
+ */
+int list_stats(const List* list, ListStats* stats);
+
+/**
+ * @brief Resets operation counters and latency histograms
+ *
+ * @param list
+ */
+void list_stats_reset(List* list);
+
+/**
+ * @brief Returns latency percentile estimate (upper bound of histogram bucket)
+ *
+ * @param hist
+ * @param percentile in [0, 100]
+ * @return uint64_t nanoseconds
+ */
+uint64_t list_latency_percentile(const ListLatencyHist* hist, const double percentile);
+
+/**
+ * @brief (Use LIST_DUMP macros) Dumps list data (and stats, if they are collected) to log
  *
  * @param list
  * @param call_data
@@ -213,7 +1143,14 @@ int list_find_by_logical_index(const List* list, ssize_t logical_i, ListNode** p
 void list_dump(const List* list, const VarCodeData call_data);
 
 /**
- * @brief Dumps list array to dot file
+ * @brief Sets list_dump() output format for all lists. Does nothing in release build
+ *
+ * @param format
+ */
+void list_set_dump_format(const List::DumpFormat format);
+
+/**
+ * @brief Dumps list to dot file and queues its rendering (see graph_render())
  *
  * @param list
  * @param img_filename returns image filename
@@ -236,23 +1173,26 @@ void list_print_error(const int err_code);
      *
      * @param list
      * @param var_data
+     * @param engine
      * @return int
      */
-    int list_ctor_debug(List* list, const VarCodeData var_data);
+    int list_ctor_debug(List* list, const VarCodeData var_data,
+                        const List::Engine engine = List::ENGINE_NODES);
 
     /**
      * @brief Constructor
      *
      * @param list
+     * @param ... (optional) storage engine
      */
-    #define LIST_CTOR(list) list_ctor_debug(list, VAR_CODE_DATA_PTR(list));
+    #define LIST_CTOR(list, ...) list_ctor_debug(list, VAR_CODE_DATA_PTR(list), ##__VA_ARGS__);
 
     /**
-     * @brief Verifies list data and fields
+     * @brief Verifies list data and fields (depth depends on list->verify_level)
      *
      * @param list
      */
-    #define LIST_VERIFY(list) list_verify(list)
+    #define LIST_VERIFY(list) list_check(list)
 
     /**
      * @brief List assert macros (LIST_VERIFY, LIST_OK, and if not ok - return)
@@ -292,8 +1232,9 @@ void list_print_error(const int err_code);
      * @brief Constructor
      *
      * @param list
+     * @param ... (optional) storage engine
      */
-    #define LIST_CTOR(list) list_ctor(list);
+    #define LIST_CTOR(list, ...) list_ctor(list, ##__VA_ARGS__);
 
     /**
      * @brief Verifies list data and fields (enabled only in DEBUG mode)
@@ -0,0 +1,184 @@
+#include "list_internal.h"
+
+static bool list_array_resize_(List* list, const size_t new_capacity);
+
+void list_array_ctor(List* list) {
+    assert(list);
+
+    list->arr.elem = nullptr;
+    list->arr.next = nullptr;
+    list->arr.prev = nullptr;
+
+    list->arr.capacity = 0;
+    list->arr.free     = 0;
+}
+
+void list_array_dtor(List* list) {
+    assert(list);
+
+    if (list->arr.mapping != nullptr) {
+        munmap(list->arr.mapping, list->arr.mapping_size);
+        ptr_valid_reset_cache();
+
+        list->arr.mapping      = nullptr;
+        list->arr.mapping_size = 0;
+
+        list->arr.elem = nullptr;
+        list->arr.next = nullptr;
+        list->arr.prev = nullptr;
+    }
+
+    FREE(list->arr.elem);
+    FREE(list->arr.next);
+    FREE(list->arr.prev);
+
+    list->arr.capacity = 0;
+    list->arr.free     = 0;
+}
+
+bool list_array_unmap(List* list) {
+    assert(list);
+
+    ListArray* arr = &list->arr;
+
+    if (arr->mapping == nullptr)
+        return true;
+
+    Elem_t* elem = (Elem_t*)malloc(arr->capacity * sizeof(Elem_t));
+    ListArrayLink* next = (ListArrayLink*)malloc(arr->capacity * sizeof(ListArrayLink));
+    ListArrayLink* prev = (ListArrayLink*)malloc(arr->capacity * sizeof(ListArrayLink));
+
+    if (elem == nullptr || next == nullptr || prev == nullptr) {
+        free(elem);
+        free(next);
+        free(prev);
+        return false;
+    }
+
+    memcpy(elem, arr->elem, arr->capacity * sizeof(Elem_t));
+    memcpy(next, arr->next, arr->capacity * sizeof(ListArrayLink));
+    memcpy(prev, arr->prev, arr->capacity * sizeof(ListArrayLink));
+
+    munmap(arr->mapping, arr->mapping_size);
+    ptr_valid_reset_cache();
+
+    arr->mapping      = nullptr;
+    arr->mapping_size = 0;
+
+    arr->elem = elem;
+    arr->next = next;
+    arr->prev = prev;
+
+    return true;
+}
+
+static bool list_array_resize_(List* list, const size_t new_capacity) {
+    assert(list);
+    assert(new_capacity > list->arr.capacity);
+
+    // links are 32-bit
+    if (new_capacity > ListArray::MAX_CAPACITY)
+        return false;
+
+    ListArray* arr = &list->arr;
+
+    // mapped arrays can't be reallocated
+    if (!list_array_unmap(list))
+        return false;
+
+    Elem_t* new_elem = (Elem_t*)recalloc(arr->elem, arr->capacity * sizeof(Elem_t),
+                                                    new_capacity  * sizeof(Elem_t));
+    if (new_elem == nullptr)
+        return false;
+    arr->elem = new_elem;
+
+    ListArrayLink* new_next = (ListArrayLink*)recalloc(arr->next, arr->capacity * sizeof(ListArrayLink),
+                                                                  new_capacity  * sizeof(ListArrayLink));
+    if (new_next == nullptr)
+        return false;
+    arr->next = new_next;
+
+    ListArrayLink* new_prev = (ListArrayLink*)recalloc(arr->prev, arr->capacity * sizeof(ListArrayLink),
+                                                                  new_capacity  * sizeof(ListArrayLink));
+    if (new_prev == nullptr)
+        return false;
+    arr->prev = new_prev;
+
+    size_t first_new = arr->capacity;
+    if (first_new == 0) {
+        // zero slot is reserved
+        arr->elem[0] = ListNode::POISON;
+        arr->next[0] = 0;
+        arr->prev[0] = ListArray::FREE_SLOT;
+        first_new = 1;
+    }
+
+    // new slots are chained in physical order, so they are taken sequentially
+    for (size_t i = new_capacity - 1; i >= first_new; i--) {
+        arr->elem[i] = ListNode::POISON;
+        arr->prev[i] = ListArray::FREE_SLOT;
+        arr->next[i] = (ListArrayLink)arr->free;
+        arr->free = i;
+    }
+
+    arr->capacity = new_capacity;
+
+    return true;
+}
+
+bool list_array_reserve(List* list, const size_t n) {
+    assert(list);
+
+    size_t used = list->size > 0 ? (size_t)list->size : 0;
+
+    // +1 for reserved zero slot
+    if (used + n + 1 <= list->arr.capacity)
+        return true;
+
+    return list_array_resize_(list, used + n + 1);
+}
+
+ListNode* list_array_alloc(List* list) {
+    assert(list);
+
+    if (list->arr.free == 0) {
+        size_t new_capacity = MIN(list->arr.capacity * 2, ListArray::MAX_CAPACITY);
+        if (new_capacity < ListArray::DEFAULT_CAPACITY)
+            new_capacity = ListArray::DEFAULT_CAPACITY;
+
+        if (new_capacity <= list->arr.capacity)
+            return nullptr;
+
+        if (!list_array_resize_(list, new_capacity))
+            return nullptr;
+    }
+
+    size_t index = list->arr.free;
+    list->arr.free = list->arr.next[index];
+
+    list->arr.next[index] = 0;
+    list->arr.prev[index] = 0;
+
+    return list_array_handle(index);
+}
+
+void list_array_free(List* list, ListNode* node) {
+    assert(list);
+
+    size_t index = list_array_index(node);
+    assert(0 < index && index < list->arr.capacity);
+
+    list->arr.elem[index] = ListNode::POISON;
+    list->arr.prev[index] = ListArray::FREE_SLOT;
+    list->arr.next[index] = (ListArrayLink)list->arr.free;
+    list->arr.free = index;
+}
+
+bool list_array_is_handle_valid(const List* list, const ListNode* node) {
+    assert(list);
+
+    size_t index = list_array_index(node);
+
+    return 0 < index && index < list->arr.capacity &&
+           list->arr.prev[index] != ListArray::FREE_SLOT;
+}
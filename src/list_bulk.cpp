@@ -0,0 +1,219 @@
+#include "list_internal.h"
+
+extern LogFileData log_file;
+
+/**
+ * @brief Links unlinked chain [first, last] after pos. Doesn't change size
+ */
+static void list_link_chain_(List* list, ListNode* pos, ListNode* first, ListNode* last) {
+    assert(list);
+    assert(first);
+    assert(last);
+
+    ListNode* next = (pos == nullptr) ? list->head : list_node_next(list, pos);
+
+    list_node_set_prev(list, first, pos);
+    if (pos == nullptr)
+        list->head = first;
+    else
+        list_node_set_next(list, pos, first);
+
+    list_node_set_next(list, last, next);
+    if (next == nullptr)
+        list->tail = last;
+    else
+        list_node_set_prev(list, next, last);
+}
+
+/**
+ * @brief Unlinks chain [first, last]. Doesn't change size and doesn't free nodes
+ */
+static void list_unlink_chain_(List* list, ListNode* first, ListNode* last) {
+    assert(list);
+    assert(first);
+    assert(last);
+
+    ListNode* before = list_node_prev(list, first);
+    ListNode* after  = list_node_next(list, last);
+
+    if (before == nullptr)
+        list->head = after;
+    else
+        list_node_set_next(list, before, after);
+
+    if (after == nullptr)
+        list->tail = before;
+    else
+        list_node_set_prev(list, after, before);
+}
+
+/**
+ * @brief Builds chain of n elements and links it after ptr. List is not verified
+ */
+static int list_insert_chain_(List* list, ListNode* ptr, const Elem_t* elems, const size_t n,
+                              ListNode** last_inserted) {
+    int res = list->OK;
+
+    if (n == 0) {
+        if (last_inserted != nullptr)
+            *last_inserted = ptr;
+
+        return res;
+    }
+
+    CHECK_AND_RETURN(!list_node_reserve(list, n), list->ALLOC_ERR);
+
+    // chain is built unlinked and then linked to the list at once
+    ListNode* first = nullptr;
+    ListNode* last  = nullptr;
+
+    for (size_t i = 0; i < n; i++) {
+        ListNode* node = list_node_alloc(list);
+        assert(node && "memory was reserved");
+
+        list_node_set_elem(list, node, elems[i]);
+        list_node_set_prev(list, node, last);
+        list_node_set_next(list, node, nullptr);
+
+        if (last == nullptr)
+            first = node;
+        else
+            list_node_set_next(list, last, node);
+
+        last = node;
+    }
+
+    list_link_chain_(list, ptr, first, last);
+
+    list->size += (ssize_t)n;
+
+    LIST_STATS_ADD(list, inserts, n);
+
+    list_indexes_on_insert_chain(list, ptr, first, last, n);
+
+    if (last_inserted != nullptr)
+        *last_inserted = last;
+
+    return res;
+}
+
+int list_insert_range_after(List* list, ListNode* ptr, const Elem_t* elems, const size_t n,
+                            ListNode** last_inserted) {
+    assert(elems || n == 0);
+    int res = LIST_ASSERT(list);
+
+    LIST_STATS_TIMER(list, OP_INSERT);
+
+    res |= list_insert_chain_(list, ptr, elems, n, last_inserted);
+
+    res |= LIST_ASSERT(list);
+
+    return res;
+}
+
+int list_from_array(List* list, const Elem_t* elems, const size_t n) {
+    assert(elems || n == 0);
+    int res = LIST_ASSERT(list);
+
+    LIST_STATS_TIMER(list, OP_INSERT);
+
+    // list is verified once before and once after rebuild
+    list_release_nodes(list, false);
+
+    res |= list_insert_chain_(list, nullptr, elems, n, nullptr);
+
+    res |= LIST_ASSERT(list);
+
+    return res;
+}
+
+#define SPLICE_CHECK_(clause_, error_)  if (clause_) {              \
+                                            res |= error_;          \
+                                            LIST_OK(dst, res);      \
+                                            return res;             \
+                                        }
+
+int list_splice(List* dst, ListNode* pos, List* src, ListNode* first, ListNode* last,
+                const ssize_t count) {
+    int res = LIST_ASSERT(dst);
+    res |= LIST_ASSERT(src);
+
+    SPLICE_CHECK_(first == nullptr || last == nullptr, dst->INVALID_PTR_GIVEN);
+
+    ssize_t k = count;
+    if (k < 0) {
+        // counts elements and checks that pos is not inside the range
+        k = 1;
+        for (ListNode* ptr = first; ptr != last; k++) {
+            SPLICE_CHECK_(dst == src && ptr == pos, dst->INVALID_PTR_GIVEN);
+
+            ptr = list_node_next(src, ptr);
+            SPLICE_CHECK_(ptr == nullptr || k > src->size, dst->INVALID_PTR_GIVEN);
+        }
+
+        SPLICE_CHECK_(dst == src && last == pos, dst->INVALID_PTR_GIVEN);
+    }
+
+    SPLICE_CHECK_(k == 0 || k > src->size, dst->INVALID_PTR_GIVEN);
+
+    bool same_storage = dst == src || (dst->engine == List::ENGINE_NODES &&
+                                       src->engine == List::ENGINE_NODES &&
+                                       dst->pool == src->pool);
+    if (same_storage) {
+        list_unlink_chain_(src, first, last);
+        src->size -= k;
+
+        list_link_chain_(dst, pos, first, last);
+        dst->size += k;
+
+        list_indexes_invalidate(src);
+        list_indexes_invalidate(dst);
+
+        res |= LIST_ASSERT(src);
+        return res | LIST_ASSERT(dst);
+    }
+
+    // different storages: elements are copied with one allocation
+    SPLICE_CHECK_(!list_node_reserve(dst, (size_t)k), dst->ALLOC_ERR);
+
+    ListNode* new_first = nullptr;
+    ListNode* new_last  = nullptr;
+
+    ListNode* ptr = first;
+    for (ssize_t i = 0; i < k; i++) {
+        ListNode* node = list_node_alloc(dst);
+        assert(node && "memory was reserved");
+
+        list_node_set_elem(dst, node, list_node_elem(src, ptr));
+        list_node_set_prev(dst, node, new_last);
+        list_node_set_next(dst, node, nullptr);
+
+        if (new_last == nullptr)
+            new_first = node;
+        else
+            list_node_set_next(dst, new_last, node);
+
+        new_last = node;
+        ptr = list_node_next(src, ptr);
+    }
+
+    list_link_chain_(dst, pos, new_first, new_last);
+    dst->size += k;
+
+    list_unlink_chain_(src, first, last);
+    src->size -= k;
+
+    list_indexes_invalidate(src);
+    list_indexes_invalidate(dst);
+
+    ptr = first;
+    for (ssize_t i = 0; i < k; i++) {
+        ListNode* next = list_node_next(src, ptr);
+        list_node_free(src, ptr);
+        ptr = next;
+    }
+
+    res |= LIST_ASSERT(src);
+    return res | LIST_ASSERT(dst);
+}
+#undef SPLICE_CHECK_
@@ -0,0 +1,179 @@
+#ifndef LIST_CHECK_H_
+#define LIST_CHECK_H_
+
+#include "list.h"
+
+// Verification levels shared by List and ListT<T>. Checks are templates over list type L, which
+// provides list_is_initialised(), list_node_prev(), list_node_next(), list_node_elem(),
+// list_node_is_valid(), list_elem_is_poison(), list_ends_are_readable() and list_verify() (full check)
+
+inline bool list_elem_is_poison(const List* list, const Elem_t elem) {
+    (void) list;
+    return elem == ListNode::POISON;
+}
+
+/**
+ * @brief Checks if head and tail links may be read. ENGINE_ARRAY handles are slot indices,
+ * so they are bounds checked first
+ */
+inline bool list_ends_are_readable(const List* list) {
+    if (list->engine != List::ENGINE_ARRAY)
+        return true;
+
+    return list_node_is_valid(list, list->head) && list_node_is_valid(list, list->tail);
+}
+
+#define LIST_CHECK_ERR_(clause, err) if (clause) res |= (err)
+
+/**
+ * @brief O(1) checks of size, head and tail (VERIFY_LIGHT)
+ *
+ * @param list
+ * @return int Error code
+ */
+template <typename L>
+int list_verify_light(const L* list) {
+    assert(list);
+
+    int res = List::OK;
+
+    if (!list_is_initialised(list))
+        return List::UNITIALISED;
+
+    LIST_CHECK_ERR_(list->size < 0, List::NEGATIVE_SIZE);
+
+    LIST_CHECK_ERR_((list->size == 0) != (list->head == nullptr), List::DAMAGED_PATH);
+    LIST_CHECK_ERR_((list->size == 0) != (list->tail == nullptr), List::DAMAGED_PATH);
+    LIST_CHECK_ERR_((list->size == 1) != (list->size > 0 && list->head == list->tail), List::DAMAGED_PATH);
+
+    if (res != List::OK || list->size == 0)
+        return res;
+
+    if (!list_ends_are_readable(list))
+        return res | List::INVALID_NODE_PTR | List::DAMAGED_PATH;
+
+    LIST_CHECK_ERR_(list_node_prev(list, list->head) != nullptr, List::DAMAGED_PATH);
+    LIST_CHECK_ERR_(list_node_next(list, list->tail) != nullptr, List::DAMAGED_PATH);
+
+    return res;
+}
+
+/**
+ * @brief Checks node handle, its element and links of its neighbours back to it
+ *
+ * @param list
+ * @param ptr
+ * @return int Error code
+ */
+template <typename L, typename N>
+int list_verify_node_links(const L* list, const N* ptr) {
+    assert(list);
+
+    int res = List::OK;
+
+    if (!list_node_is_valid(list, ptr))
+        return List::INVALID_NODE_PTR | List::DAMAGED_PATH;
+
+    LIST_CHECK_ERR_(list_elem_is_poison(list, list_node_elem(list, ptr)), List::POISON_VAL_FOUND);
+
+    const N* next = list_node_next(list, ptr);
+    if (next == nullptr) {
+        LIST_CHECK_ERR_(list->tail != ptr, List::DAMAGED_PATH);
+    } else if (!list_node_is_valid(list, next)) {
+        res |= List::INVALID_NODE_PTR | List::DAMAGED_PATH;
+    } else {
+        LIST_CHECK_ERR_(list_node_prev(list, next) != ptr, List::DAMAGED_PATH);
+    }
+
+    const N* prev = list_node_prev(list, ptr);
+    if (prev == nullptr) {
+        LIST_CHECK_ERR_(list->head != ptr, List::DAMAGED_PATH);
+    } else if (!list_node_is_valid(list, prev)) {
+        res |= List::INVALID_NODE_PTR | List::DAMAGED_PATH;
+    } else {
+        LIST_CHECK_ERR_(list_node_next(list, prev) != ptr, List::DAMAGED_PATH);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Next random number of sampled checks (xorshift64 in list->verify_rand)
+ */
+template <typename L>
+uint64_t list_verify_rand(const L* list) {
+    list->verify_rand ^= list->verify_rand << 13;
+    list->verify_rand ^= list->verify_rand >> 7;
+    list->verify_rand ^= list->verify_rand << 17;
+
+    return list->verify_rand;
+}
+
+/**
+ * @brief Checks List::VERIFY_WINDOW nodes from head or tail (chosen by rand)
+ *
+ * @param list
+ * @param rand
+ * @return int Error code
+ */
+template <typename L>
+int list_verify_window_walk(const L* list, const uint64_t rand) {
+    assert(list);
+
+    int res = List::OK;
+
+    bool from_head = rand & 1;
+    auto ptr = from_head ? list->head : list->tail;
+
+    for (size_t i = 0; i < List::VERIFY_WINDOW && ptr != nullptr && res == List::OK; i++) {
+        res |= list_verify_node_links(list, ptr);
+
+        if (res == List::OK)
+            ptr = from_head ? list_node_next(list, ptr) : list_node_prev(list, ptr);
+    }
+
+    return res;
+}
+
+/**
+ * @brief Verifies list according to list->verify_level
+ *
+ * @param list
+ * @param verify_window sampled check of a few nodes (VERIFY_SAMPLED)
+ * @return int Error code
+ */
+template <typename L>
+int list_check_by_level(const L* list, int (*verify_window)(const L*)) {
+    assert(list);
+    assert(verify_window);
+
+    switch (list->verify_level) {
+        case List::VERIFY_OFF:
+            return List::OK;
+
+        case List::VERIFY_LIGHT:
+            return list_verify_light(list);
+
+        case List::VERIFY_SAMPLED: {
+            if (list->verify_cnt++ % list->verify_period == 0)
+                return list_verify(list);
+
+            int res = list_verify_light(list);
+            if (res != List::OK)
+                return res;
+
+            return verify_window(list);
+        }
+
+        case List::VERIFY_FULL:
+            return list_verify(list);
+
+        default:
+            assert(0 && "Invalid verify level");
+            return list_verify(list);
+    }
+}
+
+#undef LIST_CHECK_ERR_
+
+#endif //< #ifndef LIST_CHECK_H_
@@ -0,0 +1,324 @@
+#include <sched.h>
+
+#include "list_conc.h"
+
+/*
+ * Locking rules: node lock protects its links. Writers lock nodes only in list order
+ * (node, then its next), so lock chains can't make cycle. Node is linked or unlinked with both
+ * neighbours locked, and links are published by release stores after node is filled, so readers
+ * walking by next links without locks see only complete nodes. Deleted node keeps its next link,
+ * so reader standing on it continues its walk. Such node was linked after reader entered its guard,
+ * so it is not freed before reader leaves it
+ */
+
+static void list_conc_lock_(ListConcNode* node) {
+    assert(node);
+
+    size_t spins = 0;
+
+    while (__atomic_exchange_n(&node->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&node->lock, __ATOMIC_RELAXED)) {
+            if (++spins < ListConc::SPINS_BEFORE_YIELD)
+                continue;
+
+            // lock holder may be preempted, spinning would only take its time
+            sched_yield();
+            spins = 0;
+        }
+    }
+}
+
+static void list_conc_unlock_(ListConcNode* node) {
+    assert(node);
+
+    __atomic_store_n(&node->lock, 0, __ATOMIC_RELEASE);
+}
+
+static inline bool list_conc_is_initialised_(const ListConc* list) {
+    return list_size(list) != List::UNITIALISED_VAL;
+}
+
+/**
+ * @brief Links node after pos. pos must be locked and not deleted
+ */
+static void list_conc_link_after_(ListConcNode* pos, ListConcNode* node) {
+    assert(pos);
+    assert(node);
+
+    ListConcNode* next = __atomic_load_n(&pos->next, __ATOMIC_RELAXED);
+    list_conc_lock_(next);
+
+    node->prev = pos;
+    node->next = next;
+
+    __atomic_store_n(&next->prev, node, __ATOMIC_RELEASE);
+    __atomic_store_n(&pos->next,  node, __ATOMIC_RELEASE);     //< node becomes visible to readers
+
+    list_conc_unlock_(next);
+}
+
+static ListConcNode* list_conc_node_alloc_(const Elem_t elem) {
+    ListConcNode* node = (ListConcNode*)calloc(1, sizeof(ListConcNode));
+    if (node == nullptr)
+        return nullptr;
+
+    *node = {};
+    node->elem = elem;
+
+    return node;
+}
+
+int list_ctor(ListConc* list) {
+    assert(list);
+
+    if (list_conc_is_initialised_(list))
+        return List::ALREADY_INITIALISED;
+
+    list->head = {};
+    list->tail = {};
+
+    list->head.next = &list->tail;
+    list->tail.prev = &list->head;
+
+    __atomic_store_n(&list->size, 0, __ATOMIC_RELEASE);
+
+    return List::OK;
+}
+
+int list_dtor(ListConc* list) {
+    assert(list);
+
+    if (!list_conc_is_initialised_(list))
+        return List::UNITIALISED;
+
+    ListConcNode* node = list->head.next;
+    while (node != nullptr && node != &list->tail) {
+        ListConcNode* next = node->next;
+        free(node);
+        node = next;
+    }
+
+    list->head = {};
+    list->tail = {};
+
+    list->size = List::UNITIALISED_VAL;
+
+    epoch_reclaim();
+
+    return List::OK;
+}
+
+int list_insert_after(ListConc* list, ListConcNode* ptr, const Elem_t elem, ListConcNode** inserted_ptr) {
+    assert(list);
+
+    if (!list_conc_is_initialised_(list))
+        return List::UNITIALISED;
+
+    if (ptr == &list->tail)
+        return List::INVALID_PTR_GIVEN;
+
+    ListConcNode* node = list_conc_node_alloc_(elem);
+    if (node == nullptr)
+        return List::ALLOC_ERR;
+
+    ListConcNode* pos = (ptr == nullptr) ? &list->head : ptr;
+
+    list_conc_enter();
+    list_conc_lock_(pos);
+
+    if (__atomic_load_n(&pos->is_deleted, __ATOMIC_RELAXED)) {
+        list_conc_unlock_(pos);
+        list_conc_exit();
+
+        free(node);
+        return List::INVALID_PTR_GIVEN;
+    }
+
+    list_conc_link_after_(pos, node);
+
+    list_conc_unlock_(pos);
+
+    __atomic_add_fetch(&list->size, 1, __ATOMIC_RELAXED);
+
+    list_conc_exit();
+
+    if (inserted_ptr != nullptr)
+        *inserted_ptr = node;
+
+    return List::OK;
+}
+
+int list_pushback(ListConc* list, const Elem_t elem, ListConcNode** inserted_ptr) {
+    assert(list);
+
+    if (!list_conc_is_initialised_(list))
+        return List::UNITIALISED;
+
+    ListConcNode* node = list_conc_node_alloc_(elem);
+    if (node == nullptr)
+        return List::ALLOC_ERR;
+
+    list_conc_enter();
+
+    // last node may change before it is locked
+    ListConcNode* last = nullptr;
+    while (true) {
+        last = __atomic_load_n(&list->tail.prev, __ATOMIC_ACQUIRE);
+        list_conc_lock_(last);
+
+        if (!__atomic_load_n(&last->is_deleted, __ATOMIC_RELAXED) &&
+            __atomic_load_n(&last->next, __ATOMIC_RELAXED) == &list->tail)
+            break;
+
+        list_conc_unlock_(last);
+    }
+
+    list_conc_link_after_(last, node);
+
+    list_conc_unlock_(last);
+
+    __atomic_add_fetch(&list->size, 1, __ATOMIC_RELAXED);
+
+    list_conc_exit();
+
+    if (inserted_ptr != nullptr)
+        *inserted_ptr = node;
+
+    return List::OK;
+}
+
+int list_delete(ListConc* list, ListConcNode* ptr) {
+    assert(list);
+
+    if (!list_conc_is_initialised_(list))
+        return List::UNITIALISED;
+
+    if (ptr == nullptr || ptr == &list->head || ptr == &list->tail)
+        return List::INVALID_PTR_GIVEN;
+
+    list_conc_enter();
+
+    // previous node is locked first. It may change before it is locked
+    ListConcNode* prev = nullptr;
+    while (true) {
+        if (__atomic_load_n(&ptr->is_deleted, __ATOMIC_ACQUIRE)) {
+            list_conc_exit();
+            return List::INVALID_PTR_GIVEN;
+        }
+
+        prev = __atomic_load_n(&ptr->prev, __ATOMIC_ACQUIRE);
+        list_conc_lock_(prev);
+
+        if (!__atomic_load_n(&prev->is_deleted, __ATOMIC_RELAXED) &&
+            __atomic_load_n(&prev->next, __ATOMIC_RELAXED) == ptr)
+            break;
+
+        list_conc_unlock_(prev);
+    }
+
+    // ptr is linked and can't be deleted by other thread: it needs prev lock
+    list_conc_lock_(ptr);
+
+    ListConcNode* next = __atomic_load_n(&ptr->next, __ATOMIC_RELAXED);
+    list_conc_lock_(next);
+
+    __atomic_store_n(&next->prev, prev, __ATOMIC_RELEASE);
+    __atomic_store_n(&prev->next, next, __ATOMIC_RELEASE);
+    __atomic_store_n(&ptr->is_deleted, 1, __ATOMIC_RELEASE);
+
+    list_conc_unlock_(next);
+    list_conc_unlock_(ptr);
+    list_conc_unlock_(prev);
+
+    __atomic_sub_fetch(&list->size, 1, __ATOMIC_RELAXED);
+
+    list_conc_exit();
+
+    epoch_retire(ptr);
+
+    return List::OK;
+}
+
+int list_find_by_value(const ListConc* list, const Elem_t elem, ListConcNode** ptr) {
+    assert(list);
+    assert(ptr);
+
+    *ptr = nullptr;
+
+    if (!list_conc_is_initialised_(list))
+        return List::UNITIALISED;
+
+    list_conc_enter();
+
+    ListConcNode* node = __atomic_load_n(&list->head.next, __ATOMIC_ACQUIRE);
+    while (node != &list->tail) {
+        if (node->elem == elem && !__atomic_load_n(&node->is_deleted, __ATOMIC_ACQUIRE)) {
+            *ptr = node;
+            break;
+        }
+
+        node = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    }
+
+    list_conc_exit();
+
+    return List::OK;
+}
+
+int list_count_value(const ListConc* list, const Elem_t elem, size_t* count) {
+    assert(list);
+    assert(count);
+
+    *count = 0;
+
+    if (!list_conc_is_initialised_(list))
+        return List::UNITIALISED;
+
+    list_conc_enter();
+
+    ListConcNode* node = __atomic_load_n(&list->head.next, __ATOMIC_ACQUIRE);
+    while (node != &list->tail) {
+        if (node->elem == elem && !__atomic_load_n(&node->is_deleted, __ATOMIC_ACQUIRE))
+            (*count)++;
+
+        node = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    }
+
+    list_conc_exit();
+
+    return List::OK;
+}
+
+int list_verify(const ListConc* list) {
+    assert(list);
+
+    if (!list_conc_is_initialised_(list))
+        return List::UNITIALISED;
+
+    int res = List::OK;
+
+    if (list->size < 0)
+        return res | List::NEGATIVE_SIZE;
+
+    if (list->head.prev != nullptr || list->tail.next != nullptr)
+        res |= List::DAMAGED_PATH;
+
+    const ListConcNode* prev = &list->head;
+    ssize_t cnt = 0;
+
+    for (const ListConcNode* node = list->head.next; node != &list->tail; node = node->next) {
+        if (node == nullptr || cnt >= list->size || node->prev != prev || node->is_deleted)
+            return res | List::DAMAGED_PATH;
+
+        if (node->elem == ListNode::POISON)
+            res |= List::POISON_VAL_FOUND;
+
+        prev = node;
+        cnt++;
+    }
+
+    if (cnt != list->size || list->tail.prev != prev)
+        res |= List::DAMAGED_PATH;
+
+    return res;
+}
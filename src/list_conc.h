@@ -0,0 +1,148 @@
+#ifndef LIST_CONC_H_
+#define LIST_CONC_H_
+
+#include "list.h"
+#include "utils/epoch.h"
+
+/**
+ * @brief Node of concurrent list. Links are changed under locks of both linked nodes,
+ * element is not changed after insertion
+ */
+struct ListConcNode {
+    ListConcNode* prev = nullptr;   //< previous node (head sentinel for the first element)
+    ListConcNode* next = nullptr;   //< next node (tail sentinel for the last element)
+
+    Elem_t elem = ListNode::POISON;
+
+    uint8_t lock       = 0;     //< spinlock of node links
+    uint8_t is_deleted = 0;     //< node is unlinked and retired, its links are not changed anymore
+};
+
+/**
+ * @brief Doubly linked list for concurrent use. Writers lock only neighbour nodes (in list order,
+ * so they can't deadlock), readers walk without locks. Deleted nodes are freed by epoch reclamation
+ * (utils/epoch.h) after all readers which could reach them left their guards.
+ * Handles are valid inside list_conc_enter() / list_conc_exit() guard or until they are deleted
+ */
+struct ListConc {
+    static const size_t SPINS_BEFORE_YIELD = 64;    //< lock spins before sched_yield()
+
+    ListConcNode head = {};     //< sentinel before the first element
+    ListConcNode tail = {};     //< sentinel after the last element
+
+    ssize_t size = List::UNITIALISED_VAL;   //< number of elements (changed atomically)
+};
+
+/**
+ * @brief Enters reader guard: nodes reached inside it are not freed until list_conc_exit().
+ * List functions enter guard themselves, it is needed to keep handles between calls. Guards may be nested
+ */
+inline void list_conc_enter() {
+    epoch_enter();
+}
+
+/**
+ * @brief Leaves reader guard
+ */
+inline void list_conc_exit() {
+    epoch_exit();
+}
+
+/**
+ * @brief Concurrent list constructor. Must not be called concurrently with other functions
+ *
+ * @param list
+ * @return int
+ */
+int list_ctor(ListConc* list);
+
+/**
+ * @brief Concurrent list destructor. Must not be called concurrently with other functions
+ *
+ * @param list
+ * @return int
+ */
+int list_dtor(ListConc* list);
+
+/**
+ * @brief Inserts element after ptr (nullptr - at the beginning)
+ *
+ * @param list
+ * @param ptr
+ * @param elem
+ * @param inserted_ptr (optional)
+ * @return int INVALID_PTR_GIVEN if ptr is deleted
+ */
+int list_insert_after(ListConc* list, ListConcNode* ptr, const Elem_t elem,
+                      ListConcNode** inserted_ptr = nullptr);
+
+/**
+ * @brief Inserts element at the end of the list
+ *
+ * @param list
+ * @param elem
+ * @param inserted_ptr (optional)
+ * @return int
+ */
+int list_pushback(ListConc* list, const Elem_t elem, ListConcNode** inserted_ptr = nullptr);
+
+/**
+ * @brief Inserts element at the beginning of the list
+ *
+ * @param list
+ * @param elem
+ * @param inserted_ptr (optional)
+ * @return int
+ */
+inline int list_pushfront(ListConc* list, const Elem_t elem, ListConcNode** inserted_ptr = nullptr) {
+    return list_insert_after(list, nullptr, elem, inserted_ptr);
+}
+
+/**
+ * @brief Deletes element. Node memory is freed when no reader can reach it
+ *
+ * @param list
+ * @param ptr
+ * @return int INVALID_PTR_GIVEN if ptr is already deleted
+ */
+int list_delete(ListConc* list, ListConcNode* ptr);
+
+/**
+ * @brief Returns the first element with given value. Deleted elements are skipped
+ *
+ * @param list
+ * @param elem
+ * @param ptr returnable value. nullptr if not found
+ * @return int
+ */
+int list_find_by_value(const ListConc* list, const Elem_t elem, ListConcNode** ptr);
+
+/**
+ * @brief Returns number of elements with given value
+ *
+ * @param list
+ * @param elem
+ * @param count returnable value
+ * @return int
+ */
+int list_count_value(const ListConc* list, const Elem_t elem, size_t* count);
+
+/**
+ * @brief Returns number of elements
+ *
+ * @param list
+ * @return ssize_t
+ */
+inline ssize_t list_size(const ListConc* list) {
+    return __atomic_load_n(&list->size, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Verifies links and size. Full O(n) check, list must not be changed concurrently
+ *
+ * @param list
+ * @return int
+ */
+int list_verify(const ListConc* list);
+
+#endif //< #ifndef LIST_CONC_H_
@@ -0,0 +1,43 @@
+#include "list_internal.h"
+
+int list_visit(const List* list, ListVisitor visitor, void* ctx, const bool is_checked) {
+    assert(list);
+    assert(visitor);
+
+    int res = list->OK;
+
+    ListNode* batch[List::VISIT_BATCH] = {};
+    size_t batch_size = 0;
+
+    ListNode* last = nullptr;
+
+    ListCursor cursor = {};
+    for (list_begin(list, &cursor, nullptr, is_checked); cursor.node != nullptr; list_next(&cursor)) {
+        last = cursor.node;
+        batch[batch_size++] = last;
+
+        if (batch_size == List::VISIT_BATCH) {
+            if (!visitor(ctx, batch, batch_size))
+                return res;
+
+            batch_size = 0;
+        }
+    }
+
+    if (batch_size > 0 && !visitor(ctx, batch, batch_size))
+        return res;
+
+    if (cursor.is_invalid)
+        return res | list->INVALID_NODE_PTR | list->DAMAGED_PATH;
+
+    if (cursor.steps != list->size || last != list->tail)
+        res |= list->DAMAGED_PATH;
+
+    return res;
+}
+
+void list_set_prefetch_distance(List* list, const size_t distance) {
+    assert(list);
+
+    list->prefetch_distance = MIN(distance, List::MAX_PREFETCH_DISTANCE);
+}
@@ -0,0 +1,385 @@
+#include "list_internal.h"
+
+#include <sys/stat.h>
+
+extern LogFileData log_file;
+
+/**
+ * @brief List file header. Sections (elem, next, prev arrays of capacity slots) follow it
+ * at page aligned offsets, so mapped file is used as ENGINE_ARRAY storage as is
+ */
+struct ListFileHeader {
+    static const uint32_t MAGIC   = 0x4654534C;     //< "LSTF"
+    static const uint32_t VERSION = 2;              //< 2: 32-bit links
+
+    static const size_t ALIGNMENT = 4096;           //< header size and sections alignment
+
+    uint32_t magic   = MAGIC;
+    uint32_t version = VERSION;
+
+    uint32_t elem_size  = sizeof(Elem_t);
+    uint32_t index_size = sizeof(ListArrayLink);
+
+    uint64_t size     = 0;
+    uint64_t head     = 0;      //< slot index
+    uint64_t tail     = 0;      //< slot index
+    uint64_t capacity = 0;      //< number of slots (including reserved zero slot)
+
+    uint64_t elem_offset = 0;
+    uint64_t next_offset = 0;
+    uint64_t prev_offset = 0;
+    uint64_t file_size   = 0;
+
+    uint64_t checksum = 0;      //< checksum of [ALIGNMENT, file_size)
+};
+
+static inline size_t list_file_align_(const size_t size) {
+    return (size + ListFileHeader::ALIGNMENT - 1) / ListFileHeader::ALIGNMENT * ListFileHeader::ALIGNMENT;
+}
+
+/**
+ * @brief Checksum state: 4 independent multiply-xor lanes over 64-bit words
+ */
+struct ListChecksum {
+    uint64_t lanes[4] = {0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full,
+                         0x165667B19E3779F9ull, 0x27D4EB2F165667C5ull};
+};
+
+static inline uint64_t list_checksum_rotl_(const uint64_t x, const int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/**
+ * @brief Adds data to checksum. len must be multiple of 32
+ */
+static void list_checksum_update_(ListChecksum* checksum, const void* data, const size_t len) {
+    assert(checksum);
+    assert(len % (4 * sizeof(uint64_t)) == 0);
+
+    const char* bytes = (const char*)data;
+
+    for (size_t i = 0; i < len; i += 4 * sizeof(uint64_t)) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            uint64_t word = 0;
+            memcpy(&word, bytes + i + lane * sizeof(uint64_t), sizeof(word));
+
+            checksum->lanes[lane] = list_checksum_rotl_(checksum->lanes[lane] ^ word, 31) *
+                                    0x9E3779B185EBCA87ull;
+        }
+    }
+}
+
+static uint64_t list_checksum_final_(const ListChecksum* checksum) {
+    assert(checksum);
+
+    uint64_t result = 0;
+    for (size_t lane = 0; lane < 4; lane++)
+        result = list_checksum_rotl_(result, 17) ^ checksum->lanes[lane];
+
+    return result;
+}
+
+/**
+ * @brief Computes checksum of mapped file data [ALIGNMENT, file_size)
+ */
+static uint64_t list_file_checksum_(const void* mapping, const size_t file_size) {
+    assert(mapping);
+
+    ListChecksum checksum = {};
+    list_checksum_update_(&checksum, (const char*)mapping + ListFileHeader::ALIGNMENT,
+                          file_size - ListFileHeader::ALIGNMENT);
+
+    return list_checksum_final_(&checksum);
+}
+
+/**
+ * @brief Checks that all links of mapped file are slot indices, so walks and light checks
+ * of loaded list don't read out of arrays
+ */
+static bool list_file_links_are_valid_(const ListArrayLink* next, const ListArrayLink* prev,
+                                       const size_t capacity) {
+    assert(next);
+    assert(prev);
+
+    size_t invalid = 0;
+    for (size_t i = 1; i < capacity; i++)
+        invalid += (next[i] >= capacity) | (prev[i] >= capacity);
+
+    return invalid == 0;
+}
+
+static bool list_file_write_(const int fd, const void* data, size_t len) {
+    const char* bytes = (const char*)data;
+
+    while (len > 0) {
+        ssize_t ret = write(fd, bytes, len);
+
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        bytes += ret;
+        len -= (size_t)ret;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Buffered section writer: data is written and added to checksum by buffers
+ */
+struct ListFileWriter {
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    int fd = -1;
+    char* buffer = nullptr;
+    size_t len = 0;
+
+    ListChecksum checksum = {};
+    bool is_failed = false;
+};
+
+static void list_file_flush_(ListFileWriter* writer) {
+    assert(writer);
+
+    if (writer->len == 0)
+        return;
+
+    // buffer is flushed only when it is full or at page aligned section end: len is multiple of 32
+    list_checksum_update_(&writer->checksum, writer->buffer, writer->len);
+
+    if (!list_file_write_(writer->fd, writer->buffer, writer->len))
+        writer->is_failed = true;
+
+    writer->len = 0;
+}
+
+static void list_file_put_(ListFileWriter* writer, const void* data, const size_t size) {
+    assert(writer);
+
+    if (writer->len + size > ListFileWriter::BUFFER_SIZE)
+        list_file_flush_(writer);
+
+    memcpy(writer->buffer + writer->len, data, size);
+    writer->len += size;
+
+    if (writer->len == ListFileWriter::BUFFER_SIZE)
+        list_file_flush_(writer);
+}
+
+/**
+ * @brief Pads section with zeros up to alignment
+ */
+static void list_file_pad_(ListFileWriter* writer, const size_t section_size) {
+    assert(writer);
+
+    static const uint64_t ZERO = 0;
+
+    size_t padding = list_file_align_(section_size) - section_size;
+
+    for (; padding >= sizeof(ZERO); padding -= sizeof(ZERO))
+        list_file_put_(writer, &ZERO, sizeof(ZERO));
+
+    for (; padding > 0; padding--)
+        list_file_put_(writer, &ZERO, 1);
+
+    list_file_flush_(writer);
+}
+
+#define FILE_CHECK_(clause_, ...)   if (clause_) {                          \
+                                        res |= list->FILE_ERR;              \
+                                        LIST_OK(list, res);                 \
+                                        __VA_ARGS__;                        \
+                                        return res;                         \
+                                    }
+
+/**
+ * @brief Creates temporary file next to path, so it may be renamed over path
+ *
+ * @return file descriptor, -1 on error. *tmp_path is allocated name of the file
+ */
+static int list_file_create_tmp_(const char* path, char** tmp_path) {
+    static const char SUFFIX[] = ".XXXXXX";
+
+    size_t len = strlen(path);
+
+    *tmp_path = (char*)calloc(len + sizeof(SUFFIX), 1);
+    if (*tmp_path == nullptr)
+        return -1;
+
+    memcpy(*tmp_path, path, len);
+    memcpy(*tmp_path + len, SUFFIX, sizeof(SUFFIX));
+
+    int fd = mkstemp(*tmp_path);
+    if (fd < 0) {
+        FREE(*tmp_path);
+        return -1;
+    }
+
+    // mkstemp() creates file with 0600 mode
+    fchmod(fd, 0644);
+
+    return fd;
+}
+
+/**
+ * @brief Closes and removes unfinished temporary file
+ */
+static void list_file_discard_tmp_(const int fd, char* tmp_path) {
+    close(fd);
+    unlink(tmp_path);
+    free(tmp_path);
+}
+
+int list_save(const List* list, const char* path) {
+    assert(path);
+    int res = LIST_ASSERT(list);
+
+    // logical order is saved: element i goes to slot i + 1
+    size_t size = (size_t)list->size;
+
+    // links are 32-bit slot indices
+    FILE_CHECK_(size + 1 > ListArray::MAX_CAPACITY);
+
+    ListFileHeader header = {};
+    header.size     = size;
+    header.head     = size > 0 ? 1 : 0;
+    header.tail     = size;
+    header.capacity = size + 1;
+
+    header.elem_offset = ListFileHeader::ALIGNMENT;
+    header.next_offset = header.elem_offset + list_file_align_(header.capacity * sizeof(Elem_t));
+    header.prev_offset = header.next_offset + list_file_align_(header.capacity * sizeof(ListArrayLink));
+    header.file_size   = header.prev_offset + list_file_align_(header.capacity * sizeof(ListArrayLink));
+
+    ListFileWriter writer = {};
+
+    // list is written to temporary file which replaces path when it is complete: path may be
+    // mapped by list_load_mmap() (even by this list), and failed save keeps old file
+    char* tmp_path = nullptr;
+
+    writer.fd = list_file_create_tmp_(path, &tmp_path);
+    FILE_CHECK_(writer.fd < 0);
+
+    writer.buffer = (char*)calloc(ListFileWriter::BUFFER_SIZE, 1);
+    FILE_CHECK_(writer.buffer == nullptr, list_file_discard_tmp_(writer.fd, tmp_path));
+
+    // header is written last, when checksum is known
+    FILE_CHECK_(lseek(writer.fd, ListFileHeader::ALIGNMENT, SEEK_SET) < 0, free(writer.buffer),
+                                                                            list_file_discard_tmp_(writer.fd, tmp_path));
+
+    const Elem_t poison = ListNode::POISON;
+    list_file_put_(&writer, &poison, sizeof(poison));
+
+    ListCursor cursor = {};
+    for (list_begin(list, &cursor); cursor.node != nullptr; list_next(&cursor)) {
+        Elem_t elem = list_node_elem(list, cursor.node);
+        list_file_put_(&writer, &elem, sizeof(elem));
+    }
+
+    list_file_pad_(&writer, header.capacity * sizeof(Elem_t));
+
+    for (size_t i = 0; i < header.capacity; i++) {
+        ListArrayLink next = (i == 0 || i == size) ? 0 : (ListArrayLink)(i + 1);
+        list_file_put_(&writer, &next, sizeof(next));
+    }
+
+    list_file_pad_(&writer, header.capacity * sizeof(ListArrayLink));
+
+    for (size_t i = 0; i < header.capacity; i++) {
+        ListArrayLink prev = (i == 0) ? ListArray::FREE_SLOT : (ListArrayLink)(i - 1);
+        list_file_put_(&writer, &prev, sizeof(prev));
+    }
+
+    list_file_pad_(&writer, header.capacity * sizeof(ListArrayLink));
+
+    header.checksum = list_checksum_final_(&writer.checksum);
+
+    free(writer.buffer);
+
+    FILE_CHECK_(writer.is_failed || (size_t)cursor.steps != size, list_file_discard_tmp_(writer.fd, tmp_path));
+
+    FILE_CHECK_(pwrite(writer.fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header),
+                list_file_discard_tmp_(writer.fd, tmp_path));
+
+    FILE_CHECK_(close(writer.fd) != 0, unlink(tmp_path), free(tmp_path));
+
+    // existing mappings keep old file
+    FILE_CHECK_(rename(tmp_path, path) != 0, unlink(tmp_path), free(tmp_path));
+
+    free(tmp_path);
+
+    return res;
+}
+
+int list_load_mmap(List* list, const char* path) {
+    assert(list);
+    assert(path);
+
+    int res = list_ctor(list, List::ENGINE_ARRAY);
+    if (res != list->OK)
+        return res;
+
+    int fd = open(path, O_RDONLY);
+    FILE_CHECK_(fd < 0);
+
+    ListFileHeader header = {};
+    FILE_CHECK_(pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header), close(fd));
+
+    struct stat file_stat = {};
+    FILE_CHECK_(fstat(fd, &file_stat) != 0, close(fd));
+
+    // format and bounds are checked before mapping
+    bool is_valid = header.magic == ListFileHeader::MAGIC && header.version == ListFileHeader::VERSION &&
+                    header.elem_size == sizeof(Elem_t) && header.index_size == sizeof(ListArrayLink) &&
+                    header.file_size == (uint64_t)file_stat.st_size &&
+                    header.capacity == header.size + 1 && header.capacity <= ListArray::MAX_CAPACITY &&
+                    header.head <= header.size && header.tail <= header.size &&
+                    header.elem_offset == ListFileHeader::ALIGNMENT &&
+                    header.next_offset >= header.elem_offset + header.capacity * sizeof(Elem_t) &&
+                    header.prev_offset >= header.next_offset + header.capacity * sizeof(ListArrayLink) &&
+                    header.file_size   >= header.prev_offset + header.capacity * sizeof(ListArrayLink) &&
+                    header.next_offset % ListFileHeader::ALIGNMENT == 0 &&
+                    header.prev_offset % ListFileHeader::ALIGNMENT == 0 &&
+                    header.file_size   % ListFileHeader::ALIGNMENT == 0;
+
+    FILE_CHECK_(!is_valid, close(fd));
+
+    // private mapping: changed pages are copied, file stays unchanged
+    void* mapping = mmap(nullptr, header.file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    FILE_CHECK_(mapping == MAP_FAILED);
+
+    ptr_valid_reset_cache();
+
+    char* base = (char*)mapping;
+
+    // file is checked once here, so verification of loaded list doesn't depend on its source
+    CHECK_AND_RETURN(list_file_checksum_(mapping, header.file_size) != header.checksum,
+                     list->CHECKSUM_MISMATCH, munmap(mapping, header.file_size), ptr_valid_reset_cache());
+
+    FILE_CHECK_(!list_file_links_are_valid_((ListArrayLink*)(base + header.next_offset),
+                                            (ListArrayLink*)(base + header.prev_offset), header.capacity),
+                munmap(mapping, header.file_size), ptr_valid_reset_cache());
+
+    list->arr.mapping      = mapping;
+    list->arr.mapping_size = header.file_size;
+
+    list->arr.elem = (Elem_t*)(base + header.elem_offset);
+    list->arr.next = (ListArrayLink*)(base + header.next_offset);
+    list->arr.prev = (ListArrayLink*)(base + header.prev_offset);
+
+    list->arr.capacity = header.capacity;
+    list->arr.free     = 0;
+
+    list->head = list_array_handle(header.head);
+    list->tail = list_array_handle(header.tail);
+    list->size = (ssize_t)header.size;
+
+    return res | LIST_ASSERT(list);
+}
+#undef FILE_CHECK_
@@ -0,0 +1,281 @@
+#include "list_internal.h"
+
+extern LogFileData log_file;
+
+/*
+ * Filters walk the list once: kept nodes are relinked to the previous kept node, matched nodes
+ * are chained by next links into victims chain. Links are changed only behind the cursor, so
+ * its prefetch frontier reads original links. Victims are freed (or moved to other list)
+ * after the walk, indexes are rebuilt lazily once
+ */
+
+/**
+ * @brief State of single pass filter
+ */
+struct ListFilter {
+    List* list = nullptr;
+    List* out  = nullptr;   //< victims are moved to out (nullptr - victims are freed)
+    bool is_copied = false; //< out has other storage: victims are copied to out nodes during walk
+
+    ListNode* kept_first = nullptr;
+    ListNode* kept_last  = nullptr;
+
+    ListNode* victims_first = nullptr;
+    ListNode* victims_last  = nullptr;
+
+    ListNode* copies_first = nullptr;   //< copies of victims in out storage (is_copied)
+    ListNode* copies_last  = nullptr;
+
+    size_t removed = 0;
+};
+
+static void filter_keep_(ListFilter* filter, ListNode* node) {
+    List* list = filter->list;
+
+    list_node_set_prev(list, node, filter->kept_last);
+
+    if (filter->kept_last == nullptr)
+        filter->kept_first = node;
+    else
+        list_node_set_next(list, filter->kept_last, node);
+
+    filter->kept_last = node;
+}
+
+/**
+ * @brief Adds node to victims chain. Its copy is made in out storage if needed
+ *
+ * @return false copy can't be allocated (node is not taken)
+ */
+static bool filter_take_(ListFilter* filter, ListNode* node) {
+    List* list = filter->list;
+
+    if (filter->is_copied) {
+        List* out = filter->out;
+
+        ListNode* copy = list_node_alloc(out);
+        if (copy == nullptr)
+            return false;
+
+        list_node_set_elem(out, copy, list_node_elem(list, node));
+        list_node_set_prev(out, copy, filter->copies_last);
+        list_node_set_next(out, copy, nullptr);
+
+        if (filter->copies_last == nullptr)
+            filter->copies_first = copy;
+        else
+            list_node_set_next(out, filter->copies_last, copy);
+
+        filter->copies_last = copy;
+    }
+
+    if (filter->victims_last == nullptr)
+        filter->victims_first = node;
+    else
+        list_node_set_next(list, filter->victims_last, node);
+
+    filter->victims_last = node;
+    filter->removed++;
+
+    return true;
+}
+
+/**
+ * @brief Appends chain [first, last] with valid links to the end of list
+ */
+static void filter_append_chain_(List* list, ListNode* first, ListNode* last, const size_t cnt) {
+    list_node_set_prev(list, first, list->tail);
+
+    if (list->tail == nullptr)
+        list->head = first;
+    else
+        list_node_set_next(list, list->tail, first);
+
+    list->tail = last;
+    list->size += (ssize_t)cnt;
+}
+
+/**
+ * @brief Decides if node is removed (true) or kept (false)
+ */
+typedef bool (*ListFilterDecide)(void* ctx, const Elem_t elem);
+
+/**
+ * @brief Walks list once, removes nodes chosen by decide and frees them or moves them to out
+ *
+ * @param list
+ * @param decide
+ * @param ctx decide argument
+ * @param out (optional) list victims are appended to
+ * @param removed (optional) number of removed elements
+ * @return int ALLOC_ERR if victims can't be copied to out: walk is stopped, rest of list is kept
+ */
+static int list_filter_(List* list, ListFilterDecide decide, void* ctx, List* out, size_t* removed) {
+    int res = list->OK;
+
+    ListFilter filter = {};
+    filter.list = list;
+    filter.out  = out;
+    filter.is_copied = out != nullptr && !(list->engine == List::ENGINE_NODES &&
+                                           out->engine  == List::ENGINE_NODES && list->pool == out->pool);
+
+    ListNode* rest = nullptr;   //< first node which wasn't processed (walk is stopped)
+
+    ListCursor cursor = {};
+    for (list_begin(list, &cursor); cursor.node != nullptr; list_next(&cursor)) {
+        ListNode* node = cursor.node;
+
+        if (!decide(ctx, list_node_elem(list, node))) {
+            filter_keep_(&filter, node);
+            continue;
+        }
+
+        if (!filter_take_(&filter, node)) {
+            res |= list->ALLOC_ERR;
+            rest = node;
+            break;
+        }
+    }
+
+    if (rest != nullptr) {
+        // rest of list is kept with its links
+        list_node_set_prev(list, rest, filter.kept_last);
+
+        if (filter.kept_last == nullptr)
+            filter.kept_first = rest;
+        else
+            list_node_set_next(list, filter.kept_last, rest);
+    } else {
+        if (filter.kept_last != nullptr)
+            list_node_set_next(list, filter.kept_last, nullptr);
+
+        list->tail = filter.kept_last;
+    }
+
+    list->head = filter.kept_first;
+    list->size -= (ssize_t)filter.removed;
+
+    if (removed != nullptr)
+        *removed = filter.removed;
+
+    if (filter.removed == 0)
+        return res;
+
+    LIST_STATS_ADD(list, deletes, filter.removed);
+
+    list_indexes_invalidate(list);
+
+    list_node_set_next(list, filter.victims_last, nullptr);
+
+    if (out != nullptr && !filter.is_copied) {
+        // victims are relinked to out
+        ListNode* prev = nullptr;
+        for (ListNode* node = filter.victims_first; node != nullptr; node = list_node_next(list, node)) {
+            list_node_set_prev(list, node, prev);
+            prev = node;
+        }
+
+        filter_append_chain_(out, filter.victims_first, filter.victims_last, filter.removed);
+        list_indexes_invalidate(out);
+
+        LIST_STATS_ADD(out, inserts, filter.removed);
+
+        return res;
+    }
+
+    if (out != nullptr) {
+        filter_append_chain_(out, filter.copies_first, filter.copies_last, filter.removed);
+        list_indexes_invalidate(out);
+
+        LIST_STATS_ADD(out, inserts, filter.removed);
+    }
+
+    // deferred frees: victims are returned to storage after list is consistent
+    ListNode* node = filter.victims_first;
+    while (node != nullptr) {
+        ListNode* next = list_node_next(list, node);
+        list_node_free(list, node);
+        node = next;
+    }
+
+    return res;
+}
+
+/**
+ * @brief User predicate of list_remove_if() and list_partition()
+ */
+struct ListPredContext {
+    ListPred pred = nullptr;
+    void* ctx = nullptr;
+};
+
+static bool filter_pred_(void* ctx, const Elem_t elem) {
+    ListPredContext* pred = (ListPredContext*)ctx;
+
+    return pred->pred(pred->ctx, elem);
+}
+
+int list_remove_if(List* list, ListPred pred, void* ctx, size_t* removed) {
+    assert(pred);
+    int res = LIST_ASSERT(list);
+
+    LIST_STATS_TIMER(list, OP_DELETE);
+
+    ListPredContext pred_ctx = {pred, ctx};
+    res |= list_filter_(list, filter_pred_, &pred_ctx, nullptr, removed);
+
+    res |= LIST_ASSERT(list);
+
+    return res;
+}
+
+int list_partition(List* list, ListPred pred, void* ctx, List* out, size_t* moved) {
+    assert(pred);
+    int res = LIST_ASSERT(list);
+    res |= LIST_ASSERT(out);
+
+    CHECK_AND_RETURN(out == list, list->INVALID_PTR_GIVEN);
+
+    LIST_STATS_TIMER(list, OP_DELETE);
+
+    ListPredContext pred_ctx = {pred, ctx};
+    res |= list_filter_(list, filter_pred_, &pred_ctx, out, moved);
+
+    res |= LIST_ASSERT(out);
+    res |= LIST_ASSERT(list);
+
+    return res;
+}
+
+/**
+ * @brief list_unique() state: the last kept element
+ */
+struct ListUniqueContext {
+    bool is_first = true;
+    Elem_t last = ListNode::POISON;
+};
+
+static bool filter_unique_(void* ctx, const Elem_t elem) {
+    ListUniqueContext* unique = (ListUniqueContext*)ctx;
+
+    if (!unique->is_first && elem == unique->last)
+        return true;
+
+    unique->is_first = false;
+    unique->last = elem;
+
+    return false;
+}
+
+int list_unique(List* list, size_t* removed) {
+    int res = LIST_ASSERT(list);
+
+    LIST_STATS_TIMER(list, OP_DELETE);
+
+    ListUniqueContext unique = {};
+    res |= list_filter_(list, filter_unique_, &unique, nullptr, removed);
+
+    res |= LIST_ASSERT(list);
+
+    return res;
+}
@@ -0,0 +1,534 @@
+#ifndef LIST_INTERNAL_H_
+#define LIST_INTERNAL_H_
+
+#include "list.h"
+#include "list_check.h"
+#include "utils/hash_map.h"
+#include "utils/simd_search.h"
+
+#include <sys/mman.h>
+
+// Engine-independent node access for list implementation files. Not a part of public API
+
+#define CHECK_AND_RETURN(clause_, error_, ...)  if (clause_) {          \
+                                                    res |= error_;      \
+                                                    LIST_OK(list, res); \
+                                                    __VA_ARGS__;        \
+                                                    return res;         \
+                                                }
+
+/**
+ * @brief Sets next element handle
+ *
+ * @param list
+ * @param node
+ * @param next
+ */
+inline void list_node_set_next(List* list, ListNode* node, ListNode* next) {
+    if (list->engine == List::ENGINE_ARRAY) {
+        list->arr.next[list_array_index(node)] = (ListArrayLink)list_array_index(next);
+    } else {
+        node->next = next;
+    }
+}
+
+/**
+ * @brief Sets previous element handle
+ *
+ * @param list
+ * @param node
+ * @param prev
+ */
+inline void list_node_set_prev(List* list, ListNode* node, ListNode* prev) {
+    if (list->engine == List::ENGINE_ARRAY) {
+        list->arr.prev[list_array_index(node)] = (ListArrayLink)list_array_index(prev);
+    } else {
+        node->prev = prev;
+    }
+}
+
+/**
+ * @brief Sets element value
+ *
+ * @param list
+ * @param node
+ * @param elem
+ */
+inline void list_node_set_elem(List* list, ListNode* node, const Elem_t elem) {
+    if (list->engine == List::ENGINE_ARRAY) {
+        list->arr.elem[list_array_index(node)] = elem;
+    } else {
+        node->elem = elem;
+    }
+}
+
+/**
+ * @brief ENGINE_ARRAY storage constructor
+ *
+ * @param list
+ */
+void list_array_ctor(List* list);
+
+/**
+ * @brief ENGINE_ARRAY storage destructor
+ *
+ * @param list
+ */
+void list_array_dtor(List* list);
+
+/**
+ * @brief Makes sure that there are at least n free slots
+ *
+ * @param list
+ * @param n
+ * @return true success
+ * @return false allocation failure
+ */
+bool list_array_reserve(List* list, const size_t n);
+
+/**
+ * @brief Takes free slot. Grows arrays if needed
+ *
+ * @param list
+ * @return ListNode* handle. nullptr if allocation failed
+ */
+ListNode* list_array_alloc(List* list);
+
+/**
+ * @brief Returns slot to free slots chain
+ *
+ * @param list
+ * @param node
+ */
+void list_array_free(List* list, ListNode* node);
+
+/**
+ * @brief Moves arrays mapped by list_load_mmap() to heap and unmaps file
+ *
+ * @param list
+ * @return true success
+ * @return false allocation failure
+ */
+bool list_array_unmap(List* list);
+
+// Operation counters (see list_stats()). Compiled out if LIST_STATS is not defined
+
+#ifdef LIST_STATS
+
+/**
+ * @brief Returns monotonic time in nanoseconds
+ *
+ * @return uint64_t
+ */
+uint64_t list_stats_now();
+
+/**
+ * @brief Adds operation latency to histogram
+ *
+ * @param list
+ * @param op
+ * @param begin operation start time (list_stats_now())
+ */
+void list_stats_record(const List* list, const ListStats::Op op, const uint64_t begin);
+
+/**
+ * @brief Prints stats section of list_dump()
+ *
+ * @param list
+ */
+void list_stats_dump(const List* list);
+
+/**
+ * @brief Records latency of operation when leaving scope (on every return)
+ */
+struct ListStatsTimer {
+    const List* list = nullptr;
+    ListStats::Op op = ListStats::OP_INSERT;
+    uint64_t begin = 0;
+
+    ListStatsTimer(const List* list_, const ListStats::Op op_) :
+        list(list_), op(op_), begin(list_stats_now()) {}
+
+    ListStatsTimer(const ListStatsTimer&) = delete;
+    ListStatsTimer& operator=(const ListStatsTimer&) = delete;
+
+    ~ListStatsTimer() { list_stats_record(list, op, begin); }
+};
+
+#define LIST_STATS_ADD(list_, counter_, n_)  do {                                       \
+                                                if ((list_)->stats != nullptr)          \
+                                                    (list_)->stats->counter_ += (n_);   \
+                                             } while (0)
+
+#define LIST_STATS_TIMER(list_, op_) ListStatsTimer stats_timer_(list_, ListStats::op_)
+
+#else //< #ifndef LIST_STATS
+
+#define LIST_STATS_ADD(list_, counter_, n_) (void) 0
+#define LIST_STATS_TIMER(list_, op_)        (void) 0
+
+#endif //< #ifdef LIST_STATS
+
+/**
+ * @brief Returns number of nodes that storage holds without growing
+ *
+ * @param list
+ * @return size_t
+ */
+inline size_t list_node_capacity(const List* list) {
+    if (list->engine == List::ENGINE_ARRAY)
+        return list->arr.capacity;
+
+    return list->pool->capacity;
+}
+
+/**
+ * @brief Returns physical distance between adjacent nodes: handle difference
+ * (ENGINE_ARRAY handles are indices) or node size in bytes
+ *
+ * @param list
+ * @return size_t
+ */
+inline size_t list_node_stride(const List* list) {
+    if (list->engine == List::ENGINE_ARRAY)
+        return 1;
+
+    return list->pool->obj_size;
+}
+
+/**
+ * @brief Returns physical distance between nodes in nodes, limited by List::FRAGMENTATION_MAX_DISTANCE
+ *
+ * @param a node address or handle
+ * @param b node address or handle
+ * @param stride list_node_stride()
+ * @return size_t
+ */
+inline size_t list_node_distance(const uint64_t a, const uint64_t b, const size_t stride) {
+    uint64_t distance = ((a < b) ? b - a : a - b) / stride;
+
+    return (size_t)MIN(distance, (uint64_t)List::FRAGMENTATION_MAX_DISTANCE);
+}
+
+/**
+ * @brief Allocates unlinked node in list storage
+ *
+ * @param list
+ * @return ListNode* nullptr if allocation failed
+ */
+inline ListNode* list_node_alloc(List* list) {
+#ifdef LIST_STATS
+    size_t capacity = list_node_capacity(list);
+#endif //< #ifdef LIST_STATS
+
+    ListNode* node = (list->engine == List::ENGINE_ARRAY) ? list_array_alloc(list) :
+                                                             (ListNode*)obj_pool_alloc(list->pool);
+
+    LIST_STATS_ADD(list, node_allocs,    node != nullptr);
+    LIST_STATS_ADD(list, storage_allocs, list_node_capacity(list) != capacity);
+
+    return node;
+}
+
+/**
+ * @brief Makes sure that next n list_node_alloc() calls won't fail
+ *
+ * @param list
+ * @param n
+ * @return true success
+ * @return false allocation failure
+ */
+inline bool list_node_reserve(List* list, const size_t n) {
+#ifdef LIST_STATS
+    size_t capacity = list_node_capacity(list);
+#endif //< #ifdef LIST_STATS
+
+    bool is_reserved = (list->engine == List::ENGINE_ARRAY) ? list_array_reserve(list, n) :
+                                                               obj_pool_reserve(list->pool, n);
+
+    LIST_STATS_ADD(list, storage_allocs, list_node_capacity(list) != capacity);
+
+    return is_reserved;
+}
+
+/**
+ * @brief Poisons and frees unlinked node
+ *
+ * @param list
+ * @param node
+ */
+inline void list_node_free(List* list, ListNode* node) {
+    if (list->engine == List::ENGINE_ARRAY) {
+        list_array_free(list, node);
+        return;
+    }
+
+    node->elem = ListNode::POISON;
+    obj_pool_free(list->pool, node);
+}
+
+/**
+ * @brief Adds node (already linked after prev) to order index
+ *
+ * @param list
+ * @param prev
+ * @param node
+ */
+void list_order_index_insert(List* list, const ListNode* prev, ListNode* node);
+
+/**
+ * @brief Removes node (before unlinking) from order index
+ *
+ * @param list
+ * @param node
+ */
+void list_order_index_delete(List* list, const ListNode* node);
+
+/**
+ * @brief Makes order index empty
+ *
+ * @param list
+ */
+void list_order_index_clear(List* list);
+
+/**
+ * @brief Marks order index outdated. It will be rebuilt on next lookup
+ *
+ * @param list
+ */
+void list_order_index_invalidate(List* list);
+
+/**
+ * @brief Finds element by logical index with order index
+ *
+ * @param list
+ * @param logical_i must be in [0, size)
+ * @param ptr
+ * @return true success
+ * @return false index can't be rebuilt
+ */
+bool list_order_index_find(const List* list, ssize_t logical_i, ListNode** ptr);
+
+/**
+ * @brief Returns logical index of element with order index
+ *
+ * @param list
+ * @param ptr
+ * @param logical_i -1 if not found
+ * @return true success
+ * @return false index can't be rebuilt
+ */
+bool list_order_index_rank(const List* list, const ListNode* ptr, ssize_t* logical_i);
+
+/**
+ * @brief Checks that order index matches list (O(1))
+ *
+ * @param list
+ * @return int
+ */
+int list_order_index_verify(const List* list);
+
+/**
+ * @brief Checks if order index matches list, so it is used without rebuild
+ *
+ * @param list
+ * @return true
+ * @return false index is outdated
+ */
+bool list_order_index_is_ready(const List* list);
+
+/**
+ * @brief Adds node (already linked after prev) to value index. Value chain stays in logical order
+ * if node is inserted at list end or beginning, otherwise chain is marked unordered
+ *
+ * @param list
+ * @param prev
+ * @param node
+ */
+void list_value_index_insert(List* list, const ListNode* prev, ListNode* node);
+
+/**
+ * @brief Removes node (before unlinking) from value index
+ *
+ * @param list
+ * @param node
+ */
+void list_value_index_delete(List* list, const ListNode* node);
+
+/**
+ * @brief Makes value index empty
+ *
+ * @param list
+ */
+void list_value_index_clear(List* list);
+
+/**
+ * @brief Rebuilds value index after list was changed without hooks (O(n)). If rebuild fails,
+ * index stays outdated and lookups fall back to list walk until the next successful invalidation
+ *
+ * @param list
+ */
+void list_value_index_invalidate(List* list);
+
+/**
+ * @brief Finds the first element with given value with value index
+ *
+ * @param list
+ * @param elem
+ * @param ptr nullptr if not found
+ * @return true success
+ * @return false index is outdated
+ */
+bool list_value_index_find(const List* list, const Elem_t elem, ListNode** ptr);
+
+/**
+ * @brief Counts elements with given value with value index
+ *
+ * @return true success
+ * @return false index is outdated
+ */
+bool list_value_index_count(const List* list, const Elem_t elem, size_t* count);
+
+/**
+ * @brief Finds all elements with given value with value index (in logical order)
+ *
+ * @return true success
+ * @return false index is outdated or memory can't be allocated
+ */
+bool list_value_index_find_all(const List* list, const Elem_t elem,
+                               ListNode** ptrs, const size_t max_cnt, size_t* found);
+
+/**
+ * @brief Checks that value index matches list (O(n))
+ *
+ * @param list
+ * @return int
+ */
+int list_value_index_verify(const List* list);
+
+/**
+ * @brief Serial walk part of list_verify(): links, node handles and poison values from head to tail
+ *
+ * @param list
+ * @param check_poison
+ * @return int
+ */
+int list_verify_links(const List* list, const bool check_poison);
+
+/**
+ * @brief Parallel walk part of list_verify(). Returns the same result as list_verify_links()
+ *
+ * @param list
+ * @param check_poison
+ * @param threads 0 - number of CPUs
+ * @return int
+ */
+int list_verify_links_parallel(const List* list, const bool check_poison, const size_t threads);
+
+/**
+ * @brief Releases all nodes in one pass. List must be verified before
+ *
+ * @param list
+ * @param async free memory in background thread
+ */
+void list_release_nodes(List* list, const bool async);
+
+// Hooks for optional indexes. Called by every function that links or unlinks nodes
+
+inline void list_indexes_on_insert(List* list, const ListNode* prev, ListNode* node) {
+    if (list->order_index != nullptr)
+        list_order_index_insert(list, prev, node);
+
+    if (list->value_index != nullptr)
+        list_value_index_insert(list, prev, node);
+}
+
+/**
+ * @brief Called after chain [first, last] of k nodes is linked after prev
+ */
+inline void list_indexes_on_insert_chain(List* list, const ListNode* prev, ListNode* first,
+                                         const ListNode* last, const size_t k) {
+    if (list->order_index == nullptr && list->value_index == nullptr)
+        return;
+
+    // for long chains full order index rebuild is cheaper than k insertions
+    bool order_rebuild = k * 4 > (size_t)list->size;
+
+    if (list->order_index != nullptr && order_rebuild)
+        list_order_index_invalidate(list);
+
+    ListNode* node = first;
+    while (true) {
+        if (list->order_index != nullptr && !order_rebuild)
+            list_order_index_insert(list, prev, node);
+
+        if (list->value_index != nullptr)
+            list_value_index_insert(list, prev, node);
+
+        if (node == last)
+            break;
+
+        prev = node;
+        node = list_node_next(list, node);
+    }
+}
+
+/**
+ * @brief Fragmentation check of automatic relayout (see list_set_relayout())
+ *
+ * @param list
+ * @param tracked (optional) handle translated if list is relayouted
+ */
+void list_relayout_check(List* list, ListNode** tracked);
+
+/**
+ * @brief Called after insertion or deletion of one node. Starts fragmentation check
+ * every max(size, List::RELAYOUT_MIN_CHANGES) calls
+ */
+inline void list_relayout_on_change(List* list, ListNode** tracked) {
+    if (list->relayout_threshold <= 0)
+        return;
+
+    if (++list->relayout_changes < MAX((size_t)list->size, List::RELAYOUT_MIN_CHANGES))
+        return;
+
+    list_relayout_check(list, tracked);
+}
+
+inline void list_indexes_on_delete(List* list, const ListNode* node) {
+    if (list->order_index != nullptr)
+        list_order_index_delete(list, node);
+
+    if (list->value_index != nullptr)
+        list_value_index_delete(list, node);
+}
+
+inline void list_indexes_on_clear(List* list) {
+    if (list->order_index != nullptr)
+        list_order_index_clear(list);
+
+    if (list->value_index != nullptr)
+        list_value_index_clear(list);
+}
+
+inline void list_indexes_invalidate(List* list) {
+    if (list->order_index != nullptr)
+        list_order_index_invalidate(list);
+
+    if (list->value_index != nullptr)
+        list_value_index_invalidate(list);
+}
+
+inline int list_indexes_verify(const List* list) {
+    int res = List::OK;
+
+    if (list->order_index != nullptr)
+        res |= list_order_index_verify(list);
+
+    if (list->value_index != nullptr)
+        res |= list_value_index_verify(list);
+
+    return res;
+}
+
+#endif //< #ifndef LIST_INTERNAL_H_
@@ -0,0 +1,484 @@
+#include "list_internal.h"
+
+extern LogFileData log_file;
+
+/**
+ * @brief Counted treap node. In-order traversal of treap gives logical order of list
+ */
+struct OrderNode {
+    OrderNode* left   = nullptr;
+    OrderNode* right  = nullptr;
+    OrderNode* parent = nullptr;
+
+    ListNode* node = nullptr;   //< list element handle
+
+    size_t   size = 1;          //< number of nodes in subtree
+    uint32_t prio = 0;          //< heap priority
+};
+
+/**
+ * @brief Order-statistic index of list
+ */
+struct ListOrderIndex {
+    OrderNode* root = nullptr;
+
+    ObjPool nodes = {};         //< OrderNode allocator
+    HashMap map = {};           //< ListNode* handle -> OrderNode*
+
+    uint64_t rand = 0x2545F4914F6CDD1Dull;
+
+    bool is_dirty = false;      //< index doesn't match list and must be rebuilt before use
+
+    ListIndexStats stats = {};
+};
+
+static inline size_t order_size_(const OrderNode* node) {
+    return node ? node->size : 0;
+}
+
+static inline void order_update_size_(OrderNode* node) {
+    node->size = 1 + order_size_(node->left) + order_size_(node->right);
+}
+
+static uint32_t order_rand_(ListOrderIndex* index) {
+    // xorshift64
+    index->rand ^= index->rand << 13;
+    index->rand ^= index->rand >> 7;
+    index->rand ^= index->rand << 17;
+
+    return (uint32_t)(index->rand >> 32);
+}
+
+/**
+ * @brief Rotates node up (above its parent)
+ */
+static void order_rotate_up_(ListOrderIndex* index, OrderNode* node) {
+    assert(index);
+    assert(node);
+    assert(node->parent);
+
+    OrderNode* parent = node->parent;
+
+    if (node == parent->left) {
+        parent->left = node->right;
+        if (node->right != nullptr)
+            node->right->parent = parent;
+        node->right = parent;
+    } else {
+        parent->right = node->left;
+        if (node->left != nullptr)
+            node->left->parent = parent;
+        node->left = parent;
+    }
+
+    node->parent = parent->parent;
+    if (node->parent == nullptr)
+        index->root = node;
+    else if (node->parent->left == parent)
+        node->parent->left = node;
+    else
+        node->parent->right = node;
+
+    parent->parent = node;
+
+    order_update_size_(parent);
+    order_update_size_(node);
+
+    index->stats.update_steps++;
+}
+
+/**
+ * @brief Inserts order node after prev order node (nullptr - at the beginning)
+ */
+static void order_insert_after_(ListOrderIndex* index, OrderNode* prev, OrderNode* node) {
+    assert(index);
+    assert(node);
+
+    if (index->root == nullptr) {
+        index->root = node;
+        return;
+    }
+
+    OrderNode* parent = nullptr;
+    bool as_left = true;
+
+    if (prev == nullptr) {
+        parent = index->root;
+    } else if (prev->right == nullptr) {
+        parent = prev;
+        as_left = false;
+    } else {
+        parent = prev->right;
+    }
+
+    if (as_left) {
+        while (parent->left != nullptr)
+            parent = parent->left;
+
+        parent->left = node;
+    } else {
+        parent->right = node;
+    }
+
+    node->parent = parent;
+
+    for (OrderNode* ptr = parent; ptr != nullptr; ptr = ptr->parent)
+        ptr->size++;
+
+    while (node->parent != nullptr && node->parent->prio < node->prio)
+        order_rotate_up_(index, node);
+}
+
+static void order_remove_(ListOrderIndex* index, OrderNode* node) {
+    assert(index);
+    assert(node);
+
+    // node is rotated down to leaf
+    while (node->left != nullptr || node->right != nullptr) {
+        OrderNode* child = node->left;
+
+        if (child == nullptr || (node->right != nullptr && node->right->prio > child->prio))
+            child = node->right;
+
+        order_rotate_up_(index, child);
+    }
+
+    OrderNode* parent = node->parent;
+
+    if (parent == nullptr)
+        index->root = nullptr;
+    else if (parent->left == node)
+        parent->left = nullptr;
+    else
+        parent->right = nullptr;
+
+    for (OrderNode* ptr = parent; ptr != nullptr; ptr = ptr->parent)
+        ptr->size--;
+}
+
+static OrderNode* order_find_(ListOrderIndex* index, const ListNode* node) {
+    assert(index);
+
+    uint64_t* value = hash_map_find(&index->map, (uint64_t)(uintptr_t)node);
+
+    return value ? (OrderNode*)(uintptr_t)*value : nullptr;
+}
+
+static void order_reset_(ListOrderIndex* index) {
+    assert(index);
+
+    obj_pool_free_chunks(obj_pool_detach(&index->nodes));
+    hash_map_dtor(&index->map);
+
+    index->root = nullptr;
+}
+
+static bool order_add_(ListOrderIndex* index, const ListNode* prev, ListNode* node) {
+    assert(index);
+
+    OrderNode* prev_order = nullptr;
+    if (prev != nullptr) {
+        prev_order = order_find_(index, prev);
+        if (prev_order == nullptr)
+            return false;
+    }
+
+    OrderNode* order = (OrderNode*)obj_pool_alloc(&index->nodes);
+    if (order == nullptr)
+        return false;
+
+    *order = {};
+    order->node = node;
+    order->prio = order_rand_(index);
+
+    if (!hash_map_set(&index->map, (uint64_t)(uintptr_t)node, (uint64_t)(uintptr_t)order)) {
+        obj_pool_free(&index->nodes, order);
+        return false;
+    }
+
+    order_insert_after_(index, prev_order, order);
+
+    return true;
+}
+
+/**
+ * @brief Builds treap from list in O(n): nodes are appended in logical order,
+ * right spine of treap is kept in stack
+ */
+static bool order_build_(const List* list, ListOrderIndex* index) {
+    assert(list);
+    assert(index);
+
+    size_t stack_capacity = 64;
+    size_t stack_size = 0;
+    OrderNode** stack = (OrderNode**)calloc(stack_capacity, sizeof(OrderNode*));
+    if (stack == nullptr)
+        return false;
+
+    bool ret = true;
+
+    for (ListNode* ptr : list_range(list)) {
+        OrderNode* order = (OrderNode*)obj_pool_alloc(&index->nodes);
+        if (order == nullptr ||
+            !hash_map_set(&index->map, (uint64_t)(uintptr_t)ptr, (uint64_t)(uintptr_t)order)) {
+            ret = false;
+            break;
+        }
+
+        *order = {};
+        order->node = ptr;
+        order->prio = order_rand_(index);
+
+        // nodes popped from spine have final subtrees
+        OrderNode* last_popped = nullptr;
+        while (stack_size > 0 && stack[stack_size - 1]->prio < order->prio) {
+            last_popped = stack[--stack_size];
+            order_update_size_(last_popped);
+        }
+
+        order->left = last_popped;
+        if (last_popped != nullptr)
+            last_popped->parent = order;
+
+        if (stack_size > 0) {
+            stack[stack_size - 1]->right = order;
+            order->parent = stack[stack_size - 1];
+        }
+
+        if (stack_size == stack_capacity) {
+            OrderNode** new_stack = (OrderNode**)realloc(stack, stack_capacity * 2 * sizeof(OrderNode*));
+            if (new_stack == nullptr) {
+                ret = false;
+                break;
+            }
+
+            stack = new_stack;
+            stack_capacity *= 2;
+        }
+
+        stack[stack_size++] = order;
+    }
+
+    if (ret) {
+        index->root = stack_size > 0 ? stack[0] : nullptr;
+
+        while (stack_size > 0)
+            order_update_size_(stack[--stack_size]);
+    }
+
+    free(stack);
+
+    return ret;
+}
+
+static bool list_order_index_rebuild_(const List* list) {
+    assert(list);
+    assert(list->order_index);
+
+    ListOrderIndex* index = list->order_index;
+
+    timespec begin = {};
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    order_reset_(index);
+
+    index->is_dirty = true;
+
+    if (!hash_map_ctor(&index->map, (size_t)list->size) ||
+        !obj_pool_reserve(&index->nodes, (size_t)list->size) ||
+        !order_build_(list, index))
+        return false;
+
+    index->is_dirty = false;
+
+    timespec end = {};
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    index->stats.rebuilds++;
+    index->stats.rebuild_time += (double)(end.tv_sec  - begin.tv_sec) +
+                                 (double)(end.tv_nsec - begin.tv_nsec) * 1e-9;
+
+    return true;
+}
+
+int list_order_index_enable(List* list) {
+    int res = LIST_ASSERT(list);
+
+    if (list->order_index != nullptr)
+        return res;
+
+    ListOrderIndex* index = (ListOrderIndex*)calloc(1, sizeof(ListOrderIndex));
+    CHECK_AND_RETURN(index == nullptr, list->ALLOC_ERR);
+
+    *index = {};
+    obj_pool_ctor(&index->nodes, sizeof(OrderNode));
+
+    list->order_index = index;
+
+    CHECK_AND_RETURN(!list_order_index_rebuild_(list), list->ALLOC_ERR, {
+                     list_order_index_disable(list);});
+
+    return res;
+}
+
+void list_order_index_disable(List* list) {
+    assert(list);
+
+    if (list->order_index == nullptr)
+        return;
+
+    order_reset_(list->order_index);
+    obj_pool_dtor(&list->order_index->nodes);
+
+    FREE(list->order_index);
+}
+
+int list_order_index_stats(const List* list, ListIndexStats* stats) {
+    assert(stats);
+    int res = LIST_ASSERT(list);
+
+    CHECK_AND_RETURN(list->order_index == nullptr, list->INVALID_PTR_GIVEN);
+
+    ListOrderIndex* index = list->order_index;
+
+    *stats = index->stats;
+    stats->memory = sizeof(ListOrderIndex) + hash_map_memory(&index->map) +
+                    index->nodes.capacity * index->nodes.obj_size;
+
+    return res;
+}
+
+void list_order_index_insert(List* list, const ListNode* prev, ListNode* node) {
+    assert(list);
+    assert(list->order_index);
+
+    ListOrderIndex* index = list->order_index;
+
+    if (index->is_dirty)
+        return;
+
+    index->stats.updates++;
+
+    if (!order_add_(index, prev, node))
+        index->is_dirty = true;
+}
+
+void list_order_index_delete(List* list, const ListNode* node) {
+    assert(list);
+    assert(list->order_index);
+
+    ListOrderIndex* index = list->order_index;
+
+    if (index->is_dirty)
+        return;
+
+    index->stats.updates++;
+
+    OrderNode* order = order_find_(index, node);
+    if (order == nullptr) {
+        index->is_dirty = true;
+        return;
+    }
+
+    order_remove_(index, order);
+
+    hash_map_erase(&index->map, (uint64_t)(uintptr_t)node);
+    obj_pool_free(&index->nodes, order);
+}
+
+void list_order_index_clear(List* list) {
+    assert(list);
+    assert(list->order_index);
+
+    ListOrderIndex* index = list->order_index;
+
+    order_reset_(index);
+    index->is_dirty = !hash_map_ctor(&index->map);
+}
+
+int list_order_index_verify(const List* list) {
+    assert(list);
+    assert(list->order_index);
+
+    ListOrderIndex* index = list->order_index;
+
+    if (index->is_dirty)
+        return list->OK;
+
+    if (index->map.size != (size_t)list->size || order_size_(index->root) != (size_t)list->size)
+        return list->INDEX_MISMATCH;
+
+    return list->OK;
+}
+
+void list_order_index_invalidate(List* list) {
+    assert(list);
+    assert(list->order_index);
+
+    list->order_index->is_dirty = true;
+}
+
+bool list_order_index_is_ready(const List* list) {
+    assert(list);
+    assert(list->order_index);
+
+    return !list->order_index->is_dirty;
+}
+
+bool list_order_index_find(const List* list, ssize_t logical_i, ListNode** ptr) {
+    assert(list);
+    assert(list->order_index);
+    assert(ptr);
+
+    ListOrderIndex* index = list->order_index;
+
+    if (index->is_dirty && !list_order_index_rebuild_(list))
+        return false;
+
+    OrderNode* node = index->root;
+    size_t i = (size_t)logical_i;
+
+    while (node != nullptr) {
+        size_t left_size = order_size_(node->left);
+
+        if (i < left_size) {
+            node = node->left;
+        } else if (i == left_size) {
+            break;
+        } else {
+            i -= left_size + 1;
+            node = node->right;
+        }
+    }
+
+    *ptr = node ? node->node : nullptr;
+
+    return true;
+}
+
+bool list_order_index_rank(const List* list, const ListNode* ptr, ssize_t* logical_i) {
+    assert(list);
+    assert(list->order_index);
+    assert(logical_i);
+
+    ListOrderIndex* index = list->order_index;
+
+    if (index->is_dirty && !list_order_index_rebuild_(list))
+        return false;
+
+    OrderNode* node = order_find_(index, ptr);
+    if (node == nullptr) {
+        *logical_i = -1;
+        return true;
+    }
+
+    size_t rank = order_size_(node->left);
+
+    for (; node->parent != nullptr; node = node->parent)
+        if (node == node->parent->right)
+            rank += order_size_(node->parent->left) + 1;
+
+    *logical_i = (ssize_t)rank;
+
+    return true;
+}
@@ -0,0 +1,239 @@
+#include "list_internal.h"
+
+extern LogFileData log_file;
+
+/*
+ * Relayout copies elements in logical order to new storage: slots 1..size (ENGINE_ARRAY) or one
+ * pool chunk filled by bump allocation (ENGINE_NODES). Old storage is released after copy, so
+ * list is not changed if new storage can't be allocated
+ */
+
+/**
+ * @brief Copies elements to new arrays. Free slots are chained after elements in physical order
+ */
+static int relayout_array_(List* list, ListRemap remap, void* ctx, ListNode** tracked) {
+    int res = list->OK;
+
+    size_t capacity = list->arr.capacity;
+
+    Elem_t*        elem = (Elem_t*)malloc(capacity * sizeof(Elem_t));
+    ListArrayLink* next = (ListArrayLink*)malloc(capacity * sizeof(ListArrayLink));
+    ListArrayLink* prev = (ListArrayLink*)malloc(capacity * sizeof(ListArrayLink));
+
+    CHECK_AND_RETURN(elem == nullptr || next == nullptr || prev == nullptr, list->ALLOC_ERR, {
+        free(elem);
+        free(next);
+        free(prev);
+    });
+
+    // zero slot is reserved
+    elem[0] = ListNode::POISON;
+    next[0] = 0;
+    prev[0] = ListArray::FREE_SLOT;
+
+    size_t size = (size_t)list->size;
+    size_t i = 1;
+
+    // new slot indices may equal old ones, so tracked handle is compared with its old value
+    ListNode* tracked_old = (tracked != nullptr) ? *tracked : nullptr;
+
+    ListCursor cursor = {};
+    for (list_begin(list, &cursor); cursor.node != nullptr; list_next(&cursor), i++) {
+        elem[i] = list_node_elem(list, cursor.node);
+        prev[i] = (ListArrayLink)(i - 1);
+        next[i] = (ListArrayLink)((i == size) ? 0 : i + 1);
+
+        if (remap != nullptr)
+            remap(ctx, cursor.node, list_array_handle(i));
+
+        if (tracked != nullptr && tracked_old == cursor.node)
+            *tracked = list_array_handle(i);
+    }
+
+    assert(i == size + 1);
+
+    for (size_t slot = size + 1; slot < capacity; slot++) {
+        elem[slot] = ListNode::POISON;
+        prev[slot] = ListArray::FREE_SLOT;
+        next[slot] = (ListArrayLink)((slot + 1 == capacity) ? 0 : slot + 1);
+    }
+
+    // unmaps mapped arrays too
+    list_array_dtor(list);
+
+    list->arr.elem = elem;
+    list->arr.next = next;
+    list->arr.prev = prev;
+
+    list->arr.capacity = capacity;
+    list->arr.free     = (size + 1 < capacity) ? size + 1 : 0;
+
+    list->head = list_array_handle(1);
+    list->tail = list_array_handle(size);
+
+    return res;
+}
+
+/**
+ * @brief Copies nodes to new pool with one chunk holding all of them
+ */
+static int relayout_nodes_(List* list, ListRemap remap, void* ctx, ListNode** tracked) {
+    int res = list->OK;
+
+    ObjPool* old_pool = list->pool;
+
+    ObjPool* pool = (ObjPool*)calloc(1, sizeof(ObjPool));
+    CHECK_AND_RETURN(pool == nullptr, list->ALLOC_ERR);
+
+    obj_pool_ctor(pool, sizeof(ListNode), old_pool->chunk_capacity);
+
+    CHECK_AND_RETURN(!obj_pool_reserve(pool, (size_t)list->size), list->ALLOC_ERR, {
+        obj_pool_dtor(pool);
+        free(pool);
+    });
+
+    ListNode* old_head = list->head;
+
+    list->pool = pool;
+
+    ListNode* first = nullptr;
+    ListNode* last  = nullptr;
+
+    ListNode* tracked_old = (tracked != nullptr) ? *tracked : nullptr;
+
+    // old nodes keep their links until they are released
+    ListCursor cursor = {};
+    for (list_begin(list, &cursor); cursor.node != nullptr; list_next(&cursor)) {
+        ListNode* node = list_node_alloc(list);
+        assert(node && "memory was reserved");
+
+        node->elem = cursor.node->elem;
+        node->prev = last;
+        node->next = nullptr;
+
+        if (last == nullptr)
+            first = node;
+        else
+            last->next = node;
+
+        last = node;
+
+        if (remap != nullptr)
+            remap(ctx, cursor.node, node);
+
+        if (tracked != nullptr && tracked_old == cursor.node)
+            *tracked = node;
+    }
+
+    list->head = first;
+    list->tail = last;
+
+    if (--old_pool->refs == 0) {
+        // all nodes in old pool belonged to this list
+        obj_pool_dtor(old_pool);
+        free(old_pool);
+        return res;
+    }
+
+    // pool is shared: nodes are returned to it one by one
+    ListNode* node = old_head;
+    while (node != nullptr) {
+        ListNode* next = node->next;
+
+        node->elem = ListNode::POISON;
+        obj_pool_free(old_pool, node);
+
+        node = next;
+    }
+
+    return res;
+}
+
+/**
+ * @brief list_linearize() with one more handle translated (handle returned by current operation)
+ */
+static int list_linearize_(List* list, ListRemap remap, void* ctx, ListNode** tracked) {
+    int res = list->OK;
+
+    if (list->size == 0)
+        return res;
+
+    if (list->engine == List::ENGINE_ARRAY)
+        res |= relayout_array_(list, remap, ctx, tracked);
+    else
+        res |= relayout_nodes_(list, remap, ctx, tracked);
+
+    if (res != list->OK)
+        return res;
+
+    list_indexes_invalidate(list);
+
+    list->relayout_changes = 0;
+
+    return res;
+}
+
+int list_linearize(List* list, ListRemap remap, void* ctx) {
+    int res = LIST_ASSERT(list);
+
+    res |= list_linearize_(list, remap, ctx, nullptr);
+
+    return res | LIST_ASSERT(list);
+}
+
+int list_fragmentation(const List* list, double* fragmentation) {
+    assert(fragmentation);
+    int res = LIST_ASSERT(list);
+
+    *fragmentation = 1;
+
+    if (list->size < 2)
+        return res;
+
+    size_t stride = list_node_stride(list);
+
+    size_t distance = 0;
+    ListNode* prev = nullptr;
+
+    ListCursor cursor = {};
+    for (list_begin(list, &cursor); cursor.node != nullptr; list_next(&cursor)) {
+        if (prev != nullptr)
+            distance += list_node_distance((uintptr_t)prev, (uintptr_t)cursor.node, stride);
+
+        prev = cursor.node;
+    }
+
+    *fragmentation = (double)distance / (double)(list->size - 1);
+
+    return res;
+}
+
+int list_set_relayout(List* list, const double threshold, ListRemap remap, void* ctx) {
+    int res = LIST_ASSERT(list);
+
+    // automatic relayout without remap would silently invalidate caller handles
+    CHECK_AND_RETURN(threshold > 0 && remap == nullptr, list->INVALID_PTR_GIVEN);
+
+    list->relayout_threshold = threshold;
+    list->relayout_remap     = remap;
+    list->relayout_ctx       = ctx;
+    list->relayout_changes   = 0;
+
+    return res;
+}
+
+void list_relayout_check(List* list, ListNode** tracked) {
+    assert(list);
+
+    list->relayout_changes = 0;
+
+    if (list->engine == List::ENGINE_NODES && list->pool->refs > 1)
+        return;
+
+    double fragmentation = 1;
+    if (list_fragmentation(list, &fragmentation) != list->OK || fragmentation < list->relayout_threshold)
+        return;
+
+    // list stays valid if relayout fails, it is retried on next check
+    list_linearize_(list, list->relayout_remap, list->relayout_ctx, tracked);
+}
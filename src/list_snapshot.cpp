@@ -0,0 +1,376 @@
+#include "list_snapshot.h"
+#include "list_internal.h"
+
+extern LogFileData log_file;
+
+static void snapshot_strcpy_(char* dst, const char* src, const size_t size) {
+    assert(dst);
+
+    if (src == nullptr)
+        return;
+
+    strncpy(dst, src, size - 1);
+    dst[size - 1] = '\0';
+}
+
+static bool list_snapshot_reserve_(ListSnapshot* snapshot, const size_t records) {
+    assert(snapshot);
+
+    if (records <= snapshot->records_capacity && snapshot->header != nullptr)
+        return true;
+
+    size_t old_size = snapshot->header == nullptr ? 0 :
+                      sizeof(ListSnapshotHeader) + snapshot->records_capacity * sizeof(ListSnapshotRecord);
+
+    size_t new_size = sizeof(ListSnapshotHeader) + records * sizeof(ListSnapshotRecord);
+
+    // zeroed memory: padding bytes are written to file too
+    char* block = (char*)recalloc(snapshot->header, old_size, new_size);
+    if (block == nullptr)
+        return false;
+
+    snapshot->header  = (ListSnapshotHeader*)block;
+    snapshot->records = (ListSnapshotRecord*)(block + sizeof(ListSnapshotHeader));
+    snapshot->records_capacity = records;
+
+    return true;
+}
+
+/**
+ * @brief list_visit() context of list_snapshot_take()
+ */
+struct ListSnapshotContext {
+    const List* list = nullptr;
+    ListSnapshot* snapshot = nullptr;
+
+    size_t count = 0;   //< number of written records
+};
+
+static bool list_snapshot_visitor_(void* ctx, ListNode* const* nodes, const size_t n) {
+    ListSnapshotContext* take = (ListSnapshotContext*)ctx;
+    const List* list = take->list;
+    ListSnapshot* snapshot = take->snapshot;
+
+    // size is damaged: path is longer
+    if (take->count + n > snapshot->records_capacity &&
+        !list_snapshot_reserve_(snapshot, MAX(snapshot->records_capacity * 2 + 1, take->count + n)))
+        return false;
+
+    for (size_t i = 0; i < n; i++) {
+        ListSnapshotRecord* record = &snapshot->records[take->count++];
+
+        record->ptr  = (uint64_t)(uintptr_t)nodes[i];
+        record->prev = (uint64_t)(uintptr_t)list_node_prev(list, nodes[i]);
+        record->next = (uint64_t)(uintptr_t)list_node_next(list, nodes[i]);
+        record->elem = list_node_elem(list, nodes[i]);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Computes fragmentation from records, so damaged lists are not walked again
+ */
+static double snapshot_fragmentation_(const List* list, const ListSnapshot* snapshot) {
+    size_t records = snapshot->header->records;
+
+    if (records < 2 || (list->engine == List::ENGINE_NODES && list->pool == nullptr))
+        return 1;
+
+    size_t stride = list_node_stride(list);
+    size_t distance = 0;
+
+    for (size_t i = 1; i < records; i++)
+        distance += list_node_distance(snapshot->records[i - 1].ptr, snapshot->records[i].ptr, stride);
+
+    return (double)distance / (double)(records - 1);
+}
+
+bool list_snapshot_take(const List* list, const VarCodeData call_data, ListSnapshot* snapshot) {
+    assert(list);
+    assert(snapshot);
+
+    *snapshot = {};
+
+    size_t records = list->size > 0 ? (size_t)list->size : 0;
+    if (!list_snapshot_reserve_(snapshot, records))
+        return false;
+
+    ListSnapshotHeader* header = snapshot->header;
+
+    header->magic       = ListSnapshotHeader::MAGIC;
+    header->version     = ListSnapshotHeader::VERSION;
+    header->record_size = sizeof(ListSnapshotRecord);
+
+    header->list_addr    = (uint64_t)(uintptr_t)list;
+    header->size         = list->size;
+    header->head         = (uint64_t)(uintptr_t)list->head;
+    header->tail         = (uint64_t)(uintptr_t)list->tail;
+    header->engine       = (uint32_t)list->engine;
+    header->verify_level = (uint32_t)list->verify_level;
+
+    if (list->engine == List::ENGINE_ARRAY) {
+        header->capacity = list->arr.capacity;
+        header->free     = list->arr.free;
+    }
+
+#ifdef DEBUG
+    snapshot_strcpy_(header->var_name, list->var_data.name, ListSnapshotHeader::MAX_NAME_LEN);
+    snapshot_strcpy_(header->var_file, list->var_data.file, ListSnapshotHeader::MAX_PATH_LEN);
+    snapshot_strcpy_(header->var_func, list->var_data.func, ListSnapshotHeader::MAX_NAME_LEN);
+    header->var_line = list->var_data.line;
+#else //< #ifndef DEBUG
+    VarCodeData var_data = {};
+    snapshot_strcpy_(header->var_name, var_data.name, ListSnapshotHeader::MAX_NAME_LEN);
+    snapshot_strcpy_(header->var_file, var_data.file, ListSnapshotHeader::MAX_PATH_LEN);
+    snapshot_strcpy_(header->var_func, var_data.func, ListSnapshotHeader::MAX_NAME_LEN);
+#endif //< #ifdef DEBUG
+
+    snapshot_strcpy_(header->call_file, call_data.file, ListSnapshotHeader::MAX_PATH_LEN);
+    snapshot_strcpy_(header->call_func, call_data.func, ListSnapshotHeader::MAX_NAME_LEN);
+    header->call_line = call_data.line;
+
+    if (!list_is_initialised(list))
+        header->flags |= ListSnapshotHeader::UNITIALISED;
+
+    if (!list_node_is_valid(list, list->head)) {
+        header->flags |= ListSnapshotHeader::HEAD_INVALID;
+        return true;
+    }
+
+    // damaged list is dumped up to the first invalid handle
+    ListSnapshotContext take = {list, snapshot};
+    list_visit(list, list_snapshot_visitor_, &take, true);
+
+    snapshot->header->records = take.count;
+
+    header->fragmentation = snapshot_fragmentation_(list, snapshot);
+
+    return true;
+}
+
+void list_snapshot_dtor(ListSnapshot* snapshot) {
+    assert(snapshot);
+
+    FREE(snapshot->header);
+
+    snapshot->records = nullptr;
+    snapshot->records_capacity = 0;
+}
+
+bool list_snapshot_write(const int fd, const ListSnapshot* snapshot) {
+    assert(snapshot);
+    assert(snapshot->header);
+
+    const char* data = (const char*)snapshot->header;
+    size_t left = sizeof(ListSnapshotHeader) + snapshot->header->records * sizeof(ListSnapshotRecord);
+
+    while (left > 0) {
+        ssize_t ret = write(fd, data, left);
+
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        data += ret;
+        left -= (size_t)ret;
+    }
+
+    return true;
+}
+
+bool list_snapshot_read(FILE* file, ListSnapshot* snapshot) {
+    assert(file);
+    assert(snapshot);
+
+    *snapshot = {};
+
+    ListSnapshotHeader header = {};
+    if (fread(&header, sizeof(header), 1, file) != 1)
+        return false;
+
+    if (header.magic != ListSnapshotHeader::MAGIC || header.version != ListSnapshotHeader::VERSION ||
+        header.record_size != sizeof(ListSnapshotRecord)) {
+        fprintf(stderr, "Invalid snapshot header\n");
+        return false;
+    }
+
+    if (!list_snapshot_reserve_(snapshot, header.records))
+        return false;
+
+    *snapshot->header = header;
+
+    if (fread(snapshot->records, sizeof(ListSnapshotRecord), header.records, file) != header.records) {
+        fprintf(stderr, "Snapshot is truncated\n");
+        list_snapshot_dtor(snapshot);
+        return false;
+    }
+
+    return true;
+}
+
+#define LOG_(...) log_printf(&log_file, __VA_ARGS__)
+#define PTR_(value) ((void*)(uintptr_t)(value))
+
+void list_snapshot_render(const ListSnapshot* snapshot) {
+    assert(snapshot);
+    assert(snapshot->header);
+
+    const ListSnapshotHeader* header = snapshot->header;
+
+    LOG_(HTML_BEGIN);
+
+    LOG_("    list_dump() called from %s:%d %s\n"
+         "    %s[%p] initialised in %s:%d %s \n",
+         header->call_file, header->call_line, header->call_func,
+         header->var_name, PTR_(header->list_addr),
+         header->var_file, header->var_line, header->var_func);
+
+    LOG_("    {\n");
+    LOG_("    engine         = %s\n",  header->engine == List::ENGINE_ARRAY ? "array" : "nodes");
+    LOG_("    verify_level   = %u\n",  header->verify_level);
+    LOG_("    size           = %zd\n", (ssize_t)header->size);
+    LOG_("    head           = %p\n",  PTR_(header->head));
+    LOG_("    tail           = %p\n",  PTR_(header->tail));
+    LOG_("    fragmentation  = %.2f\n", header->fragmentation);
+
+    if (header->engine == List::ENGINE_ARRAY) {
+        LOG_("    capacity       = %zu\n", (size_t)header->capacity);
+        LOG_("    free           = %zu\n", (size_t)header->free);
+    }
+
+    LOG_("        {\n");
+
+    if (header->flags & ListSnapshotHeader::HEAD_INVALID) {
+        if (header->flags & ListSnapshotHeader::UNITIALISED)
+            LOG_(HTML_RED("        can't read (invalid pointer)\n"));
+
+        LOG_("        }\n"
+             "    }\n" HTML_END);
+        return;
+    }
+
+    LOG_("        "" %*s | %*s | %*s | elem\n", -14, "ptr", -14, "prev", -14, "next");
+
+    for (size_t i = 0; i < header->records; i++) {
+        const ListSnapshotRecord* record = &snapshot->records[i];
+
+        LOG_("        "" %14p | %14p | %14p | " ELEM_T_PRINTF "\n",
+                         PTR_(record->ptr), PTR_(record->prev), PTR_(record->next), record->elem);
+    }
+
+    LOG_("        }\n"
+         "    }\n" HTML_END);
+
+    char img_filename[log_file.MAX_FILENAME_LEN] = {};
+
+    list_snapshot_render_dot(snapshot, img_filename);
+
+    LOG_("<img src=\"../../%s\">\n", img_filename);
+}
+#undef LOG_
+
+#define FPRINTF_(...) if (fprintf(file, __VA_ARGS__) < 0) {  \
+                          fclose(file);                     \
+                          free(dot_text);                   \
+                          return false;                     \
+                      }
+bool list_snapshot_render_dot(const ListSnapshot* snapshot, char* img_filename) {
+    #define BACKGROUND_COLOR "\"#1f1f1f\""
+    #define FONT_COLOR       "\"#000000\""
+    #define NODE_PREFIX      "elem_"
+    #define NODE_PARAMS      "shape=\"record\", style=\"filled\", fillcolor=\"#6e7681\""
+    #define ZERO_NODE_PARAMS "shape=\"record\", style=\"filled\", fillcolor=\"#6e7681\", color=yellow"
+
+    assert(snapshot);
+    assert(snapshot->header);
+
+    const ListSnapshotHeader* header = snapshot->header;
+
+    // graph is built in memory: identical graphs are rendered once
+    char*  dot_text = nullptr;
+    size_t dot_len  = 0;
+
+    FILE* file = open_memstream(&dot_text, &dot_len);
+    if (file == nullptr)
+        return false;
+
+    FPRINTF_("digraph List{\n"
+             "    graph [bgcolor=" BACKGROUND_COLOR "];\n"
+             "    node[color=white, fontcolor=" FONT_COLOR ", fontsize=14];\n");
+
+    FPRINTF_(NODE_PREFIX "zero [" ZERO_NODE_PARAMS ", label=\" head = %p | "
+                                                           "tail = %p\"];\n",
+             PTR_(header->head), PTR_(header->tail));
+
+    for (size_t log_i = 0; log_i < header->records; log_i++) {
+        const ListSnapshotRecord* record = &snapshot->records[log_i];
+
+        FPRINTF_(NODE_PREFIX "%zu [" NODE_PARAMS ", label=\" <p>prev = %p | {<i>ptr = %p |",
+                 log_i, PTR_(record->prev), PTR_(record->ptr));
+
+        Elem_t elem = record->elem;
+        if (elem == ListNode::POISON) {
+            FPRINTF_("<e>elem = PZN} | ");
+        } else {
+            FPRINTF_("<e>elem = " ELEM_T_PRINTF "} | ", elem);
+        }
+
+        FPRINTF_("<n>next = %p}\"", PTR_(record->next));
+
+        FPRINTF_("];\n");
+    }
+
+    FPRINTF_(NODE_PREFIX "zero");
+    for (int64_t log_i = 0; log_i < header->size; log_i++) {
+        FPRINTF_("->" NODE_PREFIX "%zd", (ssize_t)log_i);
+    }
+    FPRINTF_(" [weight=10000, color=transparent, arrowtail=none];\n");
+
+    for (size_t log_i = 0; log_i < header->records; log_i++) {
+        const ListSnapshotRecord* record = &snapshot->records[log_i];
+
+        if (record->next != 0)
+            FPRINTF_(NODE_PREFIX "%zu:<n>->" NODE_PREFIX "%zu:<n> [color=green];\n", log_i, log_i + 1);
+
+        if (record->prev != 0)
+            FPRINTF_(NODE_PREFIX "%zd:<p>->" NODE_PREFIX "%zd:<p> [color=blue];\n",
+                     (ssize_t)log_i, (ssize_t)log_i - 1);
+    }
+
+    FPRINTF_("head [shape=rect, label=\"HEAD\", color=yellow, fillcolor=\"#7293ba\",style=filled];\n");
+    FPRINTF_("tail [shape=rect, label=\"TAIL\", color=yellow, fillcolor=\"#7293ba\",style=filled];\n");
+
+    FPRINTF_("head->tail[weight=100, color=transparent];");
+
+    FPRINTF_("{rank=same; head; " NODE_PREFIX "0}\n");
+    FPRINTF_("{rank=same; tail; " NODE_PREFIX "%zd}\n", (ssize_t)header->size - 1);
+
+    FPRINTF_("}\n");
+
+    if (fclose(file) != 0) {
+        perror("Error closing file");
+        free(dot_text);
+        return false;
+    }
+
+    bool ret = graph_render(dot_text, dot_len, log_file.timestamp_dir, img_filename);
+
+    free(dot_text);
+
+    if (!ret)
+        fprintf(stderr, "Error creating dot graph\n");
+
+    return ret;
+
+    #undef BACKGROUND_COLOR
+    #undef FONT_COLOR
+    #undef NODE_PREFIX
+    #undef NODE_PARAMS
+    #undef ZERO_NODE_PARAMS
+}
+#undef FPRINTF_
+#undef PTR_
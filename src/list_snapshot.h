@@ -0,0 +1,132 @@
+#ifndef LIST_SNAPSHOT_H_
+#define LIST_SNAPSHOT_H_
+
+#include "list.h"
+
+// snapshots file in log timestamp dir
+#define LIST_SNAPSHOTS_FILENAME "dumps.lsnap"
+
+/**
+ * @brief Binary snapshot header. Snapshot is header followed by header.records records
+ * in logical order. Snapshots are appended to one file one after another
+ */
+struct ListSnapshotHeader {
+    static const uint32_t MAGIC   = 0x504E534C;     //< "LSNP"
+    static const uint32_t VERSION = 2;
+
+    static const size_t MAX_NAME_LEN = 64;
+    static const size_t MAX_PATH_LEN = 128;
+
+    // flags
+    enum Flags {
+        UNITIALISED  = 0x01,    //< list was not initialised
+        HEAD_INVALID = 0x02,    //< head can't be read, there are no records
+    };
+
+    uint32_t magic       = MAGIC;
+    uint32_t version     = VERSION;
+    uint32_t record_size = 0;
+    uint32_t flags       = 0;
+
+    uint64_t list_addr = 0;
+
+    int64_t  size = 0;
+    uint64_t head = 0;
+    uint64_t tail = 0;
+
+    uint32_t engine       = 0;
+    uint32_t verify_level = 0;
+
+    uint64_t capacity = 0;      //< ENGINE_ARRAY only
+    uint64_t free     = 0;      //< ENGINE_ARRAY only
+
+    double fragmentation = 0;   //< mean distance between neighbour records in nodes (see list_fragmentation())
+
+    uint64_t records = 0;       //< number of records after header
+
+    char    var_name[MAX_NAME_LEN] = {};
+    char    var_file[MAX_PATH_LEN] = {};
+    char    var_func[MAX_NAME_LEN] = {};
+    int32_t var_line = -1;
+
+    char    call_file[MAX_PATH_LEN] = {};
+    char    call_func[MAX_NAME_LEN] = {};
+    int32_t call_line = -1;
+};
+
+/**
+ * @brief One node of snapshot
+ */
+struct __attribute__((packed)) ListSnapshotRecord {
+    uint64_t ptr  = 0;
+    uint64_t prev = 0;
+    uint64_t next = 0;
+    Elem_t   elem = 0;
+};
+
+/**
+ * @brief Snapshot in memory. Header and records are one contiguous block, so it is written at once
+ */
+struct ListSnapshot {
+    ListSnapshotHeader* header  = nullptr;
+    ListSnapshotRecord* records = nullptr;  //< points right after header
+
+    size_t records_capacity = 0;
+};
+
+/**
+ * @brief Takes snapshot of list
+ *
+ * @param list
+ * @param call_data
+ * @param snapshot must be freed with list_snapshot_dtor()
+ * @return true success
+ * @return false allocation failure
+ */
+bool list_snapshot_take(const List* list, const VarCodeData call_data, ListSnapshot* snapshot);
+
+/**
+ * @brief Frees snapshot memory
+ *
+ * @param snapshot
+ */
+void list_snapshot_dtor(ListSnapshot* snapshot);
+
+/**
+ * @brief Appends snapshot to file with one write() call
+ *
+ * @param fd
+ * @param snapshot
+ * @return true success
+ * @return false write error
+ */
+bool list_snapshot_write(const int fd, const ListSnapshot* snapshot);
+
+/**
+ * @brief Reads next snapshot from file
+ *
+ * @param file
+ * @param snapshot must be freed with list_snapshot_dtor()
+ * @return true success
+ * @return false end of file or invalid snapshot
+ */
+bool list_snapshot_read(FILE* file, ListSnapshot* snapshot);
+
+/**
+ * @brief Prints snapshot to log_file in list_dump() html format (with graph image)
+ *
+ * @param snapshot
+ */
+void list_snapshot_render(const ListSnapshot* snapshot);
+
+/**
+ * @brief Writes snapshot graph and queues its rendering (see graph_render())
+ *
+ * @param snapshot
+ * @param img_filename returns image filename
+ * @return true success
+ * @return false failure
+ */
+bool list_snapshot_render_dot(const ListSnapshot* snapshot, char* img_filename);
+
+#endif //< #ifndef LIST_SNAPSHOT_H_
@@ -0,0 +1,277 @@
+#include "list_internal.h"
+#include "utils/thread_pool.h"
+
+extern LogFileData log_file;
+
+/*
+ * Chains are sorted by next links only (they end with nullptr), prev links, tail and indexes
+ * are restored by one walk after all merges. Chains of parallel tasks are disjoint, so tasks
+ * write links of different nodes
+ */
+
+/**
+ * @brief Sets next link without touching list fields (called from parallel tasks)
+ */
+static inline void sort_set_next_(List* list, ListNode* node, ListNode* next) {
+    if (list->engine == List::ENGINE_ARRAY)
+        list->arr.next[list_array_index(node)] = (ListArrayLink)list_array_index(next);
+    else
+        node->next = next;
+}
+
+static int sort_default_cmp_(const Elem_t a, const Elem_t b) {
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Merges sorted chains. Nodes of first go before equal nodes of second (merge is stable)
+ *
+ * @return ListNode* head of merged chain
+ */
+static ListNode* sort_merge_(List* list, ListCmp cmp, ListNode* first, ListNode* second) {
+    if (first == nullptr)
+        return second;
+    if (second == nullptr)
+        return first;
+
+    ListNode* head = nullptr;
+    ListNode* last = nullptr;
+
+    while (first != nullptr && second != nullptr) {
+        ListNode** taken = (cmp(list_node_elem(list, second), list_node_elem(list, first)) < 0) ? &second
+                                                                                                 : &first;
+        ListNode* node = *taken;
+        *taken = list_node_next(list, node);
+
+        if (last == nullptr)
+            head = node;
+        else
+            sort_set_next_(list, last, node);
+
+        last = node;
+    }
+
+    sort_set_next_(list, last, (first != nullptr) ? first : second);
+
+    return head;
+}
+
+/**
+ * @brief Bottom-up merge sort of chain: runs[i] holds sorted run of 2^i nodes,
+ * every node is added as run of one node and equal runs are merged like binary counter
+ *
+ * @return ListNode* head of sorted chain
+ */
+static ListNode* sort_chain_(List* list, ListCmp cmp, ListNode* head) {
+    static const size_t MAX_LEVELS = 64;
+
+    ListNode* runs[MAX_LEVELS] = {};
+
+    while (head != nullptr) {
+        ListNode* carry = head;
+        head = list_node_next(list, head);
+        sort_set_next_(list, carry, nullptr);
+
+        size_t level = 0;
+        for (; level < MAX_LEVELS - 1 && runs[level] != nullptr; level++) {
+            carry = sort_merge_(list, cmp, runs[level], carry);    //< runs[level] is earlier part of list
+            runs[level] = nullptr;
+        }
+
+        runs[level] = sort_merge_(list, cmp, runs[level], carry);
+    }
+
+    ListNode* sorted = nullptr;
+    for (size_t level = 0; level < MAX_LEVELS; level++)
+        sorted = sort_merge_(list, cmp, runs[level], sorted);
+
+    return sorted;
+}
+
+/**
+ * @brief Restores prev links and tail after chain from list->head is relinked
+ *
+ * @return ssize_t number of nodes in chain
+ */
+static ssize_t sort_restore_links_(List* list) {
+    ListNode* prev = nullptr;
+    ssize_t cnt = 0;
+
+    for (ListNode* node = list->head; node != nullptr; node = list_node_next(list, node)) {
+        list_node_set_prev(list, node, prev);
+
+        prev = node;
+        cnt++;
+    }
+
+    list->tail = prev;
+
+    return cnt;
+}
+
+/**
+ * @brief Chains sorted or merged by parallel tasks
+ */
+struct SortContext {
+    List* list = nullptr;
+    ListCmp cmp = nullptr;
+
+    ListNode** chains = nullptr;
+    size_t stride = 0;  //< merge round: chains[i] is merged with chains[i + stride]
+};
+
+static void sort_chain_task_(void* arg, size_t i) {
+    SortContext* ctx = (SortContext*)arg;
+
+    ctx->chains[i] = sort_chain_(ctx->list, ctx->cmp, ctx->chains[i]);
+}
+
+static void sort_merge_task_(void* arg, size_t i) {
+    SortContext* ctx = (SortContext*)arg;
+
+    size_t left = i * 2 * ctx->stride;
+
+    ctx->chains[left] = sort_merge_(ctx->list, ctx->cmp, ctx->chains[left], ctx->chains[left + ctx->stride]);
+    ctx->chains[left + ctx->stride] = nullptr;
+}
+
+/**
+ * @brief Splits list into chains of equal length, sorts them in parallel and merges them
+ * pairwise in parallel rounds
+ *
+ * @return ListNode* head of sorted chain
+ */
+static ListNode* sort_parallel_(List* list, ListCmp cmp, const size_t threads) {
+    ListNode* chains[ThreadPoolSettings::MAX_THREADS] = {};
+    size_t chains_cnt = threads;
+
+    size_t chain_len = ((size_t)list->size + chains_cnt - 1) / chains_cnt;
+
+    ListNode* node = list->head;
+    for (size_t i = 0; i < chains_cnt; i++) {
+        chains[i] = node;
+
+        for (size_t j = 1; j < chain_len && node != nullptr; j++)
+            node = list_node_next(list, node);
+
+        if (node == nullptr) {
+            chains_cnt = i + 1;
+            break;
+        }
+
+        ListNode* next = list_node_next(list, node);
+        sort_set_next_(list, node, nullptr);
+        node = next;
+    }
+
+    SortContext ctx = {list, cmp, chains, 0};
+
+    thread_pool_run(sort_chain_task_, &ctx, chains_cnt, threads);
+
+    for (ctx.stride = 1; ctx.stride < chains_cnt; ctx.stride *= 2) {
+        // chains without pair are left for the next round
+        size_t pairs = (chains_cnt - ctx.stride + 2 * ctx.stride - 1) / (2 * ctx.stride);
+
+        thread_pool_run(sort_merge_task_, &ctx, pairs, threads);
+    }
+
+    return chains[0];
+}
+
+int list_sort(List* list, ListCmp cmp, const size_t threads) {
+    int res = LIST_ASSERT(list);
+
+    if (cmp == nullptr)
+        cmp = sort_default_cmp_;
+
+    if (list->size < 2)
+        return res;
+
+    size_t threads_cnt = (threads == 0) ? thread_pool_cpus() : threads;
+    threads_cnt = MIN(threads_cnt, ThreadPoolSettings::MAX_THREADS);
+
+    if (threads_cnt > 1 && list->size >= List::PARALLEL_SORT_MIN_SIZE)
+        list->head = sort_parallel_(list, cmp, threads_cnt);
+    else
+        list->head = sort_chain_(list, cmp, list->head);
+
+    ssize_t cnt = sort_restore_links_(list);
+    assert(cnt == list->size);
+    (void) cnt;
+
+    list_indexes_invalidate(list);
+
+    return res | LIST_ASSERT(list);
+}
+
+#define MERGE_CHECK_(clause_, error_)   if (clause_) {              \
+                                            res |= error_;          \
+                                            LIST_OK(dst, res);      \
+                                            return res;             \
+                                        }
+
+int list_merge_sorted(List* dst, List* src, ListCmp cmp) {
+    int res = LIST_ASSERT(dst);
+    res |= LIST_ASSERT(src);
+
+    MERGE_CHECK_(dst == src, dst->INVALID_PTR_GIVEN);
+
+    if (cmp == nullptr)
+        cmp = sort_default_cmp_;
+
+    if (src->size == 0)
+        return res;
+
+    bool same_storage = dst->engine == List::ENGINE_NODES && src->engine == List::ENGINE_NODES &&
+                        dst->pool == src->pool;
+
+    ListNode* second = src->head;
+    ssize_t k = src->size;
+
+    if (!same_storage) {
+        // src elements are copied to dst storage with one allocation, then merged as nodes of dst
+        MERGE_CHECK_(!list_node_reserve(dst, (size_t)k), dst->ALLOC_ERR);
+
+        ListNode* last = nullptr;
+        second = nullptr;
+
+        for (ListNode* ptr = src->head; ptr != nullptr; ptr = list_node_next(src, ptr)) {
+            ListNode* node = list_node_alloc(dst);
+            assert(node && "memory was reserved");
+
+            list_node_set_elem(dst, node, list_node_elem(src, ptr));
+            list_node_set_next(dst, node, nullptr);
+
+            if (last == nullptr)
+                second = node;
+            else
+                list_node_set_next(dst, last, node);
+
+            last = node;
+        }
+    }
+
+    dst->head = sort_merge_(dst, cmp, dst->head, second);
+    dst->size += k;
+
+    ssize_t cnt = sort_restore_links_(dst);
+    assert(cnt == dst->size);
+    (void) cnt;
+
+    list_indexes_invalidate(dst);
+
+    if (same_storage) {
+        // nodes now belong to dst
+        src->head = nullptr;
+        src->tail = nullptr;
+        src->size = 0;
+
+        list_indexes_invalidate(src);
+    } else {
+        res |= list_clear(src);
+    }
+
+    res |= LIST_ASSERT(src);
+    return res | LIST_ASSERT(dst);
+}
+#undef MERGE_CHECK_
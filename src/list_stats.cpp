@@ -0,0 +1,166 @@
+#include <time.h>
+
+#include "list_internal.h"
+
+extern LogFileData log_file;
+
+/**
+ * @brief Returns the first latency of the next bucket
+ */
+static uint64_t latency_bucket_end_(const size_t bucket) {
+    const size_t bits = ListLatencyHist::SUB_BUCKETS_BITS;
+
+    size_t next = bucket + 1;
+    if (next < ListLatencyHist::SUB_BUCKETS)
+        return next;
+
+    size_t power = (next >> bits) + bits - 1;
+    size_t sub   = next & (ListLatencyHist::SUB_BUCKETS - 1);
+
+    return (uint64_t)(ListLatencyHist::SUB_BUCKETS + sub) << (power - bits);
+}
+
+uint64_t list_latency_percentile(const ListLatencyHist* hist, const double percentile) {
+    assert(hist);
+    assert(0 <= percentile && percentile <= 100);
+
+    if (hist->count == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t)((double)hist->count * percentile / 100);
+    if (rank >= hist->count)
+        rank = hist->count - 1;
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < ListLatencyHist::BUCKETS; bucket++) {
+        seen += hist->buckets[bucket];
+
+        if (seen > rank)
+            return MIN(latency_bucket_end_(bucket) - 1, hist->max_ns);
+    }
+
+    return hist->max_ns;
+}
+
+int list_stats(const List* list, ListStats* stats) {
+    assert(stats);
+    int res = LIST_ASSERT(list);
+
+#ifdef LIST_STATS
+    CHECK_AND_RETURN(list->stats == nullptr, list->INVALID_PTR_GIVEN, *stats = {});
+
+    *stats = *list->stats;
+#else //< #ifndef LIST_STATS
+    *stats = {};
+    res |= list->INVALID_PTR_GIVEN;
+#endif //< #ifdef LIST_STATS
+
+    return res;
+}
+
+void list_stats_reset(List* list) {
+    assert(list);
+
+#ifdef LIST_STATS
+    if (list->stats != nullptr)
+        *list->stats = {};
+#else //< #ifndef LIST_STATS
+    (void) list;
+#endif //< #ifdef LIST_STATS
+}
+
+#ifdef LIST_STATS
+
+/**
+ * @brief Returns histogram bucket of latency. Values below SUB_BUCKETS have own buckets,
+ * other ones are split by highest bit and SUB_BUCKETS_BITS bits after it
+ */
+static size_t latency_bucket_(const uint64_t ns) {
+    const size_t bits = ListLatencyHist::SUB_BUCKETS_BITS;
+
+    if (ns < ListLatencyHist::SUB_BUCKETS)
+        return (size_t)ns;
+
+    size_t power = 63 - (size_t)__builtin_clzll(ns);
+    size_t sub   = (size_t)(ns >> (power - bits)) & (ListLatencyHist::SUB_BUCKETS - 1);
+
+    size_t bucket = ((power - bits + 1) << bits) + sub;
+
+    return MIN(bucket, ListLatencyHist::BUCKETS - 1);
+}
+
+uint64_t list_stats_now() {
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void list_stats_record(const List* list, const ListStats::Op op, const uint64_t begin) {
+    assert(list);
+    assert(op < ListStats::OPS_CNT);
+
+    if (list->stats == nullptr)
+        return;
+
+    uint64_t ns = list_stats_now() - begin;
+
+    ListLatencyHist* hist = &list->stats->latency[op];
+
+    hist->buckets[latency_bucket_(ns)]++;
+    hist->count++;
+    hist->total_ns += ns;
+    hist->max_ns = MAX(hist->max_ns, ns);
+
+    if (op == ListStats::OP_VERIFY) {
+        list->stats->verifies++;
+        list->stats->verify_time += (double)ns * 1e-9;
+    }
+}
+
+static const char* const OP_NAMES[ListStats::OPS_CNT] = {"insert", "delete", "lookup", "verify"};
+
+#define LOG_(...) log_printf(&log_file, __VA_ARGS__)
+
+void list_stats_dump(const List* list) {
+    assert(list);
+
+    if (list->stats == nullptr)
+        return;
+
+    const ListStats* stats = list->stats;
+
+    LOG_(HTML_BEGIN);
+
+    LOG_("    stats\n"
+         "    {\n");
+    LOG_("    inserts         = %zu\n", stats->inserts);
+    LOG_("    deletes         = %zu\n", stats->deletes);
+    LOG_("    lookups         = %zu\n", stats->lookups);
+    LOG_("    nodes_traversed = %zu\n", stats->nodes_traversed);
+    LOG_("    node_allocs     = %zu\n", stats->node_allocs);
+    LOG_("    storage_allocs  = %zu\n", stats->storage_allocs);
+    LOG_("    checks          = %zu\n", stats->checks);
+    LOG_("    verifies        = %zu\n", stats->verifies);
+    LOG_("    verify_time     = %.6f s\n", stats->verify_time);
+
+    LOG_("        "" %*s | %10s | %10s | %10s | %10s | %10s\n", -8, "op",
+         "count", "mean, ns", "p50, ns", "p99, ns", "max, ns");
+
+    for (size_t op = 0; op < ListStats::OPS_CNT; op++) {
+        const ListLatencyHist* hist = &stats->latency[op];
+        if (hist->count == 0)
+            continue;
+
+        LOG_("        "" %*s | %10zu | %10zu | %10zu | %10zu | %10zu\n", -8, OP_NAMES[op],
+             (size_t)hist->count, (size_t)(hist->total_ns / hist->count),
+             (size_t)list_latency_percentile(hist, 50), (size_t)list_latency_percentile(hist, 99),
+             (size_t)hist->max_ns);
+    }
+
+    LOG_("    }\n" HTML_END);
+}
+
+#undef LOG_
+
+#endif //< #ifdef LIST_STATS
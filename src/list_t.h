@@ -0,0 +1,604 @@
+#ifndef LIST_T_H_
+#define LIST_T_H_
+
+#include <new>
+#include <utility>
+#include <math.h>
+#include <string.h>
+
+#include "list.h"
+#include "list_check.h"
+
+// Typed list: nodes embed elements of type T, elements are constructed in place and moved.
+// List (Elem_t = int) with list_* functions is the C-style int flavour of it, but it is not
+// ListT<int>. Error codes, verification levels and checks (list_check.h) are shared, while ListT:
+//  - keeps nodes in its own pool (no ENGINE_ARRAY, no pool sharing, splice, sort or files);
+//  - has no order and value indexes, statistics, relayout, cursors and transactions;
+//  - destroys elements (T destructors) on delete, clear and dtor;
+//  - dumps to log as text only (no graphs and binary snapshots)
+
+/**
+ * @brief Element type traits. Specialise it to get poison checks and readable dumps for T
+ */
+template <typename T>
+struct ListElemTraits {
+    static const bool HAS_POISON = false;   //< T has value that can't be stored in list
+
+    /**
+     * @brief Checks if elem is poison value
+     */
+    static bool is_poison(const T& elem) {
+        (void) elem;
+        return false;
+    }
+
+    /**
+     * @brief Writes poison value to memory of destroyed element
+     */
+    static void poison(T* elem_memory) {
+        (void) elem_memory;
+    }
+
+    /**
+     * @brief Prints element for dumps
+     *
+     * @return int snprintf() result
+     */
+    static int format(char* buf, const size_t buf_size, const T& elem) {
+        (void) elem;
+        return snprintf(buf, buf_size, "[%zu bytes]", sizeof(T));
+    }
+};
+
+template <>
+struct ListElemTraits<int> {
+    static const bool HAS_POISON = true;
+
+    static bool is_poison(const int& elem) {
+        return elem == ListNode::POISON;
+    }
+
+    static void poison(int* elem_memory) {
+        new (elem_memory) int(ListNode::POISON);
+    }
+
+    static int format(char* buf, const size_t buf_size, const int& elem) {
+        return snprintf(buf, buf_size, "%d", elem);
+    }
+};
+
+template <>
+struct ListElemTraits<double> {
+    static const bool HAS_POISON = true;
+
+    static bool is_poison(const double& elem) {
+        return isnan(elem);
+    }
+
+    static void poison(double* elem_memory) {
+        new (elem_memory) double(NAN);
+    }
+
+    static int format(char* buf, const size_t buf_size, const double& elem) {
+        return snprintf(buf, buf_size, "%lg", elem);
+    }
+};
+
+/**
+ * @brief Typed list node. Links go first, so they share cache line with head of elem
+ */
+template <typename T>
+struct ListNodeT {
+    ListNodeT* prev = nullptr;  //< previous node
+    ListNodeT* next = nullptr;  //< next node
+
+    T elem;                     //< element (constructed in place)
+};
+
+/**
+ * @brief Typed list data. Error codes and verification levels are the same as in List
+ */
+template <typename T>
+struct ListT {
+    static const int OK = List::OK;
+
+    ListNodeT<T>* head = nullptr;   //< List head pointer
+    ListNodeT<T>* tail = nullptr;   //< List tail pointer
+
+    ssize_t size = List::UNITIALISED_VAL;   //< number of elements in list
+
+    ObjPool pool = {};              //< ListNodeT<T> allocator
+
+    List::VerifyLevel verify_level = List::LIST_DEFAULT_VERIFY_LEVEL;  //< runtime verification level
+    size_t verify_period = List::DEFAULT_VERIFY_PERIOD;                 //< see VERIFY_SAMPLED
+
+    mutable size_t   verify_cnt  = 0;                   //< number of level checks done
+    mutable uint64_t verify_rand = 0x9E3779B97F4A7C15;  //< sampled check random state
+
+#ifdef DEBUG
+    VarCodeData var_data;   //< keeps data about list variable (name, file, line number)
+#endif // #ifdef DEBUG
+
+};
+
+template <typename T>
+inline bool list_is_initialised(const ListT<T>* list) {
+    return !(list->size == List::UNITIALISED_VAL &&
+             list->head == nullptr && list->tail == nullptr);
+}
+
+template <typename T>
+inline ListNodeT<T>* list_node_next(const ListT<T>* list, const ListNodeT<T>* node) {
+    (void) list;
+    return node->next;
+}
+
+template <typename T>
+inline ListNodeT<T>* list_node_prev(const ListT<T>* list, const ListNodeT<T>* node) {
+    (void) list;
+    return node->prev;
+}
+
+/**
+ * @brief Returns reference to element (elements are not copied)
+ *
+ * @param list
+ * @param node
+ * @return T&
+ */
+template <typename T>
+inline T& list_node_elem(ListT<T>* list, ListNodeT<T>* node) {
+    (void) list;
+    return node->elem;
+}
+
+template <typename T>
+inline const T& list_node_elem(const ListT<T>* list, const ListNodeT<T>* node) {
+    (void) list;
+    return node->elem;
+}
+
+template <typename T>
+inline bool list_node_is_valid(const ListT<T>* list, const ListNodeT<T>* node) {
+    (void) list;
+    return is_ptr_valid(node);
+}
+
+template <typename T>
+inline bool list_elem_is_poison(const ListT<T>* list, const T& elem) {
+    (void) list;
+    return ListElemTraits<T>::is_poison(elem);
+}
+
+template <typename T>
+inline bool list_ends_are_readable(const ListT<T>* list) {
+    (void) list;
+    return true;
+}
+
+template <typename T>
+int list_verify(const ListT<T>* list);
+
+template <typename T>
+int list_check(const ListT<T>* list);
+
+#ifdef DEBUG
+
+extern LogFileData log_file;
+
+template <typename T>
+void list_dump(const ListT<T>* list, const VarCodeData call_data);
+
+template <typename T>
+int list_ctor_debug(ListT<T>* list, const VarCodeData var_data);
+
+#endif //< #ifdef DEBUG
+
+/**
+ * @brief Typed list constructor
+ *
+ * @param list
+ * @return int Error code
+ */
+template <typename T>
+int list_ctor(ListT<T>* list) {
+    static_assert(alignof(ListNodeT<T>) <= alignof(max_align_t), "Overaligned types are not supported");
+    assert(list);
+
+    int res = List::OK;
+
+    if (list_is_initialised(list))
+        return List::ALREADY_INITIALISED;
+
+    obj_pool_ctor(&list->pool, sizeof(ListNodeT<T>));
+
+    list->head = nullptr;
+    list->tail = nullptr;
+    list->size = 0;
+
+    return res | LIST_ASSERT(list);
+}
+
+/**
+ * @brief Destroys all elements
+ *
+ * @param list
+ * @return int Error code
+ */
+template <typename T>
+int list_clear(ListT<T>* list) {
+    int res = LIST_ASSERT(list);
+
+    for (ListNodeT<T>* ptr = list->head; ptr != nullptr; ) {
+        ListNodeT<T>* next = ptr->next;
+        ptr->~ListNodeT<T>();
+        ptr = next;
+    }
+
+    // nodes memory is released by chunks
+    obj_pool_free_chunks(obj_pool_detach(&list->pool));
+
+    list->head = nullptr;
+    list->tail = nullptr;
+    list->size = 0;
+
+    return res | LIST_ASSERT(list);
+}
+
+/**
+ * @brief Typed list destructor
+ *
+ * @param list
+ * @return int Error code
+ */
+template <typename T>
+int list_dtor(ListT<T>* list) {
+    int res = LIST_ASSERT(list);
+
+    res |= list_clear(list);
+
+    obj_pool_dtor(&list->pool);
+
+    list->size = List::UNITIALISED_VAL;
+
+    return res;
+}
+
+/**
+ * @brief Makes sure that next n insertions won't allocate memory
+ *
+ * @param list
+ * @param n
+ * @return int Error code
+ */
+template <typename T>
+int list_reserve(ListT<T>* list, const size_t n) {
+    int res = LIST_ASSERT(list);
+
+    if (!obj_pool_reserve(&list->pool, n))
+        res |= List::ALLOC_ERR;
+
+    return res;
+}
+
+/**
+ * @brief Constructs element in place after ptr
+ *
+ * @param list
+ * @param ptr nullptr - insert to the beginning
+ * @param inserted_ptr may be nullptr
+ * @param args T constructor arguments
+ * @return int Error code
+ */
+template <typename T, typename... Args>
+int list_emplace_after(ListT<T>* list, ListNodeT<T>* ptr, ListNodeT<T>** inserted_ptr, Args&&... args) {
+    int res = LIST_ASSERT(list);
+
+    void* memory = obj_pool_alloc(&list->pool);
+    if (memory == nullptr) {
+        res |= List::ALLOC_ERR;
+        LIST_OK(list, res);
+        return res;
+    }
+
+    ListNodeT<T>* node = nullptr;
+    try {
+        node = new (memory) ListNodeT<T>{nullptr, nullptr, T(std::forward<Args>(args)...)};
+    } catch (...) {
+        obj_pool_free(&list->pool, memory);
+        throw;
+    }
+
+    ListNodeT<T>* next = (ptr == nullptr) ? list->head : ptr->next;
+
+    node->prev = ptr;
+    node->next = next;
+
+    if (ptr == nullptr)
+        list->head = node;
+    else
+        ptr->next = node;
+
+    if (next == nullptr)
+        list->tail = node;
+    else
+        next->prev = node;
+
+    list->size++;
+
+    if (inserted_ptr != nullptr)
+        *inserted_ptr = node;
+
+    return res | LIST_ASSERT(list);
+}
+
+template <typename T, typename... Args>
+inline int list_emplace_back(ListT<T>* list, ListNodeT<T>** inserted_ptr, Args&&... args) {
+    assert(list);
+
+    return list_emplace_after(list, list->tail, inserted_ptr, std::forward<Args>(args)...);
+}
+
+template <typename T, typename... Args>
+inline int list_emplace_front(ListT<T>* list, ListNodeT<T>** inserted_ptr, Args&&... args) {
+    return list_emplace_after(list, (ListNodeT<T>*)nullptr, inserted_ptr, std::forward<Args>(args)...);
+}
+
+/**
+ * @brief Moves element after ptr
+ *
+ * @param list
+ * @param ptr nullptr - insert to the beginning
+ * @param elem
+ * @param inserted_ptr
+ * @return int Error code
+ */
+template <typename T>
+inline int list_insert_after(ListT<T>* list, ListNodeT<T>* ptr, T&& elem,
+                             ListNodeT<T>** inserted_ptr = nullptr) {
+    return list_emplace_after(list, ptr, inserted_ptr, std::move(elem));
+}
+
+/**
+ * @brief Copies element after ptr
+ */
+template <typename T>
+inline int list_insert_after(ListT<T>* list, ListNodeT<T>* ptr, const T& elem,
+                             ListNodeT<T>** inserted_ptr = nullptr) {
+    return list_emplace_after(list, ptr, inserted_ptr, elem);
+}
+
+template <typename T>
+inline int list_pushback(ListT<T>* list, T&& elem, ListNodeT<T>** inserted_ptr = nullptr) {
+    return list_emplace_back(list, inserted_ptr, std::move(elem));
+}
+
+template <typename T>
+inline int list_pushback(ListT<T>* list, const T& elem, ListNodeT<T>** inserted_ptr = nullptr) {
+    return list_emplace_back(list, inserted_ptr, elem);
+}
+
+template <typename T>
+inline int list_pushfront(ListT<T>* list, T&& elem, ListNodeT<T>** inserted_ptr = nullptr) {
+    return list_emplace_front(list, inserted_ptr, std::move(elem));
+}
+
+template <typename T>
+inline int list_pushfront(ListT<T>* list, const T& elem, ListNodeT<T>** inserted_ptr = nullptr) {
+    return list_emplace_front(list, inserted_ptr, elem);
+}
+
+/**
+ * @brief Deletes element. It may be moved out before destruction
+ *
+ * @param list
+ * @param ptr
+ * @param moved_elem if not nullptr, element is move assigned here
+ * @return int Error code
+ */
+template <typename T>
+int list_delete(ListT<T>* list, ListNodeT<T>* ptr, T* moved_elem = nullptr) {
+    int res = LIST_ASSERT(list);
+
+    if (ptr == nullptr || !is_ptr_valid(ptr)) {
+        res |= List::INVALID_PTR_GIVEN;
+        LIST_OK(list, res);
+        return res;
+    }
+
+    if (ptr->prev == nullptr)
+        list->head = ptr->next;
+    else
+        ptr->prev->next = ptr->next;
+
+    if (ptr->next == nullptr)
+        list->tail = ptr->prev;
+    else
+        ptr->next->prev = ptr->prev;
+
+    list->size--;
+
+    if (moved_elem != nullptr)
+        *moved_elem = std::move(ptr->elem);
+
+    ptr->~ListNodeT<T>();
+    ListElemTraits<T>::poison(&ptr->elem);
+
+    obj_pool_free(&list->pool, ptr);
+
+    return res | LIST_ASSERT(list);
+}
+
+/**
+ * @brief Finds first element equal to elem (T must have operator==)
+ *
+ * @param list
+ * @param elem
+ * @param ptr nullptr if not found
+ * @return int Error code
+ */
+template <typename T>
+int list_find_by_value(const ListT<T>* list, const T& elem, ListNodeT<T>** ptr) {
+    assert(ptr);
+    int res = LIST_ASSERT(list);
+
+    *ptr = nullptr;
+
+    if (ListElemTraits<T>::is_poison(elem)) {
+        res |= List::POISON_VAL_FOUND;
+        LIST_OK(list, res);
+        return res;
+    }
+
+    ListNodeT<T>* cur_ptr = list->head;
+    ssize_t log_i = 0;
+    LIST_FOREACH(*list, cur_ptr, log_i) {
+        if (cur_ptr->elem == elem) {
+            *ptr = cur_ptr;
+            return res;
+        }
+    }
+
+    return res;
+}
+
+/**
+ * @brief Verifies list (full check): every node with list_verify_node_links()
+ *
+ * @param list
+ * @return int Error code
+ */
+template <typename T>
+int list_verify(const ListT<T>* list) {
+    assert(list);
+
+    int res = list_verify_light(list);
+    if (res != List::OK)
+        return res;
+
+    ssize_t cnt = 0;
+
+    // damaged list may be a cycle
+    for (const ListNodeT<T>* ptr = list->head; ptr != nullptr && cnt <= list->size; ptr = ptr->next, cnt++) {
+        int node_res = list_verify_node_links(list, ptr);
+        res |= node_res;
+
+        if (node_res & List::INVALID_NODE_PTR)
+            return res;
+    }
+
+    if (cnt != list->size)
+        res |= List::DAMAGED_PATH;
+
+    return res;
+}
+
+/**
+ * @brief Checks List::VERIFY_WINDOW nodes from random end of list (VERIFY_SAMPLED)
+ */
+template <typename T>
+int list_verify_window(const ListT<T>* list) {
+    assert(list);
+
+    if (list->size == 0)
+        return List::OK;
+
+    return list_verify_window_walk(list, list_verify_rand(list));
+}
+
+/**
+ * @brief Verifies list according to list->verify_level
+ *
+ * @param list
+ * @return int Error code
+ */
+template <typename T>
+int list_check(const ListT<T>* list) {
+    return list_check_by_level(list, list_verify_window<T>);
+}
+
+template <typename T>
+void list_set_verify_level(ListT<T>* list, const List::VerifyLevel level,
+                           const size_t period = List::DEFAULT_VERIFY_PERIOD) {
+    assert(list);
+    assert(period > 0);
+
+    list->verify_level  = level;
+    list->verify_period = period;
+    list->verify_cnt    = 0;
+}
+
+#ifdef DEBUG
+
+template <typename T>
+int list_ctor_debug(ListT<T>* list, const VarCodeData var_data) {
+    assert(list);
+
+    list->var_data = var_data;
+
+    return list_ctor(list);
+}
+
+/**
+ * @brief Prints typed list to log. Elements are printed with ListElemTraits<T>::format()
+ *
+ * @param list
+ * @param call_data
+ */
+template <typename T>
+void list_dump(const ListT<T>* list, const VarCodeData call_data) {
+    #define LOG_(...) log_printf(&log_file, __VA_ARGS__)
+
+    assert(list);
+
+    static const size_t ELEM_BUF_SIZE = 128;
+
+    LOG_(HTML_BEGIN);
+
+    LOG_("    list_dump() called from %s:%d %s\n"
+         "    %s[%p] initialised in %s:%d %s \n",
+         call_data.file, call_data.line, call_data.func,
+         list->var_data.name, list,
+         list->var_data.file, list->var_data.line, list->var_data.func);
+
+    LOG_("    {\n");
+    LOG_("    elem_size      = %zu\n", sizeof(T));
+    LOG_("    verify_level   = %d\n",  list->verify_level);
+    LOG_("    size           = %zd\n", list->size);
+    LOG_("    head           = %p\n",  list->head);
+    LOG_("    tail           = %p\n",  list->tail);
+
+    LOG_("        {\n");
+
+    if (list->head != nullptr && !is_ptr_valid(list->head)) {
+        LOG_(HTML_RED("        can't read (invalid pointer)\n"));
+
+        LOG_("        }\n"
+             "    }\n" HTML_END);
+        return;
+    }
+
+    LOG_("        "" %*s | %*s | %*s | elem\n", -14, "ptr", -14, "prev", -14, "next");
+
+    char elem_buf[ELEM_BUF_SIZE] = {};
+
+    ListNodeT<T>* ptr = list->head;
+    ssize_t log_i = 0;
+    LIST_FOREACH(*list, ptr, log_i) {
+        if (ListElemTraits<T>::is_poison(ptr->elem))
+            strncpy(elem_buf, "PZN", ELEM_BUF_SIZE);
+        else
+            ListElemTraits<T>::format(elem_buf, ELEM_BUF_SIZE, ptr->elem);
+
+        LOG_("        "" %14p | %14p | %14p | %s\n", ptr, ptr->prev, ptr->next, elem_buf);
+    }
+
+    LOG_("        }\n"
+         "    }\n" HTML_END);
+
+    #undef LOG_
+}
+
+#endif //< #ifdef DEBUG
+
+#endif //< #ifndef LIST_T_H_
@@ -0,0 +1,278 @@
+#include "list_internal.h"
+
+extern LogFileData log_file;
+
+/*
+ * Staging functions allocate inserted nodes at once, so later operations may refer to them, but
+ * links are changed only by commit. Commit applies log in staging order and writes undo data to
+ * log records. Deleted nodes are freed after check, so rollback relinks the same nodes
+ */
+
+static bool txn_reserve_(ListTxn* txn, const size_t n) {
+    if (n <= txn->ops_capacity)
+        return true;
+
+    size_t capacity = MAX(n, MAX(txn->ops_capacity * 2, ListTxn::DEFAULT_CAPACITY));
+
+    ListTxnOp* ops = (ListTxnOp*)realloc(txn->ops, capacity * sizeof(ListTxnOp));
+    if (ops == nullptr)
+        return false;
+
+    txn->ops = ops;
+    txn->ops_capacity = capacity;
+
+    return true;
+}
+
+static void txn_close_(ListTxn* txn) {
+    FREE(txn->ops);
+
+    txn->list = nullptr;
+
+    txn->ops_cnt      = 0;
+    txn->ops_capacity = 0;
+
+    txn->error = List::OK;
+}
+
+/**
+ * @brief Frees nodes of all operations of given type
+ */
+static void txn_free_nodes_(ListTxn* txn, const ListTxnOp::Type type) {
+    for (size_t i = 0; i < txn->ops_cnt; i++) {
+        if (txn->ops[i].type == type)
+            list_node_free(txn->list, txn->ops[i].node);
+    }
+}
+
+/**
+ * @brief Links prev and next to each other (nullptr - list end)
+ */
+static inline void txn_join_(List* list, ListNode* prev, ListNode* next) {
+    if (prev == nullptr)
+        list->head = next;
+    else
+        list_node_set_next(list, prev, next);
+
+    if (next == nullptr)
+        list->tail = prev;
+    else
+        list_node_set_prev(list, next, prev);
+}
+
+/**
+ * @brief Checks if handle may be accessed. Release build trusts node pointers like other
+ * functions do, array handles are bounds checked
+ */
+static inline bool txn_is_valid_(const List* list, const ListNode* node) {
+#ifdef DEBUG
+    return list_node_is_valid(list, node);
+#else //< #ifndef DEBUG
+    if (list->engine == List::ENGINE_ARRAY)
+        return list_array_is_handle_valid(list, node);
+
+    return node != nullptr;
+#endif //< #ifdef DEBUG
+}
+
+/**
+ * @brief Checks that node is linked: its previous node (or head) points to it.
+ * Deleted and not yet inserted nodes fail this check
+ */
+static bool txn_is_linked_(const List* list, const ListNode* node) {
+    if (!txn_is_valid_(list, node))
+        return false;
+
+    ListNode* prev = list_node_prev(list, node);
+
+    if (prev == nullptr)
+        return list->head == node;
+
+    return txn_is_valid_(list, prev) && list_node_next(list, prev) == node;
+}
+
+/**
+ * @brief Applies operation
+ *
+ * @return false operation refers to node which is not linked (list is not changed)
+ */
+static bool txn_apply_(List* list, ListTxnOp* op) {
+    if (op->type == ListTxnOp::INSERT) {
+        if (op->ptr != nullptr && !txn_is_linked_(list, op->ptr))
+            return false;
+
+        ListNode* next = (op->ptr == nullptr) ? list->head : list_node_next(list, op->ptr);
+
+        txn_join_(list, op->ptr, op->node);
+        txn_join_(list, op->node, next);
+
+        list->size++;
+
+        list_indexes_on_insert(list, op->ptr, op->node);
+
+        return true;
+    }
+
+    if (!txn_is_linked_(list, op->node))
+        return false;
+
+    list_indexes_on_delete(list, op->node);
+
+    op->prev = list_node_prev(list, op->node);
+    op->next = list_node_next(list, op->node);
+
+    txn_join_(list, op->prev, op->next);
+
+    list->size--;
+
+    return true;
+}
+
+/**
+ * @brief Undoes first applied operations in reverse order
+ */
+static void txn_rollback_(List* list, ListTxn* txn, const size_t applied) {
+    for (size_t i = applied; i-- > 0;) {
+        const ListTxnOp* op = &txn->ops[i];
+
+        if (op->type == ListTxnOp::INSERT) {
+            list_indexes_on_delete(list, op->node);
+
+            txn_join_(list, list_node_prev(list, op->node), list_node_next(list, op->node));
+
+            list->size--;
+        } else {
+            txn_join_(list, op->prev, op->node);
+            txn_join_(list, op->node, op->next);
+
+            list->size++;
+
+            list_indexes_on_insert(list, op->prev, op->node);
+        }
+    }
+}
+
+int list_txn_begin(List* list, ListTxn* txn, const size_t expected_ops) {
+    assert(txn);
+    int res = LIST_ASSERT(list);
+
+    CHECK_AND_RETURN(txn->list != nullptr, list->INVALID_PTR_GIVEN);
+
+    txn->list = list;
+
+    CHECK_AND_RETURN(!txn_reserve_(txn, expected_ops) || !list_node_reserve(list, expected_ops), list->ALLOC_ERR,
+                     txn_close_(txn));
+
+    return res;
+}
+
+int list_txn_insert_after(ListTxn* txn, ListNode* ptr, const Elem_t elem, ListNode** inserted_ptr) {
+    assert(txn);
+    assert(inserted_ptr);
+
+    *inserted_ptr = nullptr;
+
+    List* list = txn->list;
+    if (list == nullptr)
+        return List::UNITIALISED;
+
+    int res = list->OK;
+
+    // log record is reserved first, so allocated node is always in log
+    CHECK_AND_RETURN(!txn_reserve_(txn, txn->ops_cnt + 1), list->ALLOC_ERR, txn->error |= res);
+
+    ListNode* node = list_node_alloc(list);
+    CHECK_AND_RETURN(node == nullptr, list->ALLOC_ERR, txn->error |= res);
+
+    list_node_set_elem(list, node, elem);
+    list_node_set_prev(list, node, nullptr);
+    list_node_set_next(list, node, nullptr);
+
+    txn->ops[txn->ops_cnt++] = {ListTxnOp::INSERT, node, ptr, nullptr, nullptr};
+
+    *inserted_ptr = node;
+
+    return res;
+}
+
+int list_txn_delete(ListTxn* txn, ListNode* ptr) {
+    assert(txn);
+
+    List* list = txn->list;
+    if (list == nullptr)
+        return List::UNITIALISED;
+
+    int res = list->OK;
+
+    CHECK_AND_RETURN(ptr == nullptr, list->INVALID_PTR_GIVEN, txn->error |= res);
+    CHECK_AND_RETURN(!txn_reserve_(txn, txn->ops_cnt + 1), list->ALLOC_ERR, txn->error |= res);
+
+    txn->ops[txn->ops_cnt++] = {ListTxnOp::DELETE, ptr, nullptr, nullptr, nullptr};
+
+    return res;
+}
+
+int list_txn_commit(ListTxn* txn, size_t* applied) {
+    assert(txn);
+
+    if (applied != nullptr)
+        *applied = 0;
+
+    List* list = txn->list;
+    if (list == nullptr)
+        return List::UNITIALISED;
+
+    int res = txn->error;
+
+    size_t done = 0;
+    if (res == list->OK) {
+        while (done < txn->ops_cnt && txn_apply_(list, &txn->ops[done]))
+            done++;
+
+        if (done < txn->ops_cnt)
+            res |= list->INVALID_PTR_GIVEN;
+        else
+            res |= LIST_VERIFY(list);
+    }
+
+    if (res != list->OK) {
+        txn_rollback_(list, txn, done);
+        txn_free_nodes_(txn, ListTxnOp::INSERT);
+        txn_close_(txn);
+
+        LIST_OK(list, res);
+        return res;
+    }
+
+#ifdef LIST_STATS
+    size_t inserts = 0;
+    for (size_t i = 0; i < txn->ops_cnt; i++)
+        inserts += txn->ops[i].type == ListTxnOp::INSERT;
+
+    LIST_STATS_ADD(list, inserts, inserts);
+    LIST_STATS_ADD(list, deletes, txn->ops_cnt - inserts);
+#endif //< #ifdef LIST_STATS
+
+    // deleted nodes aren't needed for rollback anymore
+    txn_free_nodes_(txn, ListTxnOp::DELETE);
+
+    if (applied != nullptr)
+        *applied = done;
+
+    txn_close_(txn);
+
+    return res;
+}
+
+int list_txn_abort(ListTxn* txn) {
+    assert(txn);
+
+    if (txn->list == nullptr)
+        return List::UNITIALISED;
+
+    // staged nodes were never linked
+    txn_free_nodes_(txn, ListTxnOp::INSERT);
+    txn_close_(txn);
+
+    return List::OK;
+}
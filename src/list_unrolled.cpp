@@ -0,0 +1,443 @@
+#include <string.h>
+
+#include "list_unrolled.h"
+#include "utils/simd_search.h"
+
+static_assert(sizeof(ListUnrolledBlock) == ListUnrolledBlock::SIZE, "block must fill its cache lines");
+
+static inline bool list_unrolled_is_initialised_(const ListUnrolled* list) {
+    return list->size != List::UNITIALISED_VAL;
+}
+
+/**
+ * @brief Gives block new version, so handles of its elements become invalid
+ */
+static inline void block_touch_(ListUnrolled* list, ListUnrolledBlock* block) {
+    block->version = ++list->last_version;
+}
+
+/**
+ * @brief Allocates empty block and links it after prev (nullptr - at the beginning)
+ */
+static ListUnrolledBlock* block_alloc_after_(ListUnrolled* list, ListUnrolledBlock* prev) {
+    ListUnrolledBlock* block = (ListUnrolledBlock*)obj_pool_alloc(&list->pool);
+    if (block == nullptr)
+        return nullptr;
+
+    *block = {};
+    block_touch_(list, block);
+
+    block->prev = prev;
+    block->next = (prev == nullptr) ? list->head : prev->next;
+
+    if (block->next != nullptr)
+        block->next->prev = block;
+    else
+        list->tail = block;
+
+    if (prev != nullptr)
+        prev->next = block;
+    else
+        list->head = block;
+
+    list->blocks_cnt++;
+
+    return block;
+}
+
+static void block_free_(ListUnrolled* list, ListUnrolledBlock* block) {
+    if (block->prev != nullptr)
+        block->prev->next = block->next;
+    else
+        list->head = block->next;
+
+    if (block->next != nullptr)
+        block->next->prev = block->prev;
+    else
+        list->tail = block->prev;
+
+    // handles check version of freed block, it stays zero until block is reused
+    block->version = 0;
+    block->count = 0;
+
+    obj_pool_free(&list->pool, block);
+
+    list->blocks_cnt--;
+}
+
+/**
+ * @brief Moves upper half of full block to new block after it
+ */
+static ListUnrolledBlock* block_split_(ListUnrolled* list, ListUnrolledBlock* block) {
+    ListUnrolledBlock* upper = block_alloc_after_(list, block);
+    if (upper == nullptr)
+        return nullptr;
+
+    uint32_t half = block->count / 2;
+
+    upper->count = block->count - half;
+    memcpy(upper->elems, block->elems + half, upper->count * sizeof(Elem_t));
+
+    block->count = half;
+    block_touch_(list, block);
+
+    return upper;
+}
+
+/**
+ * @brief Merges underfilled block with neighbour or moves elements from it, so both blocks
+ * have at least MIN_ELEMS elements
+ */
+static void block_rebalance_(ListUnrolled* list, ListUnrolledBlock* block) {
+    ListUnrolledBlock* left  = (block->next != nullptr) ? block       : block->prev;
+    ListUnrolledBlock* right = (block->next != nullptr) ? block->next : block;
+
+    if (left == nullptr)    //< the only block
+        return;
+
+    uint32_t total = left->count + right->count;
+
+    if (total <= ListUnrolledBlock::ELEMS) {
+        memcpy(left->elems + left->count, right->elems, right->count * sizeof(Elem_t));
+        left->count = total;
+
+        block_touch_(list, left);
+        block_free_(list, right);
+        return;
+    }
+
+    uint32_t left_target = total / 2;
+
+    if (left->count < left_target) {
+        uint32_t moved = left_target - left->count;
+
+        memcpy(left->elems + left->count, right->elems, moved * sizeof(Elem_t));
+        memmove(right->elems, right->elems + moved, (right->count - moved) * sizeof(Elem_t));
+    } else {
+        uint32_t moved = left->count - left_target;
+
+        memmove(right->elems + moved, right->elems, right->count * sizeof(Elem_t));
+        memcpy(right->elems, left->elems + left_target, moved * sizeof(Elem_t));
+    }
+
+    left->count  = left_target;
+    right->count = total - left_target;
+
+    block_touch_(list, left);
+    block_touch_(list, right);
+}
+
+int list_ctor(ListUnrolled* list) {
+    assert(list);
+
+    if (list_unrolled_is_initialised_(list))
+        return List::ALREADY_INITIALISED;
+
+    list->head = nullptr;
+    list->tail = nullptr;
+
+    list->blocks_cnt = 0;
+    list->last_version = 0;
+
+    obj_pool_ctor(&list->pool, sizeof(ListUnrolledBlock));
+
+    list->size = 0;
+
+    return List::OK;
+}
+
+int list_dtor(ListUnrolled* list) {
+    assert(list);
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    // blocks are released with pool chunks
+    obj_pool_dtor(&list->pool);
+
+    list->head = nullptr;
+    list->tail = nullptr;
+
+    list->blocks_cnt = 0;
+
+    list->size = List::UNITIALISED_VAL;
+
+    return List::OK;
+}
+
+int list_insert_after(ListUnrolled* list, const ListUnrolledPos pos, const Elem_t elem,
+                      ListUnrolledPos* inserted_pos) {
+    assert(list);
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    if (pos.block != nullptr && !list_pos_is_valid(list, pos))
+        return List::INVALID_PTR_GIVEN;
+
+    ListUnrolledBlock* block = (pos.block == nullptr) ? list->head : pos.block;
+    size_t i = (pos.block == nullptr) ? 0 : pos.i + 1;
+
+    if (block == nullptr) {
+        block = block_alloc_after_(list, nullptr);
+        if (block == nullptr)
+            return List::ALLOC_ERR;
+
+    } else if (block->count == ListUnrolledBlock::ELEMS) {
+        if (i == block->count) {
+            // appending to full block: next block is taken if it has room, otherwise new one is started,
+            // so sequential insertions fill blocks completely
+            if (block->next != nullptr && block->next->count < ListUnrolledBlock::ELEMS)
+                block = block->next;
+            else
+                block = block_alloc_after_(list, block);
+
+            if (block == nullptr)
+                return List::ALLOC_ERR;
+
+            i = 0;
+        } else {
+            ListUnrolledBlock* upper = block_split_(list, block);
+            if (upper == nullptr)
+                return List::ALLOC_ERR;
+
+            if (i > block->count) {
+                i -= block->count;
+                block = upper;
+            }
+        }
+    }
+
+    memmove(block->elems + i + 1, block->elems + i, (block->count - i) * sizeof(Elem_t));
+    block->elems[i] = elem;
+    block->count++;
+
+    block_touch_(list, block);
+
+    list->size++;
+
+    if (inserted_pos != nullptr)
+        *inserted_pos = {block, block->version, i};
+
+    return List::OK;
+}
+
+int list_pushback(ListUnrolled* list, const Elem_t elem, ListUnrolledPos* inserted_pos) {
+    assert(list);
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    ListUnrolledPos last = {};
+    if (list->tail != nullptr)
+        last = {list->tail, list->tail->version, list->tail->count - 1};
+
+    return list_insert_after(list, last, elem, inserted_pos);
+}
+
+int list_append_array(ListUnrolled* list, const Elem_t* elems, const size_t n) {
+    assert(list);
+    assert(elems || n == 0);
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    size_t tail_room = (list->tail == nullptr) ? 0 : ListUnrolledBlock::ELEMS - list->tail->count;
+    size_t new_blocks = (n - MIN(n, tail_room) + ListUnrolledBlock::ELEMS - 1) / ListUnrolledBlock::ELEMS;
+
+    // nothing is appended if blocks can't be allocated
+    if (!obj_pool_reserve(&list->pool, new_blocks))
+        return List::ALLOC_ERR;
+
+    size_t done = 0;
+    while (done < n) {
+        ListUnrolledBlock* block = list->tail;
+
+        if (block == nullptr || block->count == ListUnrolledBlock::ELEMS)
+            block = block_alloc_after_(list, list->tail);
+
+        assert(block);
+
+        size_t cnt = MIN(n - done, ListUnrolledBlock::ELEMS - block->count);
+
+        memcpy(block->elems + block->count, elems + done, cnt * sizeof(Elem_t));
+        block->count += (uint32_t)cnt;
+
+        block_touch_(list, block);
+
+        done += cnt;
+    }
+
+    list->size += (ssize_t)n;
+
+    return List::OK;
+}
+
+int list_delete(ListUnrolled* list, const ListUnrolledPos pos) {
+    assert(list);
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    if (!list_pos_is_valid(list, pos))
+        return List::INVALID_PTR_GIVEN;
+
+    ListUnrolledBlock* block = pos.block;
+
+    memmove(block->elems + pos.i, block->elems + pos.i + 1, (block->count - pos.i - 1) * sizeof(Elem_t));
+    block->count--;
+
+    block_touch_(list, block);
+
+    list->size--;
+
+    if (block->count == 0)
+        block_free_(list, block);
+    else if (block->count < ListUnrolledBlock::MIN_ELEMS)
+        block_rebalance_(list, block);
+
+    return List::OK;
+}
+
+int list_find_by_value(const ListUnrolled* list, const Elem_t elem, ListUnrolledPos* pos) {
+    assert(list);
+    assert(pos);
+
+    *pos = {};
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    for (ListUnrolledBlock* block = list->head; block != nullptr; block = block->next) {
+        if (block->next != nullptr)
+            __builtin_prefetch(block->next);
+
+        size_t i = int_find_first(block->elems, block->count, elem);
+
+        if (i != block->count) {
+            *pos = {block, block->version, i};
+            break;
+        }
+    }
+
+    return List::OK;
+}
+
+int list_count_value(const ListUnrolled* list, const Elem_t elem, size_t* count) {
+    assert(list);
+    assert(count);
+
+    *count = 0;
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    for (ListUnrolledBlock* block = list->head; block != nullptr; block = block->next) {
+        if (block->next != nullptr)
+            __builtin_prefetch(block->next);
+
+        *count += int_count(block->elems, block->count, elem);
+    }
+
+    return List::OK;
+}
+
+int list_find_by_logical_index(const ListUnrolled* list, const ssize_t logical_i, ListUnrolledPos* pos) {
+    assert(list);
+    assert(pos);
+
+    *pos = {};
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    if (logical_i < 0 || logical_i >= list->size)
+        return List::INVALID_PTR_GIVEN;
+
+    ListUnrolledBlock* block = nullptr;
+    size_t i = 0;
+
+    if (logical_i < list->size / 2) {
+        size_t left = (size_t)logical_i;
+
+        for (block = list->head; left >= block->count; block = block->next)
+            left -= block->count;
+
+        i = left;
+    } else {
+        size_t left = (size_t)(list->size - 1 - logical_i);    //< distance from the end
+
+        for (block = list->tail; left >= block->count; block = block->prev)
+            left -= block->count;
+
+        i = block->count - 1 - left;
+    }
+
+    *pos = {block, block->version, i};
+
+    return List::OK;
+}
+
+int list_logical_index_by_ptr(const ListUnrolled* list, const ListUnrolledPos pos, ssize_t* logical_i) {
+    assert(list);
+    assert(logical_i);
+
+    *logical_i = -1;
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    if (!list_pos_is_valid(list, pos))
+        return List::INVALID_PTR_GIVEN;
+
+    size_t index = pos.i;
+
+    for (ListUnrolledBlock* block = pos.block->prev; block != nullptr; block = block->prev)
+        index += block->count;
+
+    *logical_i = (ssize_t)index;
+
+    return List::OK;
+}
+
+size_t list_memory_usage(const ListUnrolled* list) {
+    assert(list);
+
+    return sizeof(ListUnrolled) + list->pool.capacity * list->pool.obj_size;
+}
+
+int list_verify(const ListUnrolled* list) {
+    assert(list);
+
+    if (!list_unrolled_is_initialised_(list))
+        return List::UNITIALISED;
+
+    int res = List::OK;
+
+    if (list->size < 0)
+        return res | List::NEGATIVE_SIZE;
+
+    const ListUnrolledBlock* prev = nullptr;
+    size_t cnt = 0;
+    size_t blocks = 0;
+
+    for (const ListUnrolledBlock* block = list->head; block != nullptr; block = block->next) {
+        if (!is_ptr_valid(block) || block->prev != prev || blocks >= list->blocks_cnt)
+            return res | List::INVALID_NODE_PTR | List::DAMAGED_PATH;
+
+        if (block->count == 0 || block->count > ListUnrolledBlock::ELEMS || block->version == 0)
+            return res | List::DAMAGED_PATH;
+
+        if (int_contains(block->elems, block->count, ListNode::POISON))
+            res |= List::POISON_VAL_FOUND;
+
+        cnt += block->count;
+        blocks++;
+        prev = block;
+    }
+
+    if (cnt != (size_t)list->size || blocks != list->blocks_cnt || list->tail != prev)
+        res |= List::DAMAGED_PATH;
+
+    return res;
+}
@@ -0,0 +1,260 @@
+#ifndef LIST_UNROLLED_H_
+#define LIST_UNROLLED_H_
+
+#include "list.h"
+
+/**
+ * @brief Block of unrolled list: up to ELEMS elements in logical order. Block is sized to two
+ * cache lines, so links cost less than a byte per element when blocks are full
+ */
+struct ListUnrolledBlock {
+    static const size_t SIZE  = 128;    //< block size in bytes
+    static const size_t ELEMS = (SIZE - 2 * sizeof(void*) - sizeof(uint64_t) - sizeof(uint32_t)) / sizeof(Elem_t);
+
+    static const size_t MIN_ELEMS = ELEMS / 4;  //< blocks with less elements are merged with neighbour
+
+    ListUnrolledBlock* prev = nullptr;  //< previous block (first field: it is overwritten by pool free list)
+    ListUnrolledBlock* next = nullptr;  //< next block
+
+    uint64_t version = 0;   //< changed when elements of block are moved, 0 - block is free
+    uint32_t count   = 0;   //< number of elements
+
+    Elem_t elems[ELEMS] = {};
+};
+
+/**
+ * @brief Element handle. Handles of block elements become invalid when block is changed
+ * (insertion, deletion, split or merge), functions return INVALID_PTR_GIVEN for them.
+ * Handles of other blocks stay valid
+ */
+struct ListUnrolledPos {
+    ListUnrolledBlock* block = nullptr;     //< nullptr - no element
+    uint64_t version = 0;                   //< block version handle was taken at
+    size_t i = 0;                           //< element index in block
+};
+
+/**
+ * @brief Unrolled doubly linked list: links connect blocks of elements, so walks and searches
+ * read contiguous arrays and positional lookups skip whole blocks. Full block is split in halves
+ * on insertion, block with less than MIN_ELEMS elements is merged with (or refilled from) neighbour
+ */
+struct ListUnrolled {
+    ListUnrolledBlock* head = nullptr;  //< first block
+    ListUnrolledBlock* tail = nullptr;  //< last block
+
+    ssize_t size = List::UNITIALISED_VAL;   //< number of elements
+    size_t blocks_cnt = 0;                  //< number of blocks
+
+    uint64_t last_version = 0;  //< last version given to block
+
+    ObjPool pool = {};          //< block allocator
+};
+
+/**
+ * @brief Unrolled list constructor
+ *
+ * @param list
+ * @return int
+ */
+int list_ctor(ListUnrolled* list);
+
+/**
+ * @brief Unrolled list destructor. All handles become invalid
+ *
+ * @param list
+ * @return int
+ */
+int list_dtor(ListUnrolled* list);
+
+/**
+ * @brief Checks if handle points to element
+ *
+ * @param list
+ * @param pos
+ * @return true
+ * @return false
+ */
+inline bool list_pos_is_valid(const ListUnrolled* list, const ListUnrolledPos pos) {
+    // freed blocks stay in pool, so their version may be read
+    return list->size > 0 && pos.block != nullptr && pos.version != 0 &&
+           pos.block->version == pos.version && pos.i < pos.block->count;
+}
+
+/**
+ * @brief Returns element value. Handle must be valid
+ *
+ * @param list
+ * @param pos
+ * @return Elem_t
+ */
+inline Elem_t list_node_elem(const ListUnrolled* list, const ListUnrolledPos pos) {
+    (void) list;
+    assert(list_pos_is_valid(list, pos));
+
+    return pos.block->elems[pos.i];
+}
+
+/**
+ * @brief Returns handle of next element (block is nullptr at the end). Handle must be valid
+ *
+ * @param list
+ * @param pos
+ * @return ListUnrolledPos
+ */
+inline ListUnrolledPos list_node_next(const ListUnrolled* list, const ListUnrolledPos pos) {
+    (void) list;
+    assert(list_pos_is_valid(list, pos));
+
+    if (pos.i + 1 < pos.block->count)
+        return {pos.block, pos.version, pos.i + 1};
+
+    ListUnrolledBlock* next = pos.block->next;
+    if (next == nullptr)
+        return {};
+
+    return {next, next->version, 0};
+}
+
+/**
+ * @brief Returns handle of previous element (block is nullptr at the beginning). Handle must be valid
+ *
+ * @param list
+ * @param pos
+ * @return ListUnrolledPos
+ */
+inline ListUnrolledPos list_node_prev(const ListUnrolled* list, const ListUnrolledPos pos) {
+    (void) list;
+    assert(list_pos_is_valid(list, pos));
+
+    if (pos.i > 0)
+        return {pos.block, pos.version, pos.i - 1};
+
+    ListUnrolledBlock* prev = pos.block->prev;
+    if (prev == nullptr)
+        return {};
+
+    return {prev, prev->version, prev->count - 1};
+}
+
+/**
+ * @brief Inserts element after pos
+ *
+ * @param list
+ * @param pos handle, block nullptr - at the beginning
+ * @param elem
+ * @param inserted_pos (optional)
+ * @return int INVALID_PTR_GIVEN if handle is invalid
+ */
+int list_insert_after(ListUnrolled* list, const ListUnrolledPos pos, const Elem_t elem,
+                      ListUnrolledPos* inserted_pos = nullptr);
+
+/**
+ * @brief Inserts element at the end of the list
+ *
+ * @param list
+ * @param elem
+ * @param inserted_pos (optional)
+ * @return int
+ */
+int list_pushback(ListUnrolled* list, const Elem_t elem, ListUnrolledPos* inserted_pos = nullptr);
+
+/**
+ * @brief Inserts element at the beginning of the list
+ *
+ * @param list
+ * @param elem
+ * @param inserted_pos (optional)
+ * @return int
+ */
+inline int list_pushfront(ListUnrolled* list, const Elem_t elem, ListUnrolledPos* inserted_pos = nullptr) {
+    return list_insert_after(list, {}, elem, inserted_pos);
+}
+
+/**
+ * @brief Appends n elements to the end of list (unlike list_from_array(List*), elements are kept).
+ * Blocks are filled completely
+ *
+ * @param list
+ * @param elems
+ * @param n
+ * @return int
+ */
+int list_append_array(ListUnrolled* list, const Elem_t* elems, const size_t n);
+
+/**
+ * @brief Deletes element
+ *
+ * @param list
+ * @param pos
+ * @return int INVALID_PTR_GIVEN if handle is invalid
+ */
+int list_delete(ListUnrolled* list, const ListUnrolledPos pos);
+
+/**
+ * @brief Returns the first element with given value (blocks are searched by SIMD kernels)
+ *
+ * @param list
+ * @param elem
+ * @param pos returnable value. block is nullptr if not found
+ * @return int
+ */
+int list_find_by_value(const ListUnrolled* list, const Elem_t elem, ListUnrolledPos* pos);
+
+/**
+ * @brief Returns number of elements with given value
+ *
+ * @param list
+ * @param elem
+ * @param count returnable value
+ * @return int
+ */
+int list_count_value(const ListUnrolled* list, const Elem_t elem, size_t* count);
+
+/**
+ * @brief Returns element by logical index. Blocks are skipped by their counts
+ * from the nearest end of the list
+ *
+ * @param list
+ * @param logical_i
+ * @param pos returnable value. block is nullptr if index is out of range
+ * @return int INVALID_PTR_GIVEN if index is out of range
+ */
+int list_find_by_logical_index(const ListUnrolled* list, const ssize_t logical_i, ListUnrolledPos* pos);
+
+/**
+ * @brief Returns logical index of element
+ *
+ * @param list
+ * @param pos
+ * @param logical_i returnable value. -1 if handle is invalid
+ * @return int INVALID_PTR_GIVEN if handle is invalid
+ */
+int list_logical_index_by_ptr(const ListUnrolled* list, const ListUnrolledPos pos, ssize_t* logical_i);
+
+/**
+ * @brief Returns number of elements
+ *
+ * @param list
+ * @return ssize_t
+ */
+inline ssize_t list_size(const ListUnrolled* list) {
+    return list->size;
+}
+
+/**
+ * @brief Returns bytes used by list storage (list itself and pool chunks)
+ *
+ * @param list
+ * @return size_t
+ */
+size_t list_memory_usage(const ListUnrolled* list);
+
+/**
+ * @brief Verifies block links, counts, size and poison values. Full O(n) check
+ *
+ * @param list
+ * @return int
+ */
+int list_verify(const ListUnrolled* list);
+
+#endif //< #ifndef LIST_UNROLLED_H_
@@ -0,0 +1,501 @@
+#include "list_internal.h"
+
+extern LogFileData log_file;
+
+struct ValueHead;
+
+/**
+ * @brief Node of value chain. All nodes with the same value are chained
+ */
+struct ValueEntry {
+    ValueEntry* prev = nullptr;
+    ValueEntry* next = nullptr;
+
+    ValueHead* head = nullptr;
+
+    ListNode* node = nullptr;   //< list element handle
+};
+
+/**
+ * @brief Value chain head
+ */
+struct ValueHead {
+    ValueEntry* first = nullptr;
+    ValueEntry* last  = nullptr;
+
+    size_t count = 0;
+
+    bool is_ordered = true;     //< chain order is logical order. Unordered chain is ordered by rebuild
+};
+
+/**
+ * @brief Hash multimap from element value to list elements
+ */
+struct ListValueIndex {
+    HashMap values  = {};       //< Elem_t -> ValueHead*
+    HashMap entries = {};       //< ListNode* handle -> ValueEntry*
+
+    ObjPool heads_pool   = {};  //< ValueHead allocator
+    ObjPool entries_pool = {};  //< ValueEntry allocator
+
+    bool is_dirty = false;      //< index doesn't match list and must be rebuilt before use
+
+    ListIndexStats stats = {};
+};
+
+static inline uint64_t value_key_(const Elem_t elem) {
+    return (uint64_t)(uint32_t)elem;
+}
+
+static inline uint64_t node_key_(const ListNode* node) {
+    return (uint64_t)(uintptr_t)node;
+}
+
+static ValueHead* value_find_head_(const ListValueIndex* index, const Elem_t elem) {
+    assert(index);
+
+    uint64_t* value = hash_map_find(&index->values, value_key_(elem));
+
+    return value ? (ValueHead*)(uintptr_t)*value : nullptr;
+}
+
+static void value_reset_(ListValueIndex* index) {
+    assert(index);
+
+    hash_map_dtor(&index->values);
+    hash_map_dtor(&index->entries);
+
+    obj_pool_free_chunks(obj_pool_detach(&index->heads_pool));
+    obj_pool_free_chunks(obj_pool_detach(&index->entries_pool));
+}
+
+static bool value_init_(ListValueIndex* index, const size_t size_hint) {
+    assert(index);
+
+    return hash_map_ctor(&index->values,  size_hint) &&
+           hash_map_ctor(&index->entries, size_hint);
+}
+
+/**
+ * @brief Adds element to index
+ *
+ * @param index
+ * @param node
+ * @param elem
+ * @param to_end true if node is the last one in logical order among nodes with the same value,
+ *               false if it is the first one or order is unknown
+ * @param is_first true if node is the first one among nodes with the same value
+ */
+static bool value_add_(ListValueIndex* index, ListNode* node, const Elem_t elem,
+                       const bool to_end, const bool is_first) {
+    assert(index);
+
+    ValueHead* head = value_find_head_(index, elem);
+
+    if (head == nullptr) {
+        head = (ValueHead*)obj_pool_alloc(&index->heads_pool);
+        if (head == nullptr)
+            return false;
+
+        *head = {};
+
+        if (!hash_map_set(&index->values, value_key_(elem), (uint64_t)(uintptr_t)head)) {
+            obj_pool_free(&index->heads_pool, head);
+            return false;
+        }
+    }
+
+    ValueEntry* entry = (ValueEntry*)obj_pool_alloc(&index->entries_pool);
+    if (entry == nullptr)
+        return false;
+
+    *entry = {};
+    entry->node = node;
+    entry->head = head;
+
+    if (!hash_map_set(&index->entries, node_key_(node), (uint64_t)(uintptr_t)entry)) {
+        obj_pool_free(&index->entries_pool, entry);
+        return false;
+    }
+
+    if (head->count > 0 && !to_end && is_first) {
+        entry->next = head->first;
+        head->first->prev = entry;
+        head->first = entry;
+    } else {
+        if (head->count > 0 && !to_end)
+            head->is_ordered = false;
+
+        entry->prev = head->last;
+        if (head->last != nullptr)
+            head->last->next = entry;
+        else
+            head->first = entry;
+
+        head->last = entry;
+    }
+
+    head->count++;
+
+    return true;
+}
+
+static bool value_remove_(ListValueIndex* index, const ListNode* node, const Elem_t elem) {
+    assert(index);
+
+    uint64_t* value = hash_map_find(&index->entries, node_key_(node));
+    if (value == nullptr)
+        return false;
+
+    ValueEntry* entry = (ValueEntry*)(uintptr_t)*value;
+    ValueHead* head = entry->head;
+
+    hash_map_erase(&index->entries, node_key_(node));
+
+    if (entry->prev != nullptr)
+        entry->prev->next = entry->next;
+    else
+        head->first = entry->next;
+
+    if (entry->next != nullptr)
+        entry->next->prev = entry->prev;
+    else
+        head->last = entry->prev;
+
+    obj_pool_free(&index->entries_pool, entry);
+
+    if (--head->count == 0) {
+        hash_map_erase(&index->values, value_key_(elem));
+        obj_pool_free(&index->heads_pool, head);
+    }
+
+    return true;
+}
+
+static bool list_value_index_rebuild_(List* list) {
+    assert(list);
+    assert(list->value_index);
+
+    ListValueIndex* index = list->value_index;
+
+    timespec begin = {};
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    value_reset_(index);
+
+    index->is_dirty = true;
+
+    if (!value_init_(index, (size_t)list->size) ||
+        !obj_pool_reserve(&index->entries_pool, (size_t)list->size))
+        return false;
+
+    for (ListNode* ptr : list_range(list)) {
+        if (!value_add_(index, ptr, list_node_elem(list, ptr), true, false))
+            return false;
+    }
+
+    index->is_dirty = false;
+
+    timespec end = {};
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    index->stats.rebuilds++;
+    index->stats.rebuild_time += (double)(end.tv_sec  - begin.tv_sec) +
+                                 (double)(end.tv_nsec - begin.tv_nsec) * 1e-9;
+
+    return true;
+}
+
+/**
+ * @brief Returns value chain head. Lookups never change index
+ *
+ * @return true success
+ * @return false index is outdated
+ */
+static bool value_lookup_(const List* list, const Elem_t elem, ValueHead** head) {
+    assert(list);
+    assert(list->value_index);
+    assert(head);
+
+    const ListValueIndex* index = list->value_index;
+
+    if (index->is_dirty)
+        return false;
+
+    *head = value_find_head_(index, elem);
+
+    return true;
+}
+
+/**
+ * @brief Entry with its logical index
+ */
+struct RankedEntry {
+    ssize_t rank = 0;
+    const ValueEntry* entry = nullptr;
+};
+
+static int ranked_entry_cmp_(const void* a, const void* b) {
+    ssize_t rank_a = ((const RankedEntry*)a)->rank;
+    ssize_t rank_b = ((const RankedEntry*)b)->rank;
+
+    return (rank_a > rank_b) - (rank_a < rank_b);
+}
+
+/**
+ * @brief Returns entries of unordered chain sorted by logical indexes from order index. O(k log n)
+ *
+ * @return RankedEntry* array of head->count entries (free() it), nullptr on allocation failure
+ */
+static RankedEntry* value_rank_chain_(const List* list, const ValueHead* head) {
+    assert(list);
+    assert(list->order_index);
+    assert(head);
+
+    RankedEntry* ranked = (RankedEntry*)calloc(head->count, sizeof(RankedEntry));
+    if (ranked == nullptr)
+        return nullptr;
+
+    size_t i = 0;
+    for (const ValueEntry* entry = head->first; entry != nullptr; entry = entry->next, i++) {
+        ranked[i].entry = entry;
+
+        bool is_found = list_order_index_rank(list, entry->node, &ranked[i].rank);
+        assert(is_found && "order index is ready");
+        (void) is_found;
+    }
+
+    qsort(ranked, head->count, sizeof(RankedEntry), ranked_entry_cmp_);
+
+    return ranked;
+}
+
+/**
+ * @brief Copies handles of the first max_cnt elements of chain in logical order.
+ * Unordered chain is ranked with order index (O(k log n)) if it is ready, otherwise list is walked (O(n))
+ *
+ * @return false allocation failure
+ */
+static bool value_chain_nodes_(const List* list, const ValueHead* head, const Elem_t elem,
+                               ListNode** ptrs, const size_t max_cnt) {
+    assert(list);
+    assert(head);
+    assert(ptrs || max_cnt == 0);
+
+    size_t cnt = MIN(max_cnt, head->count);
+    if (cnt == 0)
+        return true;
+
+    if (head->is_ordered) {
+        const ValueEntry* entry = head->first;
+        for (size_t i = 0; i < cnt; i++, entry = entry->next)
+            ptrs[i] = entry->node;
+
+        return true;
+    }
+
+    if (list->order_index != nullptr && list_order_index_is_ready(list)) {
+        RankedEntry* ranked = value_rank_chain_(list, head);
+        if (ranked == nullptr)
+            return false;
+
+        for (size_t i = 0; i < cnt; i++)
+            ptrs[i] = ranked[i].entry->node;
+
+        free(ranked);
+
+        return true;
+    }
+
+    size_t i = 0;
+    for (ListNode* ptr : list_range(list)) {
+        if (i == cnt)
+            break;
+
+        if (list_node_elem(list, ptr) == elem)
+            ptrs[i++] = ptr;
+    }
+
+    assert(i == cnt);
+
+    return true;
+}
+
+int list_value_index_enable(List* list) {
+    int res = LIST_ASSERT(list);
+
+    if (list->value_index != nullptr)
+        return res;
+
+    ListValueIndex* index = (ListValueIndex*)calloc(1, sizeof(ListValueIndex));
+    CHECK_AND_RETURN(index == nullptr, list->ALLOC_ERR);
+
+    *index = {};
+    obj_pool_ctor(&index->heads_pool,   sizeof(ValueHead));
+    obj_pool_ctor(&index->entries_pool, sizeof(ValueEntry));
+
+    list->value_index = index;
+
+    CHECK_AND_RETURN(!list_value_index_rebuild_(list), list->ALLOC_ERR, {
+                     list_value_index_disable(list);});
+
+    return res;
+}
+
+void list_value_index_disable(List* list) {
+    assert(list);
+
+    if (list->value_index == nullptr)
+        return;
+
+    value_reset_(list->value_index);
+
+    FREE(list->value_index);
+}
+
+int list_value_index_stats(const List* list, ListIndexStats* stats) {
+    assert(stats);
+    int res = LIST_ASSERT(list);
+
+    CHECK_AND_RETURN(list->value_index == nullptr, list->INVALID_PTR_GIVEN);
+
+    ListValueIndex* index = list->value_index;
+
+    *stats = index->stats;
+    stats->update_steps = index->values.probes + index->entries.probes;
+    stats->memory = sizeof(ListValueIndex) +
+                    hash_map_memory(&index->values) + hash_map_memory(&index->entries) +
+                    index->heads_pool.capacity   * index->heads_pool.obj_size +
+                    index->entries_pool.capacity * index->entries_pool.obj_size;
+
+    return res;
+}
+
+void list_value_index_insert(List* list, const ListNode* prev, ListNode* node) {
+    assert(list);
+    assert(list->value_index);
+
+    ListValueIndex* index = list->value_index;
+
+    if (index->is_dirty)
+        return;
+
+    index->stats.updates++;
+
+    // pushback and pushfront keep value chains in logical order
+    bool to_end   = list_node_next(list, node) == nullptr;
+    bool is_first = prev == nullptr;
+
+    if (!value_add_(index, node, list_node_elem(list, node), to_end, is_first))
+        index->is_dirty = true;
+}
+
+void list_value_index_delete(List* list, const ListNode* node) {
+    assert(list);
+    assert(list->value_index);
+
+    ListValueIndex* index = list->value_index;
+
+    if (index->is_dirty)
+        return;
+
+    index->stats.updates++;
+
+    if (!value_remove_(index, node, list_node_elem(list, node)))
+        index->is_dirty = true;
+}
+
+void list_value_index_clear(List* list) {
+    assert(list);
+    assert(list->value_index);
+
+    ListValueIndex* index = list->value_index;
+
+    value_reset_(index);
+    index->is_dirty = !value_init_(index, 0);
+}
+
+void list_value_index_invalidate(List* list) {
+    assert(list);
+    assert(list->value_index);
+
+    // index is rebuilt here, so const lookups never rebuild it
+    list_value_index_rebuild_(list);
+}
+
+bool list_value_index_find(const List* list, const Elem_t elem, ListNode** ptr) {
+    assert(list);
+    assert(ptr);
+
+    ValueHead* head = nullptr;
+    if (!value_lookup_(list, elem, &head))
+        return false;
+
+    *ptr = nullptr;
+
+    if (head == nullptr)
+        return true;
+
+    return value_chain_nodes_(list, head, elem, ptr, 1);
+}
+
+bool list_value_index_count(const List* list, const Elem_t elem, size_t* count) {
+    assert(list);
+    assert(count);
+
+    ValueHead* head = nullptr;
+    if (!value_lookup_(list, elem, &head))
+        return false;
+
+    *count = head ? head->count : 0;
+
+    return true;
+}
+
+bool list_value_index_find_all(const List* list, const Elem_t elem,
+                               ListNode** ptrs, const size_t max_cnt, size_t* found) {
+    assert(list);
+    assert(ptrs || max_cnt == 0);
+    assert(found);
+
+    ValueHead* head = nullptr;
+    if (!value_lookup_(list, elem, &head))
+        return false;
+
+    *found = 0;
+
+    if (head == nullptr)
+        return true;
+
+    if (!value_chain_nodes_(list, head, elem, ptrs, max_cnt))
+        return false;
+
+    *found = head->count;
+
+    return true;
+}
+
+int list_value_index_verify(const List* list) {
+    assert(list);
+    assert(list->value_index);
+
+    ListValueIndex* index = list->value_index;
+
+    if (index->is_dirty)
+        return list->OK;
+
+    if (index->entries.size != (size_t)list->size)
+        return list->INDEX_MISMATCH;
+
+    for (ListNode* ptr : list_range(list)) {
+        uint64_t* value = hash_map_find(&index->entries, node_key_(ptr));
+        if (value == nullptr)
+            return list->INDEX_MISMATCH;
+
+        ValueEntry* entry = (ValueEntry*)(uintptr_t)*value;
+        if (entry->head != value_find_head_(index, list_node_elem(list, ptr)))
+            return list->INDEX_MISMATCH;
+    }
+
+    return list->OK;
+}
@@ -0,0 +1,343 @@
+#include "list_internal.h"
+#include "utils/thread_pool.h"
+
+extern LogFileData log_file;
+
+/**
+ * @brief Part of list from one splitter to the next one, checked by one task
+ */
+struct VerifySegment {
+    ListNode* first      = nullptr;     //< splitter
+    ListNode* first_prev = nullptr;     //< prev link of the first node (checked by stitching)
+    ListNode* last       = nullptr;
+    ListNode* end        = nullptr;     //< splitter after the last node, nullptr - end of list
+
+    ssize_t size = 0;
+    bool is_clean = false;      //< all nodes are in storage, have right prev links and no poison
+};
+
+/**
+ * @brief Address range of pool chunk objects
+ */
+struct VerifyRange {
+    uintptr_t begin = 0;
+    uintptr_t end   = 0;
+};
+
+/**
+ * @brief Parallel verification state. Splitters are kept in open addressing set: handle -> segment
+ */
+struct VerifyContext {
+    static const size_t MAX_SEGMENTS      = List::VERIFY_SPLITTERS + 1;     //< splitters and head
+    static const size_t SPLITTERS_BITS    = 9;
+    static const size_t SPLITTERS_CAPACITY = 1 << SPLITTERS_BITS;          //< more than 4 * MAX_SEGMENTS
+    static const size_t CHUNK_SCAN        = 64;   //< slots or pool objects scanned for used one in chunk
+
+    const List* list = nullptr;
+    bool check_poison = false;
+
+    ListNode* splitters[SPLITTERS_CAPACITY] = {};
+    size_t    splitter_segments[SPLITTERS_CAPACITY] = {};
+
+    VerifySegment segments[MAX_SEGMENTS] = {};
+    size_t segments_cnt = 0;
+
+    VerifyRange* ranges = nullptr;  //< ENGINE_NODES: pool chunks sorted by address
+    size_t ranges_cnt = 0;
+};
+
+static inline size_t verify_hash_(const ListNode* node) {
+    return (size_t)(((uint64_t)(uintptr_t)node * 0x9E3779B97F4A7C15ull) >>
+                    (64 - VerifyContext::SPLITTERS_BITS));
+}
+
+static size_t verify_splitter_find_(const VerifyContext* ctx, const ListNode* node) {
+    assert(ctx);
+
+    for (size_t i = verify_hash_(node); ctx->splitters[i] != nullptr;
+         i = (i + 1) & (VerifyContext::SPLITTERS_CAPACITY - 1))
+        if (ctx->splitters[i] == node)
+            return ctx->splitter_segments[i];
+
+    return (size_t)-1;
+}
+
+/**
+ * @brief Adds segment starting at node (if node is not a splitter already)
+ */
+static void verify_splitter_add_(VerifyContext* ctx, ListNode* node) {
+    assert(ctx);
+    assert(node);
+
+    if (ctx->segments_cnt == VerifyContext::MAX_SEGMENTS)
+        return;
+
+    size_t i = verify_hash_(node);
+    for (; ctx->splitters[i] != nullptr; i = (i + 1) & (VerifyContext::SPLITTERS_CAPACITY - 1))
+        if (ctx->splitters[i] == node)
+            return;
+
+    ctx->splitters[i] = node;
+    ctx->splitter_segments[i] = ctx->segments_cnt;
+
+    VerifySegment* seg = &ctx->segments[ctx->segments_cnt++];
+
+    seg->first = node;
+}
+
+static int verify_range_cmp_(const void* a, const void* b) {
+    uintptr_t a_begin = ((const VerifyRange*)a)->begin;
+    uintptr_t b_begin = ((const VerifyRange*)b)->begin;
+
+    return (a_begin > b_begin) - (a_begin < b_begin);
+}
+
+static bool verify_ranges_build_(VerifyContext* ctx) {
+    assert(ctx);
+
+    const ObjPool* pool = ctx->list->pool;
+
+    size_t cnt = 0;
+    for (ObjPoolChunk* chunk = pool->chunks; chunk != nullptr; chunk = chunk->next)
+        cnt++;
+
+    ctx->ranges = (VerifyRange*)calloc(MAX(cnt, 1), sizeof(VerifyRange));
+    if (ctx->ranges == nullptr)
+        return false;
+
+    for (ObjPoolChunk* chunk = pool->chunks; chunk != nullptr; chunk = chunk->next) {
+        uintptr_t begin = (uintptr_t)(chunk + 1);
+        uintptr_t end   = begin + chunk->capacity * pool->obj_size;
+
+        // objects of the last chunk after bump pointer were never allocated
+        if (chunk == pool->chunks && pool->bump_ptr != nullptr)
+            end = (uintptr_t)pool->bump_ptr;
+
+        ctx->ranges[ctx->ranges_cnt++] = {begin, end};
+    }
+
+    qsort(ctx->ranges, ctx->ranges_cnt, sizeof(VerifyRange), verify_range_cmp_);
+
+    return true;
+}
+
+/**
+ * @brief Checks that node may be read. ENGINE_NODES check is stricter than is_ptr_valid():
+ * node must be an object of list pool. Nodes outside pool are left to serial walk
+ */
+static bool verify_node_is_valid_(const VerifyContext* ctx, const ListNode* node) {
+    assert(ctx);
+
+    if (ctx->list->engine == List::ENGINE_ARRAY)
+        return list_array_is_handle_valid(ctx->list, node);
+
+    uintptr_t ptr = (uintptr_t)node;
+
+    size_t left = 0;
+    size_t right = ctx->ranges_cnt;
+
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+
+        if (ctx->ranges[mid].end <= ptr)
+            left = mid + 1;
+        else
+            right = mid;
+    }
+
+    if (left == ctx->ranges_cnt || ptr < ctx->ranges[left].begin)
+        return false;
+
+    return (ptr - ctx->ranges[left].begin) % ctx->list->pool->obj_size == 0;
+}
+
+/**
+ * @brief Walks segment until the next splitter. Thread pool task
+ */
+static void verify_segment_(void* arg, size_t i) {
+    VerifyContext* ctx = (VerifyContext*)arg;
+    VerifySegment* seg = &ctx->segments[i];
+    const List* list = ctx->list;
+
+    ListNode* ptr = seg->first;
+    if (!verify_node_is_valid_(ctx, ptr))
+        return;
+
+    seg->first_prev = list_node_prev(list, ptr);
+
+    ListNode* prev = seg->first_prev;
+
+    while (true) {
+        if (!verify_node_is_valid_(ctx, ptr) || list_node_prev(list, ptr) != prev ||
+            (ctx->check_poison && list_node_elem(list, ptr) == ListNode::POISON))
+            return;
+
+        prev = ptr;
+
+        // segments of damaged list may be cycles
+        if (++seg->size > list->size)
+            return;
+
+        ListNode* next = list_node_next(list, ptr);
+        if (next == nullptr || verify_splitter_find_(ctx, next) != (size_t)-1) {
+            seg->end = next;
+            break;
+        }
+
+        ptr = next;
+    }
+
+    seg->last = prev;
+    seg->is_clean = true;
+}
+
+/**
+ * @brief Follows segments from head to tail and checks links between them and total size
+ *
+ * @param ctx
+ * @return true list is correct
+ * @return false list must be walked serially
+ */
+static bool verify_stitch_(const VerifyContext* ctx) {
+    assert(ctx);
+
+    const List* list = ctx->list;
+
+    ListNode* expected_prev = nullptr;
+    ssize_t total = 0;
+
+    size_t i = verify_splitter_find_(ctx, list->head);
+    size_t stitched = 0;
+
+    while (true) {
+        if (i == (size_t)-1 || stitched == ctx->segments_cnt)
+            return false;
+
+        const VerifySegment* seg = &ctx->segments[i];
+        if (!seg->is_clean || seg->first_prev != expected_prev)
+            return false;
+
+        stitched++;
+
+        total += seg->size;
+        if (total > list->size)
+            return false;
+
+        expected_prev = seg->last;
+
+        if (seg->end == nullptr)
+            break;
+
+        i = verify_splitter_find_(ctx, seg->end);
+    }
+
+    return total == list->size && expected_prev == list->tail;
+}
+
+/**
+ * @brief Checks that pool object is a node linked with its neighbours. Free objects (poisoned,
+ * prev is free list link) are not taken as splitters
+ */
+static bool verify_node_is_linked_(const VerifyContext* ctx, ListNode* node) {
+    assert(ctx);
+
+    const List* list = ctx->list;
+
+    if (list_node_elem(list, node) == ListNode::POISON)
+        return false;
+
+    ListNode* prev = list_node_prev(list, node);
+    ListNode* next = list_node_next(list, node);
+
+    return (prev == nullptr || (verify_node_is_valid_(ctx, prev) && list_node_next(list, prev) == node)) &&
+           (next == nullptr || (verify_node_is_valid_(ctx, next) && list_node_prev(list, next) == node));
+}
+
+/**
+ * @brief ENGINE_NODES splitters: the first linked node near every capacity / VERIFY_SPLITTERS objects
+ * of pool chunks. Splitters are picked on every call, so list keeps no state for parallel verification.
+ * Nodes of lists sharing pool may be taken too: their segments are never reached from head
+ */
+static void verify_splitters_nodes_(VerifyContext* ctx) {
+    assert(ctx);
+
+    const ObjPool* pool = ctx->list->pool;
+
+    size_t capacity = 0;
+    for (size_t range = 0; range < ctx->ranges_cnt; range++)
+        capacity += (ctx->ranges[range].end - ctx->ranges[range].begin) / pool->obj_size;
+
+    size_t step = MAX(1, capacity / List::VERIFY_SPLITTERS);
+    size_t skip = 0;    //< objects before the next position in the next range
+
+    for (size_t range = 0; range < ctx->ranges_cnt; range++) {
+        uintptr_t begin = ctx->ranges[range].begin;
+        size_t cnt = (ctx->ranges[range].end - begin) / pool->obj_size;
+
+        size_t pos = skip;
+        for (; pos < cnt; pos += step) {
+            size_t end = MIN(MIN(pos + step, pos + VerifyContext::CHUNK_SCAN), cnt);
+
+            for (size_t obj = pos; obj < end; obj++) {
+                ListNode* node = (ListNode*)(begin + obj * pool->obj_size);
+
+                if (verify_node_is_linked_(ctx, node)) {
+                    verify_splitter_add_(ctx, node);
+                    break;
+                }
+            }
+        }
+
+        skip = pos - cnt;
+    }
+}
+
+int list_verify_links_parallel(const List* list, const bool check_poison, const size_t threads) {
+    assert(list);
+
+    if (list->size <= 0 || list->head == nullptr)
+        return list_verify_links(list, check_poison);
+
+    // context is too large for stack
+    VerifyContext* ctx = (VerifyContext*)calloc(1, sizeof(VerifyContext));
+    if (ctx == nullptr)
+        return list_verify_links(list, check_poison);
+
+    ctx->list = list;
+    ctx->check_poison = check_poison;
+
+    if (list->engine == List::ENGINE_NODES && !verify_ranges_build_(ctx)) {
+        free(ctx);
+        return list_verify_links(list, check_poison);
+    }
+
+    verify_splitter_add_(ctx, list->head);
+
+    if (list->engine == List::ENGINE_ARRAY) {
+        // the first used slot of every physical chunk
+        size_t chunk = MAX(1, (list->arr.capacity - 1) / List::VERIFY_SPLITTERS);
+
+        for (size_t begin = 1; begin < list->arr.capacity; begin += chunk) {
+            size_t end = MIN(MIN(begin + chunk, begin + VerifyContext::CHUNK_SCAN), list->arr.capacity);
+
+            for (size_t index = begin; index < end; index++) {
+                if (list->arr.prev[index] != ListArray::FREE_SLOT) {
+                    verify_splitter_add_(ctx, list_array_handle(index));
+                    break;
+                }
+            }
+        }
+    } else {
+        verify_splitters_nodes_(ctx);
+    }
+
+    thread_pool_run(verify_segment_, ctx, ctx->segments_cnt, threads);
+
+    bool is_correct = verify_stitch_(ctx);
+
+    free(ctx->ranges);
+    free(ctx);
+
+    // errors are reported by serial walk, so they are the same
+    return is_correct ? list->OK : list_verify_links(list, check_poison);
+}
@@ -1,4 +1,5 @@
 #include "graph_log.h"
+#include "../utils/hash_map.h"
 
 bool create_img(const char* input_filename, const char* output_filename) {
     assert(input_filename);
@@ -19,3 +20,250 @@ bool create_img(const char* input_filename, const char* output_filename) {
 
     return true;
 }
+
+/**
+ * @brief Rendering job
+ */
+struct GraphRenderJob {
+    char dot_filename[GraphRender::MAX_FILENAME_LEN] = {};
+    char img_filename[GraphRender::MAX_FILENAME_LEN] = {};
+};
+
+/**
+ * @brief Rendering queue (ring buffer) and workers state
+ */
+struct GraphRenderQueue {
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t  has_jobs  = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t  has_space = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t  is_empty  = PTHREAD_COND_INITIALIZER;
+
+    GraphRenderJob jobs[GraphRender::QUEUE_CAPACITY] = {};
+    size_t first = 0;
+    size_t count = 0;
+
+    size_t busy = 0;            //< number of workers rendering job taken from queue
+
+    size_t max_workers = GraphRender::DEFAULT_WORKERS;
+    size_t workers = 0;         //< number of started workers
+
+    bool is_atexit_set = false;
+
+    HashMap rendered = {};      //< dot text hash -> graph number (at most GraphRender::MAX_RENDERED)
+    size_t graph_number = 0;
+};
+
+static GraphRenderQueue render_queue = {};
+
+static void graph_render_job_(const GraphRenderJob* job) {
+    assert(job);
+
+    if (create_img(job->dot_filename, job->img_filename))
+        return;
+
+    fprintf(stderr, "Error creating dot graph\n");
+
+    // placeholder, so log doesn't refer to missing image
+    FILE* file = fopen(job->img_filename, "wb");
+    if (file == nullptr)
+        return;
+
+    fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"400\" height=\"40\">"
+                  "<text x=\"10\" y=\"25\" fill=\"red\">dot failed: %s</text></svg>\n",
+                  job->dot_filename);
+    fclose(file);
+}
+
+static void* graph_render_worker_(void*) {
+    pthread_mutex_lock(&render_queue.mutex);
+
+    while (true) {
+        while (render_queue.count == 0)
+            pthread_cond_wait(&render_queue.has_jobs, &render_queue.mutex);
+
+        GraphRenderJob job = render_queue.jobs[render_queue.first];
+        render_queue.first = (render_queue.first + 1) % GraphRender::QUEUE_CAPACITY;
+        render_queue.count--;
+        render_queue.busy++;
+
+        pthread_cond_signal(&render_queue.has_space);
+        pthread_mutex_unlock(&render_queue.mutex);
+
+        graph_render_job_(&job);
+
+        pthread_mutex_lock(&render_queue.mutex);
+        render_queue.busy--;
+
+        if (render_queue.count == 0 && render_queue.busy == 0)
+            pthread_cond_broadcast(&render_queue.is_empty);
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Starts one more worker if limit allows. Must be called under mutex
+ *
+ * @return true if there is at least one worker
+ */
+static bool graph_render_start_worker_() {
+    if (render_queue.workers >= render_queue.max_workers)
+        return render_queue.workers > 0;
+
+    if (!render_queue.is_atexit_set) {
+        atexit(graph_render_flush);
+        render_queue.is_atexit_set = true;
+    }
+
+    pthread_t thread = {};
+    if (pthread_create(&thread, nullptr, graph_render_worker_, nullptr) != 0)
+        return render_queue.workers > 0;
+
+    pthread_detach(thread);
+    render_queue.workers++;
+
+    return true;
+}
+
+static uint64_t graph_hash_(const char* dir, const char* text, const size_t len) {
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    for (const char* c = dir; *c != '\0'; c++)
+        hash = (hash ^ (uint8_t)*c) * 0x100000001B3ull;
+
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (uint8_t)text[i]) * 0x100000001B3ull;
+
+    return hash == HashMap::EMPTY_KEY ? 0 : hash;
+}
+
+static void graph_filename_(char* filename, const char* dir, const size_t number, const char* ext) {
+    size_t str_len = strncat_len(filename, dir, GraphRender::MAX_FILENAME_LEN);
+    snprintf(filename + str_len, GraphRender::MAX_FILENAME_LEN - str_len, "%zu%s", number, ext);
+}
+
+/**
+ * @brief Checks if dot file has exactly given text, so equal hashes are not taken for equal graphs
+ */
+static bool graph_dot_file_equals_(const char* dot_filename, const char* text, const size_t len) {
+    static const size_t BUF_SIZE = 4096;
+
+    FILE* file = fopen(dot_filename, "rb");
+    if (file == nullptr)
+        return false;
+
+    char buf[BUF_SIZE] = {};
+    size_t pos = 0;
+    bool is_equal = true;
+
+    while (is_equal) {
+        size_t read_len = fread(buf, 1, BUF_SIZE, file);
+        if (read_len == 0)
+            break;
+
+        is_equal = read_len <= len - pos && memcmp(buf, text + pos, read_len) == 0;
+        pos += read_len;
+    }
+
+    is_equal = is_equal && pos == len && !ferror(file);
+
+    fclose(file);
+
+    return is_equal;
+}
+
+bool graph_render(const char* dot_text, const size_t dot_len, const char* dir, char* img_filename) {
+    assert(dot_text);
+    assert(dir);
+    assert(img_filename);
+
+    uint64_t hash = graph_hash_(dir, dot_text, dot_len);
+
+    pthread_mutex_lock(&render_queue.mutex);
+
+    if (render_queue.rendered.slots == nullptr)
+        hash_map_ctor(&render_queue.rendered);
+
+    uint64_t* rendered_value = hash_map_find(&render_queue.rendered, hash);
+    size_t rendered_number = rendered_value ? (size_t)*rendered_value : 0;
+
+    pthread_mutex_unlock(&render_queue.mutex);
+
+    if (rendered_value != nullptr) {
+        // dot file of rendered graph is complete: it is written before graph is added to map
+        char rendered_dot[GraphRender::MAX_FILENAME_LEN] = {};
+        graph_filename_(rendered_dot, dir, rendered_number, ".dot");
+
+        if (graph_dot_file_equals_(rendered_dot, dot_text, dot_len)) {
+            graph_filename_(img_filename, dir, rendered_number, ".svg");
+            return true;
+        }
+    }
+
+    pthread_mutex_lock(&render_queue.mutex);
+
+    size_t number = render_queue.graph_number++;
+
+    pthread_mutex_unlock(&render_queue.mutex);
+
+    GraphRenderJob job = {};
+    graph_filename_(job.dot_filename, dir, number, ".dot");
+    graph_filename_(job.img_filename, dir, number, ".svg");
+
+    FILE* file = fopen(job.dot_filename, "wb");
+    if (file == nullptr)
+        return false;
+
+    bool is_written = fwrite(dot_text, 1, dot_len, file) == dot_len;
+    if (fclose(file) != 0 || !is_written)
+        return false;
+
+    strncat_len(img_filename, job.img_filename, GraphRender::MAX_FILENAME_LEN);
+
+    pthread_mutex_lock(&render_queue.mutex);
+
+    // map is limited: graphs rendered long ago are rendered again
+    if (render_queue.rendered.size >= GraphRender::MAX_RENDERED) {
+        hash_map_dtor(&render_queue.rendered);
+        hash_map_ctor(&render_queue.rendered);
+    }
+
+    hash_map_set(&render_queue.rendered, hash, number);
+
+    if (!graph_render_start_worker_()) {
+        pthread_mutex_unlock(&render_queue.mutex);
+
+        graph_render_job_(&job);
+        return true;
+    }
+
+    while (render_queue.count == GraphRender::QUEUE_CAPACITY)
+        pthread_cond_wait(&render_queue.has_space, &render_queue.mutex);
+
+    render_queue.jobs[(render_queue.first + render_queue.count) % GraphRender::QUEUE_CAPACITY] = job;
+    render_queue.count++;
+
+    pthread_cond_signal(&render_queue.has_jobs);
+    pthread_mutex_unlock(&render_queue.mutex);
+
+    return true;
+}
+
+void graph_render_set_workers(const size_t workers) {
+    pthread_mutex_lock(&render_queue.mutex);
+
+    // started workers are not stopped, but new ones are not started
+    render_queue.max_workers = workers < GraphRender::MAX_WORKERS ? workers : GraphRender::MAX_WORKERS;
+
+    pthread_mutex_unlock(&render_queue.mutex);
+}
+
+void graph_render_flush() {
+    pthread_mutex_lock(&render_queue.mutex);
+
+    while (render_queue.count > 0 || render_queue.busy > 0)
+        pthread_cond_wait(&render_queue.is_empty, &render_queue.mutex);
+
+    pthread_mutex_unlock(&render_queue.mutex);
+}
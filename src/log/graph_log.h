@@ -4,9 +4,59 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include "../utils/text/text_lib.h"
 
+/**
+ * @brief Renders dot file to svg synchronously
+ *
+ * @param input_filename
+ * @param output_filename
+ * @return true success
+ * @return false failure
+ */
 bool create_img(const char* input_filename, const char* output_filename);
 
+/**
+ * @brief Background graph rendering settings and limits
+ */
+struct GraphRender {
+    static const size_t DEFAULT_WORKERS = 2;    //< number of dot processes working at once
+    static const size_t MAX_WORKERS     = 16;
+    static const size_t QUEUE_CAPACITY  = 64;   //< graph_render() waits when queue is full
+    static const size_t MAX_RENDERED    = 4096; //< rendered graphs remembered to skip repeated ones
+
+    static const size_t MAX_FILENAME_LEN = 256;
+};
+
+/**
+ * @brief Writes dot text to dir and queues its rendering to svg.
+ * Graphs with the same text are rendered once, img_filename of the first one is returned for others
+ * (text is compared with dot file of that graph, up to GraphRender::MAX_RENDERED graphs are remembered).
+ * If dot fails, placeholder svg is written, so img_filename always refers to existing file after flush
+ *
+ * @param dot_text
+ * @param dot_len
+ * @param dir directory for .dot and .svg files (with trailing '/')
+ * @param img_filename [out] svg filename, empty GraphRender::MAX_FILENAME_LEN buffer
+ * @return true success
+ * @return false dot file can't be written
+ */
+bool graph_render(const char* dot_text, const size_t dot_len, const char* dir, char* img_filename);
+
+/**
+ * @brief Sets number of rendering workers
+ *
+ * @param workers 0 - render synchronously in graph_render()
+ */
+void graph_render_set_workers(const size_t workers);
+
+/**
+ * @brief Waits until all queued graphs are rendered. Called at exit automatically
+ */
+void graph_render_flush();
+
 #endif //< #ifndef GRAPH_LOG_H_
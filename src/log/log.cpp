@@ -1,24 +1,496 @@
 #include "log.h"
 
+/**
+ * @brief Formatted text waiting to be written. Text is placed right after header
+ */
+struct LogBlock {
+    LogFileData* log = nullptr;
+    size_t capacity  = 0;
+    size_t len       = 0;
+};
+
+/**
+ * @brief Ring slot. seq shows if slot is free for producer or filled for writer
+ */
+struct LogRingSlot {
+    size_t    seq   = 0;
+    LogBlock* block = nullptr;
+};
+
+/**
+ * @brief Bounded lock-free ring of filled blocks and writer thread state
+ */
+struct LogWriter {
+    LogRingSlot slots[LogSettings::RING_CAPACITY] = {};
+
+    size_t enqueue_pos = 0;
+    size_t dequeue_pos = 0;
+    size_t written     = 0;     //< number of written blocks
+
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t  has_blocks  = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t  has_written = PTHREAD_COND_INITIALIZER;
+
+    int is_sleeping   = 0;
+    int flush_waiters = 0;
+
+    int is_started = 0;
+    bool is_failed = false;     //< writer can't be started, blocks are written synchronously
+};
+
+static LogWriter log_writer = {};
+
+/**
+ * @brief Buffer of current thread. Filled part is submitted on thread exit. Live buffers are
+ * registered, so log_flush() submits filled parts of all threads
+ */
+struct LogThreadBuffer {
+    LogBlock* block = nullptr;
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;  //< block is taken by log_flush() from other threads
+
+    LogThreadBuffer* prev = nullptr;    //< registry links
+    LogThreadBuffer* next = nullptr;
+    bool is_registered = false;
+
+    LogThreadBuffer() = default;
+    LogThreadBuffer(const LogThreadBuffer&) = delete;
+    LogThreadBuffer& operator=(const LogThreadBuffer&) = delete;
+
+    ~LogThreadBuffer();
+};
+
+static thread_local LogThreadBuffer log_thread_buffer;
+
+// set by buffer destructor. Calls after thread_local destruction (atexit log_flush(), destructors
+// of other thread_local objects) check this flag and never touch destroyed buffer
+static thread_local bool log_thread_buffer_is_destroyed = false;
+
+// registry of live thread buffers
+static pthread_mutex_t log_buffers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static LogThreadBuffer* log_buffers = nullptr;
+
+static inline char* log_block_data_(LogBlock* block) {
+    return (char*)(block + 1);
+}
+
+static LogBlock* log_block_alloc_(LogFileData* log, const size_t capacity) {
+    LogBlock* block = (LogBlock*)malloc(sizeof(LogBlock) + capacity);
+    if (block == nullptr)
+        return nullptr;
+
+    block->log      = log;
+    block->capacity = capacity;
+    block->len      = 0;
+
+    return block;
+}
+
+/**
+ * @brief Writes block with write() calls only (may be called from signal handler)
+ */
+static void log_block_write_(LogBlock* block) {
+    assert(block);
+
+    const char* data = log_block_data_(block);
+    size_t left = block->len;
+
+    while (left > 0 && block->log->fd >= 0) {
+        ssize_t ret = write(block->log->fd, data, left);
+
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+
+            return;
+        }
+
+        data += ret;
+        left -= (size_t)ret;
+    }
+}
+
+static size_t log_ring_push_(LogBlock* block) {
+    size_t pos = __atomic_load_n(&log_writer.enqueue_pos, __ATOMIC_RELAXED);
+    LogRingSlot* slot = nullptr;
+
+    while (true) {
+        slot = &log_writer.slots[pos % LogSettings::RING_CAPACITY];
+
+        size_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        ssize_t diff = (ssize_t)seq - (ssize_t)pos;
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&log_writer.enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            // ring is full: writer is behind
+            sched_yield();
+            pos = __atomic_load_n(&log_writer.enqueue_pos, __ATOMIC_RELAXED);
+        } else {
+            pos = __atomic_load_n(&log_writer.enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->block = block;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return pos + 1;
+}
+
+static LogBlock* log_ring_pop_() {
+    size_t pos = __atomic_load_n(&log_writer.dequeue_pos, __ATOMIC_RELAXED);
+    LogRingSlot* slot = nullptr;
+
+    while (true) {
+        slot = &log_writer.slots[pos % LogSettings::RING_CAPACITY];
+
+        size_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        ssize_t diff = (ssize_t)seq - (ssize_t)(pos + 1);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&log_writer.dequeue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            return nullptr;
+        } else {
+            pos = __atomic_load_n(&log_writer.dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    LogBlock* block = slot->block;
+    __atomic_store_n(&slot->seq, pos + LogSettings::RING_CAPACITY, __ATOMIC_RELEASE);
+
+    return block;
+}
+
+static void* log_writer_thread_(void*) {
+    while (true) {
+        LogBlock* block = log_ring_pop_();
+
+        if (block != nullptr) {
+            log_block_write_(block);
+            free(block);
+
+            __atomic_add_fetch(&log_writer.written, 1, __ATOMIC_SEQ_CST);
+
+            if (__atomic_load_n(&log_writer.flush_waiters, __ATOMIC_SEQ_CST) > 0) {
+                pthread_mutex_lock(&log_writer.mutex);
+                pthread_cond_broadcast(&log_writer.has_written);
+                pthread_mutex_unlock(&log_writer.mutex);
+            }
+
+            continue;
+        }
+
+        pthread_mutex_lock(&log_writer.mutex);
+        __atomic_store_n(&log_writer.is_sleeping, 1, __ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n(&log_writer.enqueue_pos, __ATOMIC_SEQ_CST) ==
+            __atomic_load_n(&log_writer.dequeue_pos, __ATOMIC_SEQ_CST)) {
+            timespec deadline = {};
+            clock_gettime(CLOCK_REALTIME, &deadline);
+
+            deadline.tv_nsec += LogSettings::WRITER_SLEEP_NS;
+            if (deadline.tv_nsec >= 1000000000) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+
+            pthread_cond_timedwait(&log_writer.has_blocks, &log_writer.mutex, &deadline);
+        }
+
+        __atomic_store_n(&log_writer.is_sleeping, 0, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&log_writer.mutex);
+    }
+
+    return nullptr;
+}
+
+#ifndef _WIN32
+static void log_crash_handler_(int sig) {
+    // writer thread may be stopped: queued blocks and buffer of this thread are written here
+    LogBlock* block = nullptr;
+    while ((block = log_ring_pop_()) != nullptr)
+        log_block_write_(block);
+
+    if (!log_thread_buffer_is_destroyed && log_thread_buffer.block != nullptr)
+        log_block_write_(log_thread_buffer.block);
+
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void log_set_crash_handlers_() {
+    static const int SIGNALS[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+    for (size_t i = 0; i < sizeof(SIGNALS) / sizeof(*SIGNALS); i++) {
+        struct sigaction old_action = {};
+
+        // handlers set by user (or sanitizer) are not replaced
+        if (sigaction(SIGNALS[i], nullptr, &old_action) != 0 || old_action.sa_handler != SIG_DFL)
+            continue;
+
+        struct sigaction action = {};
+        action.sa_handler = log_crash_handler_;
+        action.sa_flags = (int)SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+
+        sigaction(SIGNALS[i], &action, nullptr);
+    }
+}
+#endif //< #ifndef _WIN32
+
+/**
+ * @brief Starts writer thread if it is not started
+ *
+ * @return false if blocks must be written synchronously
+ */
+static bool log_writer_start_() {
+    if (__atomic_load_n(&log_writer.is_started, __ATOMIC_ACQUIRE))
+        return true;
+
+    pthread_mutex_lock(&log_writer.mutex);
+
+    if (!log_writer.is_started && !log_writer.is_failed) {
+        for (size_t i = 0; i < LogSettings::RING_CAPACITY; i++)
+            log_writer.slots[i].seq = i;
+
+        pthread_t thread = {};
+        if (pthread_create(&thread, nullptr, log_writer_thread_, nullptr) != 0) {
+            log_writer.is_failed = true;
+        } else {
+            pthread_detach(thread);
+            atexit(log_flush);
+
+#ifndef _WIN32
+            log_set_crash_handlers_();
+#endif //< #ifndef _WIN32
+
+            __atomic_store_n(&log_writer.is_started, 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    bool is_started = log_writer.is_started;
+
+    pthread_mutex_unlock(&log_writer.mutex);
+
+    return is_started;
+}
+
+/**
+ * @brief Passes filled block to writer thread
+ *
+ * @return size_t ring position of block (0 if it was written synchronously)
+ */
+static size_t log_block_submit_(LogBlock* block) {
+    assert(block);
+
+    if (!log_writer_start_()) {
+        log_block_write_(block);
+        free(block);
+        return 0;
+    }
+
+    size_t ticket = log_ring_push_(block);
+
+    if (__atomic_load_n(&log_writer.is_sleeping, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&log_writer.mutex);
+        pthread_cond_signal(&log_writer.has_blocks);
+        pthread_mutex_unlock(&log_writer.mutex);
+    }
+
+    return ticket;
+}
+
+/**
+ * @brief Submits block with text, frees empty one
+ */
+static void log_block_release_(LogBlock* block) {
+    if (block == nullptr)
+        return;
+
+    if (block->len > 0)
+        log_block_submit_(block);
+    else
+        free(block);
+}
+
+static void log_buffer_register_(LogThreadBuffer* buffer) {
+    if (buffer->is_registered)
+        return;
+
+    pthread_mutex_lock(&log_buffers_mutex);
+
+    buffer->prev = nullptr;
+    buffer->next = log_buffers;
+
+    if (log_buffers != nullptr)
+        log_buffers->prev = buffer;
+
+    log_buffers = buffer;
+
+    pthread_mutex_unlock(&log_buffers_mutex);
+
+    buffer->is_registered = true;
+}
+
+LogThreadBuffer::~LogThreadBuffer() {
+    log_thread_buffer_is_destroyed = true;
+
+    if (is_registered) {
+        pthread_mutex_lock(&log_buffers_mutex);
+
+        if (prev != nullptr)
+            prev->next = next;
+        else
+            log_buffers = next;
+
+        if (next != nullptr)
+            next->prev = prev;
+
+        pthread_mutex_unlock(&log_buffers_mutex);
+    }
+
+    // buffer can't be reached by log_flush() anymore
+    log_block_release_(block);
+    block = nullptr;
+
+    pthread_mutex_destroy(&mutex);
+}
+
+void log_flush() {
+    // filled parts of all live thread buffers
+    pthread_mutex_lock(&log_buffers_mutex);
+
+    for (LogThreadBuffer* buffer = log_buffers; buffer != nullptr; buffer = buffer->next) {
+        pthread_mutex_lock(&buffer->mutex);
+
+        // submitted under lock, so owner thread can't submit newer text before it
+        if (buffer->block != nullptr && buffer->block->len > 0) {
+            log_block_submit_(buffer->block);
+            buffer->block = nullptr;
+        }
+
+        pthread_mutex_unlock(&buffer->mutex);
+    }
+
+    pthread_mutex_unlock(&log_buffers_mutex);
+
+    if (!__atomic_load_n(&log_writer.is_started, __ATOMIC_ACQUIRE))
+        return;
+
+    // everything queued before this point
+    size_t ticket = __atomic_load_n(&log_writer.enqueue_pos, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_lock(&log_writer.mutex);
+    __atomic_add_fetch(&log_writer.flush_waiters, 1, __ATOMIC_SEQ_CST);
+
+    pthread_cond_signal(&log_writer.has_blocks);
+
+    while (__atomic_load_n(&log_writer.written, __ATOMIC_SEQ_CST) < ticket) {
+        timespec deadline = {};
+        clock_gettime(CLOCK_REALTIME, &deadline);
+
+        deadline.tv_nsec += LogSettings::WRITER_SLEEP_NS;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        pthread_cond_timedwait(&log_writer.has_written, &log_writer.mutex, &deadline);
+    }
+
+    __atomic_sub_fetch(&log_writer.flush_waiters, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&log_writer.mutex);
+}
+
+/**
+ * @brief Formats text to the end of *block (new block is allocated if it is nullptr).
+ * If text doesn't fit, *block is moved to *filled and text goes to new block
+ *
+ * @return int number of printed chars, -1 on error
+ */
+static int log_block_vprintf_(LogFileData* log_file, LogBlock** block, LogBlock** filled,
+                              const char* format, va_list arg_list, va_list arg_list_copy) {
+    if (*block == nullptr) {
+        *block = log_block_alloc_(log_file, LogSettings::BLOCK_SIZE);
+        if (*block == nullptr)
+            return -1;
+    }
+
+    LogBlock* cur = *block;
+
+    int ret = vsnprintf(log_block_data_(cur) + cur->len, cur->capacity - cur->len, format, arg_list);
+
+    if (ret >= 0 && (size_t)ret >= cur->capacity - cur->len) {
+        // text doesn't fit: block is submitted, text goes to new one
+        *filled = cur;
+
+        size_t capacity = (size_t)ret + 1 > LogSettings::BLOCK_SIZE ? (size_t)ret + 1 : LogSettings::BLOCK_SIZE;
+
+        cur = *block = log_block_alloc_(log_file, capacity);
+        if (cur == nullptr)
+            return -1;
+
+        ret = vsnprintf(log_block_data_(cur), cur->capacity, format, arg_list_copy);
+    }
+
+    if (ret > 0)
+        cur->len += (size_t)ret;
+
+    return ret;
+}
+
 int log_printf(LogFileData* log_file, const char* format, ...) {
     assert(log_file);
     assert(format);
 
-    bool file_is_opened_here = false;
-    if (log_file->file == nullptr) {
-        if (!log_open_file(log_file))
-            return -1;
-        file_is_opened_here = true;
-    }
+    if (log_file->fd < 0 && !log_open_file(log_file))
+        return -1;
 
     va_list arg_list = {};
     va_start(arg_list, format);
 
-    int ret = vfprintf(log_file->file, format, arg_list);
+    va_list arg_list_copy = {};
+    va_copy(arg_list_copy, arg_list);
 
-    if (file_is_opened_here)
-        if (!log_close_file(log_file))
-            return -1;
+    LogBlock* other  = nullptr;     //< buffered text of other log file
+    LogBlock* filled = nullptr;
+    int ret = 0;
+
+    if (log_thread_buffer_is_destroyed) {
+        // exiting thread: text is formatted to local block and submitted at once
+        LogBlock* block = nullptr;
+
+        ret = log_block_vprintf_(log_file, &block, &filled, format, arg_list, arg_list_copy);
+
+        log_block_release_(filled);
+        log_block_release_(block);
+    } else {
+        LogThreadBuffer* buffer = &log_thread_buffer;
+        log_buffer_register_(buffer);
+
+        pthread_mutex_lock(&buffer->mutex);
+
+        if (buffer->block != nullptr && buffer->block->log != log_file) {
+            other = buffer->block;
+            buffer->block = nullptr;
+        }
+
+        ret = log_block_vprintf_(log_file, &buffer->block, &filled, format, arg_list, arg_list_copy);
+
+        // blocks are submitted under lock: log_flush() takes buffer->block only after them,
+        // so text order is kept and flush ticket covers them
+        log_block_release_(other);
+        log_block_release_(filled);
+
+        pthread_mutex_unlock(&buffer->mutex);
+    }
+
+    va_end(arg_list_copy);
+    va_end(arg_list);
 
     return ret;
 }
@@ -37,9 +509,12 @@ bool log_open_file(LogFileData* log_file, const char* mode) {
     strncat_len(filename, log_file->timestamp_dir, log_file->MAX_FILENAME_LEN);
     strncat_len(filename, "log.html", log_file->MAX_FILENAME_LEN);
 
-    log_file->file = fopen(filename, mode);
+    // fopen() mode is translated to open() flags
+    int flags = O_WRONLY | O_CREAT | (strchr(mode, 'a') != nullptr ? O_APPEND : O_TRUNC);
 
-    if (log_file->file == nullptr) {
+    log_file->fd = open(filename, flags, 0644);
+
+    if (log_file->fd < 0) {
         perror("Error opening log_file file");
         return false;
     }
@@ -72,12 +547,14 @@ bool log_create_timestamp_dir(LogFileData* log_file) {
 bool log_close_file(LogFileData* log_file) {
     assert(log_file);
 
-    if (log_file->file == nullptr || fclose(log_file->file) != 0) {
+    log_flush();
+
+    if (log_file->fd < 0 || close(log_file->fd) != 0) {
         perror("Error closing log_file file");
         return false;
     }
 
-    log_file->file = nullptr;
+    log_file->fd = -1;
     return true;
 }
 
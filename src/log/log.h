@@ -11,6 +11,11 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sched.h>
 
 #include "../utils/text/text_lib.h"
 
@@ -25,22 +30,40 @@
  */
 struct LogFileData {
     const char* dir = nullptr;
-    FILE* file = nullptr;
+    int fd = -1;                //< file is kept open until log_close_file()
 
     static const size_t MAX_FILENAME_LEN = 256;
     char timestamp_dir[MAX_FILENAME_LEN] = {};
 };
 
 /**
- * @brief Prints data in printf format to log file
+ * @brief Asynchronous logger settings
+ */
+struct LogSettings {
+    static const size_t BLOCK_SIZE    = 1 << 16;    //< per-thread buffer size (and typical write() size)
+    static const size_t RING_CAPACITY = 256;        //< filled buffers waiting for writer thread
+
+    static const long WRITER_SLEEP_NS = 10000000;   //< writer wakes up at least so often
+};
+
+/**
+ * @brief Prints data in printf format to log file.
+ * Text is formatted to per-thread buffer, filled buffers are written by writer thread.
+ * File is opened on first call and stays open
  *
  * @param log
  * @param format
  * @param ...
- * @return int
+ * @return int number of printed chars, -1 on error
  */
 int log_printf(LogFileData* log, const char* format, ...);
 
+/**
+ * @brief Flush point: buffers of all live threads and all queued buffers are written to files.
+ * Called at exit, on log_close_file() and on crash signals
+ */
+void log_flush();
+
 /**
  * @brief Opens log file
  *
@@ -52,7 +75,7 @@ int log_printf(LogFileData* log, const char* format, ...);
 bool log_open_file(LogFileData* log, const char* mode = "ab");
 
 /**
- * @brief Closes log fle
+ * @brief Flushes and closes log fle
  *
  * @param log
  * @return true success
@@ -1,5 +1,6 @@
 #include "log/log.h"
 #include "list.h"
+#include "list_t.h"
 
 LogFileData log_file = {"log"};
 
@@ -8,6 +9,7 @@ int main() {
 
     List list = {};
     LIST_CTOR(&list);
+    list_reserve(&list, 8);
 
     ListNode* inserted = nullptr;
     LIST_DUMP(&list);
@@ -38,5 +40,41 @@ int main() {
 
     list_dtor(&list);
 
+    List arr_list = {};
+    LIST_CTOR(&arr_list, List::ENGINE_ARRAY);
+    list_set_verify_level(&arr_list, List::VERIFY_FULL);
+
+    const Elem_t arr_elems[] = {100, 200, 300, 400, 500};
+    list_from_array(&arr_list, arr_elems, sizeof(arr_elems) / sizeof(*arr_elems));
+
+    list_pushfront(&arr_list, 0, &inserted);
+    list_find_by_value(&arr_list, 300, &inserted);
+    list_delete(&arr_list, inserted);
+
+    LIST_DUMP(&arr_list);
+
+    // the same dump as binary snapshot (render it with list_render)
+    list_set_dump_format(List::DUMP_BINARY);
+    LIST_DUMP(&arr_list);
+    list_set_dump_format(List::DUMP_HTML);
+
+    list_dtor(&arr_list);
+
+    ListT<double> typed_list = {};
+    LIST_CTOR(&typed_list);
+
+    ListNodeT<double>* typed_inserted = nullptr;
+    list_emplace_back(&typed_list, &typed_inserted, 1.5);
+    list_emplace_back(&typed_list, &typed_inserted, 2.5);
+    list_emplace_front(&typed_list, &typed_inserted, 0.5);
+
+    double moved = 0;
+    list_delete(&typed_list, typed_inserted, &moved);
+    list_pushback(&typed_list, moved * 10);
+
+    LIST_DUMP(&typed_list);
+
+    list_dtor(&typed_list);
+
     log_close_file(&log_file);
 }
@@ -0,0 +1,146 @@
+#include "bg_free.h"
+
+/**
+ * @brief Chain waiting to be freed
+ */
+struct BgFreeJob {
+    void* first = nullptr;
+    size_t next_offset = 0;     //< SIZE_MAX - single block
+
+    BgFreeJob* next = nullptr;
+};
+
+/**
+ * @brief Background free queue
+ */
+struct BgFreeQueue {
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t  has_jobs = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t  is_empty = PTHREAD_COND_INITIALIZER;
+
+    BgFreeJob* head = nullptr;
+    BgFreeJob* tail = nullptr;
+
+    bool is_busy    = false;    //< worker is freeing a job taken from queue
+    bool is_started = false;
+    bool is_failed  = false;    //< worker can't be started
+};
+
+static BgFreeQueue bg_queue = {};
+
+static void bg_free_job_(const BgFreeJob* job) {
+    assert(job);
+
+    if (job->next_offset == (size_t)-1) {
+        free(job->first);
+        return;
+    }
+
+    char* block = (char*)job->first;
+    while (block != nullptr) {
+        char* next = *(char**)(block + job->next_offset);
+        free(block);
+        block = next;
+    }
+}
+
+static void* bg_free_worker_(void*) {
+    pthread_mutex_lock(&bg_queue.mutex);
+
+    while (true) {
+        while (bg_queue.head == nullptr)
+            pthread_cond_wait(&bg_queue.has_jobs, &bg_queue.mutex);
+
+        BgFreeJob* job = bg_queue.head;
+        bg_queue.head = job->next;
+        if (bg_queue.head == nullptr)
+            bg_queue.tail = nullptr;
+
+        bg_queue.is_busy = true;
+        pthread_mutex_unlock(&bg_queue.mutex);
+
+        bg_free_job_(job);
+        free(job);
+
+        pthread_mutex_lock(&bg_queue.mutex);
+        bg_queue.is_busy = false;
+
+        if (bg_queue.head == nullptr)
+            pthread_cond_broadcast(&bg_queue.is_empty);
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Starts worker if it is not started. Must be called under mutex
+ */
+static bool bg_free_start_() {
+    if (bg_queue.is_started)
+        return true;
+
+    if (bg_queue.is_failed)
+        return false;
+
+    pthread_t thread = {};
+    if (pthread_create(&thread, nullptr, bg_free_worker_, nullptr) != 0) {
+        bg_queue.is_failed = true;
+        return false;
+    }
+
+    pthread_detach(thread);
+    atexit(bg_free_flush);
+
+    bg_queue.is_started = true;
+    return true;
+}
+
+static void bg_free_push_(void* first, const size_t next_offset) {
+    if (first == nullptr)
+        return;
+
+    BgFreeJob* job = (BgFreeJob*)calloc(1, sizeof(BgFreeJob));
+
+    pthread_mutex_lock(&bg_queue.mutex);
+
+    if (job == nullptr || !bg_free_start_()) {
+        pthread_mutex_unlock(&bg_queue.mutex);
+
+        free(job);
+
+        BgFreeJob sync_job = {first, next_offset, nullptr};
+        bg_free_job_(&sync_job);
+        return;
+    }
+
+    job->first = first;
+    job->next_offset = next_offset;
+
+    if (bg_queue.tail == nullptr)
+        bg_queue.head = job;
+    else
+        bg_queue.tail->next = job;
+    bg_queue.tail = job;
+
+    pthread_cond_signal(&bg_queue.has_jobs);
+    pthread_mutex_unlock(&bg_queue.mutex);
+}
+
+void bg_free_chain(void* first, const size_t next_offset) {
+    assert(next_offset != (size_t)-1);
+
+    bg_free_push_(first, next_offset);
+}
+
+void bg_free(void* ptr) {
+    bg_free_push_(ptr, (size_t)-1);
+}
+
+void bg_free_flush() {
+    pthread_mutex_lock(&bg_queue.mutex);
+
+    while (bg_queue.head != nullptr || bg_queue.is_busy)
+        pthread_cond_wait(&bg_queue.is_empty, &bg_queue.mutex);
+
+    pthread_mutex_unlock(&bg_queue.mutex);
+}
@@ -0,0 +1,31 @@
+#ifndef BG_FREE_H_
+#define BG_FREE_H_
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include <pthread.h>
+
+/**
+ * @brief Frees singly linked chain of malloc'ed blocks in background thread.
+ * Pointer to the next block is stored in each block at next_offset.
+ * If background thread can't be started, chain is freed synchronously
+ *
+ * @param first
+ * @param next_offset
+ */
+void bg_free_chain(void* first, const size_t next_offset);
+
+/**
+ * @brief Frees one malloc'ed block in background thread
+ *
+ * @param ptr
+ */
+void bg_free(void* ptr);
+
+/**
+ * @brief Waits until all queued blocks are freed. Called automatically at exit
+ */
+void bg_free_flush();
+
+#endif //< #ifndef BG_FREE_H_
@@ -0,0 +1,243 @@
+#include <sched.h>
+#include <string.h>
+
+#include "epoch.h"
+
+/**
+ * @brief Guard state of one thread. Records are cache line aligned, so guards of different threads
+ * don't share lines
+ */
+struct __attribute__((aligned(64))) EpochRecord {
+    uint64_t state   = 0;   //< (epoch << 1) | 1 inside guard, 0 outside
+    int      is_used = 0;   //< record is owned by thread
+};
+
+/**
+ * @brief Block waiting for reclamation
+ */
+struct EpochRetired {
+    void*    ptr   = nullptr;
+    uint64_t epoch = 0;     //< global epoch when block was retired
+};
+
+/**
+ * @brief Retired blocks queue. Blocks [first, size) are not freed yet. Epochs don't decrease in thread
+ * limbo; orphans of different threads are mixed, so they are freed conservatively (up to first unready)
+ */
+struct EpochLimbo {
+    EpochRetired* blocks = nullptr;
+
+    size_t first    = 0;
+    size_t size     = 0;
+    size_t capacity = 0;
+};
+
+/**
+ * @brief Global epoch, guard records of all threads and blocks left by finished threads
+ */
+struct EpochDomain {
+    uint64_t epoch = 1;
+
+    EpochRecord records[EpochSettings::MAX_THREADS] = {};
+    size_t records_used = 0;    //< records [0, records_used) may be owned
+
+    pthread_mutex_t orphans_mutex = PTHREAD_MUTEX_INITIALIZER;
+    EpochLimbo orphans = {};
+};
+
+static EpochDomain epoch_domain = {};
+
+/**
+ * @brief Guard nesting and retired blocks of current thread. Blocks are given to domain on thread exit
+ */
+struct EpochThread {
+    int    record  = -1;
+    size_t nesting = 0;
+
+    size_t retired_cnt = 0;
+    EpochLimbo limbo = {};
+
+    EpochThread() = default;
+    EpochThread(const EpochThread&) = delete;
+    EpochThread& operator=(const EpochThread&) = delete;
+
+    ~EpochThread();
+};
+
+static thread_local EpochThread epoch_thread;
+
+/**
+ * @brief Adds block to limbo. If limbo can't grow, block is never freed (it may still be read)
+ */
+static bool epoch_limbo_push_(EpochLimbo* limbo, void* ptr, const uint64_t epoch) {
+    assert(limbo);
+
+    if (limbo->size == limbo->capacity) {
+        if (limbo->first > 0) {
+            memmove(limbo->blocks, limbo->blocks + limbo->first,
+                    (limbo->size - limbo->first) * sizeof(EpochRetired));
+
+            limbo->size -= limbo->first;
+            limbo->first = 0;
+        } else {
+            size_t new_capacity = limbo->capacity ? limbo->capacity * 2 : EpochSettings::RECLAIM_PERIOD;
+
+            EpochRetired* new_blocks = (EpochRetired*)realloc(limbo->blocks, new_capacity * sizeof(EpochRetired));
+            if (new_blocks == nullptr)
+                return false;
+
+            limbo->blocks = new_blocks;
+            limbo->capacity = new_capacity;
+        }
+    }
+
+    limbo->blocks[limbo->size++] = {ptr, epoch};
+
+    return true;
+}
+
+/**
+ * @brief Frees blocks retired two or more epochs ago: every thread inside guard entered it later
+ */
+static void epoch_limbo_free_ready_(EpochLimbo* limbo, const uint64_t epoch) {
+    assert(limbo);
+
+    while (limbo->first < limbo->size && limbo->blocks[limbo->first].epoch + 2 <= epoch)
+        free(limbo->blocks[limbo->first++].ptr);
+
+    if (limbo->first == limbo->size)
+        limbo->first = limbo->size = 0;
+}
+
+static EpochRecord* epoch_record_() {
+    if (epoch_thread.record >= 0)
+        return &epoch_domain.records[epoch_thread.record];
+
+    // waits for free record if there are too many threads
+    while (true) {
+        for (size_t i = 0; i < EpochSettings::MAX_THREADS; i++) {
+            int expected = 0;
+            if (__atomic_load_n(&epoch_domain.records[i].is_used, __ATOMIC_RELAXED) != 0 ||
+                !__atomic_compare_exchange_n(&epoch_domain.records[i].is_used, &expected, 1, false,
+                                             __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                continue;
+
+            size_t used = __atomic_load_n(&epoch_domain.records_used, __ATOMIC_RELAXED);
+            while (used < i + 1 &&
+                   !__atomic_compare_exchange_n(&epoch_domain.records_used, &used, i + 1, true,
+                                                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {}
+
+            epoch_thread.record = (int)i;
+            return &epoch_domain.records[i];
+        }
+
+        sched_yield();
+    }
+}
+
+/**
+ * @brief Advances global epoch if all threads inside guards entered them in current epoch
+ *
+ * @return uint64_t current global epoch
+ */
+static uint64_t epoch_try_advance_() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    uint64_t epoch = __atomic_load_n(&epoch_domain.epoch, __ATOMIC_SEQ_CST);
+    size_t used = __atomic_load_n(&epoch_domain.records_used, __ATOMIC_SEQ_CST);
+
+    for (size_t i = 0; i < used; i++) {
+        uint64_t state = __atomic_load_n(&epoch_domain.records[i].state, __ATOMIC_SEQ_CST);
+
+        if ((state & 1) && (state >> 1) != epoch)
+            return epoch;
+    }
+
+    if (__atomic_compare_exchange_n(&epoch_domain.epoch, &epoch, epoch + 1, false,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        return epoch + 1;
+
+    return epoch;
+}
+
+void epoch_enter() {
+    if (epoch_thread.nesting++ > 0)
+        return;
+
+    EpochRecord* record = epoch_record_();
+
+    uint64_t epoch = __atomic_load_n(&epoch_domain.epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&record->state, (epoch << 1) | 1, __ATOMIC_SEQ_CST);
+
+    // pointers are read only after guard is visible to reclaiming threads
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void epoch_exit() {
+    assert(epoch_thread.nesting > 0);
+
+    if (--epoch_thread.nesting > 0)
+        return;
+
+    __atomic_store_n(&epoch_domain.records[epoch_thread.record].state, 0, __ATOMIC_RELEASE);
+}
+
+void epoch_retire(void* ptr) {
+    if (ptr == nullptr)
+        return;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint64_t epoch = __atomic_load_n(&epoch_domain.epoch, __ATOMIC_SEQ_CST);
+
+    if (!epoch_limbo_push_(&epoch_thread.limbo, ptr, epoch))
+        return;
+
+    if (++epoch_thread.retired_cnt % EpochSettings::RECLAIM_PERIOD == 0)
+        epoch_reclaim();
+}
+
+void epoch_reclaim() {
+    uint64_t epoch = epoch_try_advance_();
+
+    epoch_limbo_free_ready_(&epoch_thread.limbo, epoch);
+
+    // orphans are freed by whoever gets the lock
+    if (pthread_mutex_trylock(&epoch_domain.orphans_mutex) != 0)
+        return;
+
+    epoch_limbo_free_ready_(&epoch_domain.orphans, epoch);
+
+    pthread_mutex_unlock(&epoch_domain.orphans_mutex);
+}
+
+size_t epoch_pending() {
+    size_t pending = epoch_thread.limbo.size - epoch_thread.limbo.first;
+
+    pthread_mutex_lock(&epoch_domain.orphans_mutex);
+    pending += epoch_domain.orphans.size - epoch_domain.orphans.first;
+    pthread_mutex_unlock(&epoch_domain.orphans_mutex);
+
+    return pending;
+}
+
+EpochThread::~EpochThread() {
+    if (record >= 0) {
+        __atomic_store_n(&epoch_domain.records[record].state, 0, __ATOMIC_RELEASE);
+        nesting = 0;
+    }
+
+    epoch_reclaim();
+
+    pthread_mutex_lock(&epoch_domain.orphans_mutex);
+
+    for (size_t i = limbo.first; i < limbo.size; i++)
+        epoch_limbo_push_(&epoch_domain.orphans, limbo.blocks[i].ptr, limbo.blocks[i].epoch);
+
+    pthread_mutex_unlock(&epoch_domain.orphans_mutex);
+
+    free(limbo.blocks);
+    limbo = {};
+
+    if (record >= 0)
+        __atomic_store_n(&epoch_domain.records[record].is_used, 0, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,46 @@
+#ifndef EPOCH_H_
+#define EPOCH_H_
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+
+struct EpochSettings {
+    static const size_t MAX_THREADS    = 256;  //< threads inside guards at the same time
+    static const size_t RECLAIM_PERIOD = 64;   //< retired blocks between reclamation attempts
+};
+
+/**
+ * @brief Enters epoch guard. Blocks retired by other threads are not freed until guard is left,
+ * so pointers read inside guard stay valid. Guards may be nested
+ */
+void epoch_enter();
+
+/**
+ * @brief Leaves epoch guard
+ */
+void epoch_exit();
+
+/**
+ * @brief Frees malloc'ed block when all threads which could read pointer to it left their guards.
+ * Block must be unreachable for threads entering guards after this call
+ *
+ * @param ptr
+ */
+void epoch_retire(void* ptr);
+
+/**
+ * @brief Tries to advance global epoch and frees blocks which can't be read anymore
+ */
+void epoch_reclaim();
+
+/**
+ * @brief Returns number of retired blocks which are not freed yet
+ *
+ * @return size_t
+ */
+size_t epoch_pending();
+
+#endif //< #ifndef EPOCH_H_
@@ -0,0 +1,178 @@
+#include "hash_map.h"
+
+static inline size_t hash_map_hash_(const uint64_t key) {
+    // splitmix64 finalizer
+    uint64_t x = key;
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+
+    return (size_t)x;
+}
+
+static bool hash_map_alloc_(HashMap* map, const size_t capacity) {
+    assert(map);
+
+    HashMapSlot* slots = (HashMapSlot*)malloc(capacity * sizeof(HashMapSlot));
+    if (slots == nullptr)
+        return false;
+
+    for (size_t i = 0; i < capacity; i++)
+        slots[i].key = HashMap::EMPTY_KEY;
+
+    map->slots = slots;
+    map->capacity = capacity;
+
+    return true;
+}
+
+bool hash_map_ctor(HashMap* map, const size_t size_hint) {
+    assert(map);
+
+    size_t capacity = HashMap::MIN_CAPACITY;
+    while (capacity < size_hint * 2)
+        capacity *= 2;
+
+    map->size = 0;
+    map->probes = 0;
+
+    return hash_map_alloc_(map, capacity);
+}
+
+void hash_map_dtor(HashMap* map) {
+    assert(map);
+
+    free(map->slots);
+    map->slots = nullptr;
+
+    map->capacity = 0;
+    map->size = 0;
+}
+
+static bool hash_map_grow_(HashMap* map) {
+    assert(map);
+
+    HashMapSlot* old_slots = map->slots;
+    size_t old_capacity = map->capacity;
+
+    if (!hash_map_alloc_(map, old_capacity * 2)) {
+        map->slots = old_slots;
+        return false;
+    }
+
+    size_t mask = map->capacity - 1;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].key == HashMap::EMPTY_KEY)
+            continue;
+
+        size_t pos = hash_map_hash_(old_slots[i].key) & mask;
+        while (map->slots[pos].key != HashMap::EMPTY_KEY)
+            pos = (pos + 1) & mask;
+
+        map->slots[pos] = old_slots[i];
+    }
+
+    free(old_slots);
+
+    return true;
+}
+
+bool hash_map_set(HashMap* map, const uint64_t key, const uint64_t value) {
+    assert(map);
+    assert(map->slots);
+    assert(key != HashMap::EMPTY_KEY);
+
+    // load factor <= 1/2
+    if ((map->size + 1) * 2 > map->capacity && !hash_map_grow_(map))
+        return false;
+
+    size_t mask = map->capacity - 1;
+    size_t pos = hash_map_hash_(key) & mask;
+
+    while (map->slots[pos].key != HashMap::EMPTY_KEY && map->slots[pos].key != key) {
+        pos = (pos + 1) & mask;
+        map->probes++;
+    }
+
+    if (map->slots[pos].key == HashMap::EMPTY_KEY)
+        map->size++;
+
+    map->slots[pos] = {key, value};
+
+    return true;
+}
+
+/**
+ * @brief Returns slot of key, (size_t)-1 if it is not found
+ *
+ * @param probes (optional) probed slots are added to it
+ */
+static size_t hash_map_find_pos_(const HashMap* map, const uint64_t key, size_t* probes) {
+    assert(map);
+
+    size_t mask = map->capacity - 1;
+    size_t pos = hash_map_hash_(key) & mask;
+
+    size_t probed = 0;
+
+    while (map->slots[pos].key != HashMap::EMPTY_KEY) {
+        if (map->slots[pos].key == key)
+            break;
+
+        pos = (pos + 1) & mask;
+        probed++;
+    }
+
+    if (probes != nullptr)
+        *probes += probed;
+
+    return map->slots[pos].key == key ? pos : (size_t)-1;
+}
+
+uint64_t* hash_map_find(const HashMap* map, const uint64_t key) {
+    assert(map);
+
+    if (map->slots == nullptr || key == HashMap::EMPTY_KEY)
+        return nullptr;
+
+    // lookups don't change map, probes are counted for updates only
+    size_t pos = hash_map_find_pos_(map, key, nullptr);
+
+    return pos == (size_t)-1 ? nullptr : &map->slots[pos].value;
+}
+
+bool hash_map_erase(HashMap* map, const uint64_t key) {
+    assert(map);
+
+    if (map->slots == nullptr || key == HashMap::EMPTY_KEY)
+        return false;
+
+    size_t pos = hash_map_find_pos_(map, key, &map->probes);
+    if (pos == (size_t)-1)
+        return false;
+
+    // backward shift: moves following keys of the cluster to keep probe sequences unbroken
+    size_t mask = map->capacity - 1;
+    size_t hole = pos;
+    size_t i = (pos + 1) & mask;
+
+    while (map->slots[i].key != HashMap::EMPTY_KEY) {
+        size_t home = hash_map_hash_(map->slots[i].key) & mask;
+
+        // slot i may be moved to hole if its home is not in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            map->slots[hole] = map->slots[i];
+            hole = i;
+        }
+
+        i = (i + 1) & mask;
+    }
+
+    map->slots[hole].key = HashMap::EMPTY_KEY;
+    map->size--;
+
+    return true;
+}
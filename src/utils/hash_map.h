@@ -0,0 +1,87 @@
+#ifndef HASH_MAP_H_
+#define HASH_MAP_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+/**
+ * @brief Hash map slot
+ */
+struct HashMapSlot {
+    uint64_t key   = 0;
+    uint64_t value = 0;
+};
+
+/**
+ * @brief Open addressing hash map from uint64_t to uint64_t (linear probing, backward shift deletion)
+ */
+struct HashMap {
+    static const uint64_t EMPTY_KEY = (uint64_t)-1;    //< key which can't be stored
+    static const size_t MIN_CAPACITY = 16;
+
+    HashMapSlot* slots = nullptr;
+    size_t capacity = 0;    //< power of 2
+    size_t size     = 0;
+
+    size_t probes = 0;      //< total number of slots probed by updates (statistics)
+};
+
+/**
+ * @brief Hash map constructor
+ *
+ * @param map
+ * @param size_hint expected number of keys
+ * @return true success
+ * @return false allocation failure
+ */
+bool hash_map_ctor(HashMap* map, const size_t size_hint = 0);
+
+/**
+ * @brief Hash map destructor
+ *
+ * @param map
+ */
+void hash_map_dtor(HashMap* map);
+
+/**
+ * @brief Inserts key or assigns new value to existing key
+ *
+ * @param map
+ * @param key must not be HashMap::EMPTY_KEY
+ * @param value
+ * @return true success
+ * @return false allocation failure
+ */
+bool hash_map_set(HashMap* map, const uint64_t key, const uint64_t value);
+
+/**
+ * @brief Finds value by key. Map is not changed, so it may be called concurrently with other lookups
+ *
+ * @param map
+ * @param key
+ * @return uint64_t* pointer to value. nullptr if not found. Invalidated by hash_map_set() and hash_map_erase()
+ */
+uint64_t* hash_map_find(const HashMap* map, const uint64_t key);
+
+/**
+ * @brief Erases key
+ *
+ * @param map
+ * @param key
+ * @return true key was erased
+ * @return false key not found
+ */
+bool hash_map_erase(HashMap* map, const uint64_t key);
+
+/**
+ * @brief Returns memory used by map in bytes
+ *
+ * @param map
+ * @return size_t
+ */
+inline size_t hash_map_memory(const HashMap* map) {
+    return map->capacity * sizeof(HashMapSlot);
+}
+
+#endif //< #ifndef HASH_MAP_H_
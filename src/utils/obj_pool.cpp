@@ -0,0 +1,132 @@
+#include "obj_pool.h"
+
+static bool obj_pool_add_chunk_(ObjPool* pool, const size_t capacity);
+
+void obj_pool_ctor(ObjPool* pool, const size_t obj_size, const size_t chunk_capacity) {
+    assert(pool);
+    assert(obj_size >= sizeof(void*));
+    assert(chunk_capacity > 0);
+
+    pool->obj_size = (obj_size + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+    pool->chunk_capacity = chunk_capacity;
+
+    pool->chunks    = nullptr;
+    pool->free_list = nullptr;
+    pool->bump_ptr  = nullptr;
+    pool->bump_end  = nullptr;
+    pool->capacity  = 0;
+    pool->used      = 0;
+    pool->refs      = 1;
+}
+
+void obj_pool_dtor(ObjPool* pool) {
+    assert(pool);
+
+    obj_pool_free_chunks(obj_pool_detach(pool));
+}
+
+ObjPoolChunk* obj_pool_detach(ObjPool* pool) {
+    assert(pool);
+
+    ObjPoolChunk* chunks = pool->chunks;
+
+    pool->chunks    = nullptr;
+    pool->free_list = nullptr;
+    pool->bump_ptr  = nullptr;
+    pool->bump_end  = nullptr;
+    pool->capacity  = 0;
+    pool->used      = 0;
+
+    return chunks;
+}
+
+void obj_pool_free_chunks(ObjPoolChunk* chunks) {
+    while (chunks != nullptr) {
+        ObjPoolChunk* next = chunks->next;
+        free(chunks);
+        chunks = next;
+    }
+}
+
+static bool obj_pool_add_chunk_(ObjPool* pool, const size_t capacity) {
+    assert(pool);
+    assert(capacity > 0);
+
+    ObjPoolChunk* chunk = (ObjPoolChunk*)malloc(sizeof(ObjPoolChunk) + capacity * pool->obj_size);
+    if (chunk == nullptr)
+        return false;
+
+    chunk->capacity = capacity;
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    // objects left in previous chunk bump area go to free list
+    while (pool->bump_ptr < pool->bump_end) {
+        *(void**)pool->bump_ptr = pool->free_list;
+        pool->free_list = pool->bump_ptr;
+        pool->bump_ptr += pool->obj_size;
+    }
+
+    pool->bump_ptr = (char*)(chunk + 1);
+    pool->bump_end = pool->bump_ptr + capacity * pool->obj_size;
+
+    pool->capacity += capacity;
+
+    return true;
+}
+
+void* obj_pool_alloc(ObjPool* pool) {
+    assert(pool);
+    assert(pool->obj_size);
+
+    void* obj = nullptr;
+
+    if (pool->free_list != nullptr) {
+        obj = pool->free_list;
+        pool->free_list = *(void**)obj;
+
+    } else {
+        if (pool->bump_ptr == pool->bump_end) {
+            if (!obj_pool_add_chunk_(pool, pool->chunk_capacity))
+                return nullptr;
+
+            if (pool->chunk_capacity < ObjPool::MAX_CHUNK_CAPACITY)
+                pool->chunk_capacity *= 2;
+        }
+
+        obj = pool->bump_ptr;
+        pool->bump_ptr += pool->obj_size;
+    }
+
+    pool->used++;
+
+    return obj;
+}
+
+void obj_pool_free(ObjPool* pool, void* obj) {
+    assert(pool);
+    assert(pool->used > 0);
+
+    if (obj == nullptr)
+        return;
+
+    *(void**)obj = pool->free_list;
+    pool->free_list = obj;
+
+    pool->used--;
+}
+
+bool obj_pool_reserve(ObjPool* pool, const size_t n) {
+    assert(pool);
+    assert(pool->obj_size);
+
+    size_t free_cnt = obj_pool_free_cnt(pool);
+    if (free_cnt >= n)
+        return true;
+
+    size_t new_chunk_capacity = n - free_cnt;
+    if (new_chunk_capacity < pool->chunk_capacity)
+        new_chunk_capacity = pool->chunk_capacity;
+
+    return obj_pool_add_chunk_(pool, new_chunk_capacity);
+}
@@ -0,0 +1,109 @@
+#ifndef OBJ_POOL_H_
+#define OBJ_POOL_H_
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+
+/**
+ * @brief Chunk header. Objects are placed right after it
+ */
+struct ObjPoolChunk {
+    ObjPoolChunk* next = nullptr;   //< next chunk in pool
+    size_t capacity = 0;            //< number of objects in chunk
+};
+
+/**
+ * @brief Slab allocator for fixed size objects.
+ * Freed objects are kept in intrusive free list and reused
+ */
+struct ObjPool {
+    static const size_t DEFAULT_CHUNK_CAPACITY = 64;        //< objects in the first chunk
+    static const size_t MAX_CHUNK_CAPACITY     = 1 << 16;   //< chunk capacity growth limit
+
+    size_t obj_size = 0;            //< object size (rounded up to alignment)
+    size_t chunk_capacity = 0;      //< capacity of next allocated chunk
+
+    ObjPoolChunk* chunks = nullptr; //< list of allocated chunks
+
+    void* free_list = nullptr;      //< intrusive list of freed objects
+
+    char* bump_ptr = nullptr;       //< first never used object in last chunk
+    char* bump_end = nullptr;       //< end of last chunk
+
+    size_t capacity = 0;            //< total number of objects in all chunks
+    size_t used     = 0;            //< number of allocated objects
+
+    size_t refs = 0;                //< number of owners (pool may be shared)
+};
+
+/**
+ * @brief Pool constructor
+ *
+ * @param pool
+ * @param obj_size must be not less than sizeof(void*)
+ * @param chunk_capacity number of objects in the first chunk
+ */
+void obj_pool_ctor(ObjPool* pool, const size_t obj_size,
+                   const size_t chunk_capacity = ObjPool::DEFAULT_CHUNK_CAPACITY);
+
+/**
+ * @brief Pool destructor. Releases all chunks at once
+ *
+ * @param pool
+ */
+void obj_pool_dtor(ObjPool* pool);
+
+/**
+ * @brief Detaches all chunks from pool. Pool becomes empty, but keeps its settings.
+ * All objects become invalid
+ *
+ * @param pool
+ * @return ObjPoolChunk* chunks chain (linked by ObjPoolChunk::next), each chunk is malloc'ed block
+ */
+ObjPoolChunk* obj_pool_detach(ObjPool* pool);
+
+/**
+ * @brief Frees chunks chain returned by obj_pool_detach()
+ *
+ * @param chunks
+ */
+void obj_pool_free_chunks(ObjPoolChunk* chunks);
+
+/**
+ * @brief Returns memory for one object
+ *
+ * @param pool
+ * @return void* nullptr if chunk can't be allocated
+ */
+void* obj_pool_alloc(ObjPool* pool);
+
+/**
+ * @brief Returns object to free list
+ *
+ * @param pool
+ * @param obj
+ */
+void obj_pool_free(ObjPool* pool, void* obj);
+
+/**
+ * @brief Makes sure that next n allocations won't call malloc
+ *
+ * @param pool
+ * @param n
+ * @return true success
+ * @return false failure
+ */
+bool obj_pool_reserve(ObjPool* pool, const size_t n);
+
+/**
+ * @brief Returns number of objects that can be allocated without new chunks
+ *
+ * @param pool
+ * @return size_t
+ */
+inline size_t obj_pool_free_cnt(const ObjPool* pool) {
+    return pool->capacity - pool->used;
+}
+
+#endif //< #ifndef OBJ_POOL_H_
@@ -1,46 +1,196 @@
 #include "ptr_valid.h"
 
-#ifdef LINUX_MANUAL_PTR_VALIDATION
+#if defined(__linux__) || defined(LINUX_MANUAL_PTR_VALIDATION)
 
-bool is_ptr_valid(void* p) {
+/**
+ * @brief Writable address range [begin, end)
+ */
+struct MemRange {
     uintptr_t begin = 0;
-    uintptr_t end = 0;
+    uintptr_t end   = 0;
+};
 
-    char readable   = '\0';
-    char writable   = '\0';
-    char executable = '\0';
-    char mapped     = '\0';
+/**
+ * @brief Cached writable mappings of /proc/self/maps. Sorted, adjacent ranges are merged
+ */
+struct MemMap {
+    MemRange* ranges = nullptr;
+    size_t size      = 0;
+    size_t capacity  = 0;
 
-    FILE* file = fopen("/proc/self/maps", "r");
+    void* brk = nullptr;    //< program break at the moment of parsing
 
-    if (!file)
+    bool is_valid = false;
+
+    pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+};
+
+static MemMap mem_map = {};
+
+static bool mem_map_push_(MemMap* map, uintptr_t begin, uintptr_t end) {
+    assert(map);
+
+    if (map->size > 0 && map->ranges[map->size - 1].end == begin) {
+        map->ranges[map->size - 1].end = end;
+        return true;
+    }
+
+    if (map->size == map->capacity) {
+        size_t new_capacity = map->capacity ? map->capacity * 2 : 64;
+
+        MemRange* new_ranges = (MemRange*)realloc(map->ranges, new_capacity * sizeof(MemRange));
+        if (new_ranges == nullptr)
+            return false;
+
+        map->ranges   = new_ranges;
+        map->capacity = new_capacity;
+    }
+
+    map->ranges[map->size++] = {begin, end};
+
+    return true;
+}
+
+static bool mem_map_parse_(MemMap* map) {
+    assert(map);
+
+    map->size = 0;
+    map->is_valid = false;
+
+    int fd = open("/proc/self/maps", O_RDONLY);
+    if (fd == -1)
         return false;
 
-    while (fscanf(file, "%" SCNxPTR "-%" SCNxPTR " %c%c%c%c",
-            &begin, &end, &readable, &writable, &executable, &mapped) == 6) {
+    // called under write lock only
+    static const size_t BUF_SIZE = 1 << 16;
+    static char buf[BUF_SIZE] = {};
+    size_t buf_len = 0;
+
+    bool ret = true;
+
+    while (true) {
+        ssize_t read_len = read(fd, buf + buf_len, BUF_SIZE - 1 - buf_len);
+        if (read_len < 0) {
+            ret = false;
+            break;
+        }
+
+        buf_len += (size_t)read_len;
+        buf[buf_len] = '\0';
+
+        // parse only complete lines, the rest is moved to buffer beginning
+        char* line = buf;
+        char* line_end = nullptr;
+        while ((line_end = strchr(line, '\n')) != nullptr) {
+            char* str = line;
+
+            uintptr_t begin = (uintptr_t)strtoull(str, &str, 16);
+            uintptr_t end   = (uintptr_t)strtoull(str + 1, &str, 16);
+
+            if (str[0] == ' ' && str[2] == 'w' && !mem_map_push_(map, begin, end)) {
+                ret = false;
+                break;
+            }
+
+            line = line_end + 1;
+        }
+
+        buf_len -= (size_t)(line - buf);
+        memmove(buf, line, buf_len);
+
+        if (!ret || read_len == 0)
+            break;
+    }
+
+    close(fd);
+
+    map->brk = sbrk(0);
+    map->is_valid = ret;
+
+    return ret;
+}
+
+static bool mem_map_find_(const MemMap* map, uintptr_t p) {
+    assert(map);
+
+    size_t left = 0;
+    size_t right = map->size;
 
-        if (begin <= (uintptr_t)p && (uintptr_t)p < end) {
-            fclose(file);
+    while (left < right) {
+        size_t mid = left + (right - left) / 2;
+
+        if (map->ranges[mid].end <= p)
+            left = mid + 1;
+        else
+            right = mid;
+    }
+
+    return left < map->size && map->ranges[left].begin <= p;
+}
 
-            return writable == 'w';
+static bool mem_map_is_actual_(const MemMap* map) {
+    return map->is_valid && map->brk == sbrk(0);
+}
+
+/**
+ * @brief Looks for p in cache. On cache miss (or if heap has grown) reparses maps once
+ * Takes read lock inside, may upgrade it to write lock
+ */
+static size_t mem_map_first_invalid_(const void* const* ptrs, const size_t n) {
+    assert(ptrs);
+
+    pthread_rwlock_rdlock(&mem_map.lock);
+
+    bool refreshed = false;
+    size_t i = 0;
+
+    while (i < n) {
+        if (mem_map_is_actual_(&mem_map) && mem_map_find_(&mem_map, (uintptr_t)ptrs[i])) {
+            i++;
+            continue;
         }
 
-        int c = '\0';
-        do {
-            c = fgetc(file);
-        } while (c != '\n' && c != EOF);
+        if (refreshed)
+            break;
+
+        pthread_rwlock_unlock(&mem_map.lock);
+        pthread_rwlock_wrlock(&mem_map.lock);
+
+        mem_map_parse_(&mem_map);
+        refreshed = true;
+
+        pthread_rwlock_unlock(&mem_map.lock);
+        pthread_rwlock_rdlock(&mem_map.lock);
     }
 
-    fclose(file);
+    pthread_rwlock_unlock(&mem_map.lock);
+
+    return i;
+}
+
+bool is_ptr_valid(const void* p) {
+    return mem_map_first_invalid_(&p, 1) == 1;
+}
 
-    return false;
+size_t ptrs_first_invalid(const void* const* ptrs, const size_t n) {
+    assert(ptrs);
 
+    return mem_map_first_invalid_(ptrs, n);
 }
-#else // #ifndef LINUX_MANUAL_PTR_VALIDATION
+
+void ptr_valid_reset_cache() {
+    pthread_rwlock_wrlock(&mem_map.lock);
+
+    mem_map.is_valid = false;
+
+    pthread_rwlock_unlock(&mem_map.lock);
+}
+
+#else // #if !defined(__linux__) && !defined(LINUX_MANUAL_PTR_VALIDATION)
 
 #ifdef _WIN32
 
-bool is_ptr_valid(void* p) {
+bool is_ptr_valid(const void* p) {
     // Thanks to God-blessed library "TxLib.h"
 
     MEMORY_BASIC_INFORMATION mbi = {};
@@ -59,7 +209,7 @@ bool is_ptr_valid(void* p) {
 #if defined(unix) || defined(__APPLE__)
 
 
-bool is_ptr_valid(void* p) {
+bool is_ptr_valid(const void* p) {
     char filename[] = "/tmp/kurwa_ptr.XXXXXX";
     int file = mkstemp(filename);
 
@@ -93,6 +243,20 @@ bool is_ptr_valid(void* p) {
 
 #endif // #ifdef _WIN32
 
-#endif // #ifdef LINUX_MANUAL_PTR_VALIDATION
+#endif // #if defined(__linux__) || defined(LINUX_MANUAL_PTR_VALIDATION)
+
+#if !defined(__linux__) && !defined(LINUX_MANUAL_PTR_VALIDATION)
+
+size_t ptrs_first_invalid(const void* const* ptrs, const size_t n) {
+    assert(ptrs);
+
+    for (size_t i = 0; i < n; i++)
+        if (!is_ptr_valid(ptrs[i]))
+            return i;
+
+    return n;
+}
 
+void ptr_valid_reset_cache() {}
 
+#endif // #if !defined(__linux__) && !defined(LINUX_MANUAL_PTR_VALIDATION)
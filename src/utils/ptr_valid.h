@@ -3,13 +3,19 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stddef.h>
 
-#ifdef LINUX_MANUAL_PTR_VALIDATION
+#if defined(__linux__) || defined(LINUX_MANUAL_PTR_VALIDATION)
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
 
-#else // #ifndef LINUX_MANUAL_PTR_VALIDATION
+#else // #if !defined(__linux__) && !defined(LINUX_MANUAL_PTR_VALIDATION)
 
 #ifdef _WIN32
 
@@ -29,16 +35,33 @@
 
 #endif // #ifdef _WIN32
 
-#endif // #ifdef LINUX_MANUAL_PTR_VALIDATION
+#endif // #if defined(__linux__) || defined(LINUX_MANUAL_PTR_VALIDATION)
 
 
 /**
  * @brief Checks if pointer is valid for access in mode
  *
+ * @attention On Linux writable mappings are parsed from /proc/self/maps once and cached.
+ * Cache is refreshed when lookup misses or heap grows
+ *
  * @param p pointer
  * @return true is valid
  * @return false is not valid
  */
-bool is_ptr_valid(void* p);
+bool is_ptr_valid(const void* p);
+
+/**
+ * @brief Checks array of pointers in one call
+ *
+ * @param ptrs
+ * @param n
+ * @return size_t index of the first invalid pointer. n if all pointers are valid
+ */
+size_t ptrs_first_invalid(const void* const* ptrs, const size_t n);
+
+/**
+ * @brief Drops cached address space map (if there is one). Call it after munmap()
+ */
+void ptr_valid_reset_cache();
 
 #endif /// #ifndef PTR_VALID_H_
@@ -0,0 +1,227 @@
+#include "simd_search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_SEARCH_X86
+#include <immintrin.h>
+#endif //< #if defined(__x86_64__) || defined(__i386__)
+
+typedef size_t (*IntFindFirst_t)(const int* arr, const size_t n, const int value);
+typedef size_t (*IntCount_t)    (const int* arr, const size_t n, const int value);
+
+static size_t int_find_first_scalar_(const int* arr, const size_t n, const int value) {
+    for (size_t i = 0; i < n; i++)
+        if (arr[i] == value)
+            return i;
+
+    return n;
+}
+
+static size_t int_count_scalar_(const int* arr, const size_t n, const int value) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; i++)
+        count += arr[i] == value;
+
+    return count;
+}
+
+#ifdef SIMD_SEARCH_X86
+
+// counters in vector lanes are flushed every COUNT_BLOCK iterations to avoid int32 overflow
+static const size_t COUNT_BLOCK = 1 << 24;
+
+__attribute__((target("sse2")))
+static size_t int_find_first_sse2_(const int* arr, const size_t n, const int value) {
+    const __m128i needle = _mm_set1_epi32(value);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i eq0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(arr + i)),     needle);
+        __m128i eq1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(arr + i + 4)), needle);
+
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq0)) |
+                   _mm_movemask_ps(_mm_castsi128_ps(eq1)) << 4;
+
+        if (mask != 0)
+            return i + (size_t)__builtin_ctz((unsigned)mask);
+    }
+
+    return i + int_find_first_scalar_(arr + i, n - i, value);
+}
+
+__attribute__((target("sse2")))
+static size_t int_count_sse2_(const int* arr, const size_t n, const int value) {
+    const __m128i needle = _mm_set1_epi32(value);
+
+    size_t count = 0;
+    size_t i = 0;
+
+    while (i + 4 <= n) {
+        __m128i sum = _mm_setzero_si128();
+
+        // cmpeq gives -1 for every match
+        for (size_t block = 0; block < COUNT_BLOCK && i + 4 <= n; block++, i += 4)
+            sum = _mm_sub_epi32(sum, _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(arr + i)), needle));
+
+        int lanes[4] = {};
+        _mm_storeu_si128((__m128i*)lanes, sum);
+
+        count += (size_t)(unsigned)lanes[0] + (size_t)(unsigned)lanes[1] +
+                 (size_t)(unsigned)lanes[2] + (size_t)(unsigned)lanes[3];
+    }
+
+    return count + int_count_scalar_(arr + i, n - i, value);
+}
+
+__attribute__((target("avx2")))
+static size_t int_find_first_avx2_(const int* arr, const size_t n, const int value) {
+    const __m256i needle = _mm256_set1_epi32(value);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i eq0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(arr + i)),     needle);
+        __m256i eq1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(arr + i + 8)), needle);
+
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(eq0)) |
+                        (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(eq1)) << 8;
+
+        if (mask != 0)
+            return i + (size_t)__builtin_ctz(mask);
+    }
+
+    return i + int_find_first_sse2_(arr + i, n - i, value);
+}
+
+__attribute__((target("avx2")))
+static size_t int_count_avx2_(const int* arr, const size_t n, const int value) {
+    const __m256i needle = _mm256_set1_epi32(value);
+
+    size_t count = 0;
+    size_t i = 0;
+
+    while (i + 16 <= n) {
+        __m256i sum0 = _mm256_setzero_si256();
+        __m256i sum1 = _mm256_setzero_si256();
+
+        for (size_t block = 0; block < COUNT_BLOCK && i + 16 <= n; block++, i += 16) {
+            sum0 = _mm256_sub_epi32(sum0, _mm256_cmpeq_epi32(
+                                    _mm256_loadu_si256((const __m256i*)(arr + i)),     needle));
+            sum1 = _mm256_sub_epi32(sum1, _mm256_cmpeq_epi32(
+                                    _mm256_loadu_si256((const __m256i*)(arr + i + 8)), needle));
+        }
+
+        int lanes[8] = {};
+        _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi32(sum0, sum1));
+
+        for (size_t lane = 0; lane < 8; lane++)
+            count += (size_t)(unsigned)lanes[lane];
+    }
+
+    return count + int_count_sse2_(arr + i, n - i, value);
+}
+
+#endif //< #ifdef SIMD_SEARCH_X86
+
+/**
+ * @brief Kernels dispatch table
+ */
+struct SimdKernels {
+    SimdLevel level;
+
+    IntFindFirst_t find_first;
+    IntCount_t     count;
+};
+
+// tables are constant initialised, so they may be used before dynamic initialisation
+static const SimdKernels KERNELS_SCALAR = {SIMD_SCALAR, int_find_first_scalar_, int_count_scalar_};
+
+#ifdef SIMD_SEARCH_X86
+static const SimdKernels KERNELS_SSE2   = {SIMD_SSE2,   int_find_first_sse2_,   int_count_sse2_};
+static const SimdKernels KERNELS_AVX2   = {SIMD_AVX2,   int_find_first_avx2_,   int_count_avx2_};
+#endif //< #ifdef SIMD_SEARCH_X86
+
+// current table, nullptr - not chosen yet. Whole table is published by one atomic pointer store,
+// so threads never see level and kernels of different tables
+static const SimdKernels* kernels = nullptr;
+
+SimdLevel simd_detect_level() {
+#ifdef SIMD_SEARCH_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+
+    if (__builtin_cpu_supports("sse2"))
+        return SIMD_SSE2;
+#endif //< #ifdef SIMD_SEARCH_X86
+
+    return SIMD_SCALAR;
+}
+
+/**
+ * @brief Returns table of level limited by simd_detect_level()
+ */
+static const SimdKernels* simd_choose_kernels_(const SimdLevel level) {
+    SimdLevel detected = simd_detect_level();
+    SimdLevel new_level = level < detected ? level : detected;
+
+    switch (new_level) {
+#ifdef SIMD_SEARCH_X86
+        case SIMD_AVX2:
+            return &KERNELS_AVX2;
+
+        case SIMD_SSE2:
+            return &KERNELS_SSE2;
+#else //< #ifndef SIMD_SEARCH_X86
+        case SIMD_AVX2:
+        case SIMD_SSE2:
+#endif //< #ifdef SIMD_SEARCH_X86
+        case SIMD_SCALAR:
+            return &KERNELS_SCALAR;
+
+        default:
+            assert(0 && "Invalid SimdLevel");
+            return &KERNELS_SCALAR;
+    }
+}
+
+/**
+ * @brief Returns current table. The first call chooses the best one, concurrent first calls
+ * publish the same table and simd_set_level() choice isn't overwritten
+ */
+static inline const SimdKernels* simd_kernels_() {
+    const SimdKernels* table = __atomic_load_n(&kernels, __ATOMIC_ACQUIRE);
+    if (table != nullptr)
+        return table;
+
+    const SimdKernels* best = simd_choose_kernels_(SIMD_AVX2);
+
+    if (__atomic_compare_exchange_n(&kernels, &table, best, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return best;
+
+    return table;   //< chosen by other thread
+}
+
+SimdLevel simd_set_level(const SimdLevel level) {
+    const SimdKernels* table = simd_choose_kernels_(level);
+
+    __atomic_store_n(&kernels, table, __ATOMIC_RELEASE);
+
+    return table->level;
+}
+
+SimdLevel simd_get_level() {
+    return simd_kernels_()->level;
+}
+
+size_t int_find_first(const int* arr, const size_t n, const int value) {
+    assert(arr || n == 0);
+
+    return simd_kernels_()->find_first(arr, n, value);
+}
+
+size_t int_count(const int* arr, const size_t n, const int value) {
+    assert(arr || n == 0);
+
+    return simd_kernels_()->count(arr, n, value);
+}
@@ -0,0 +1,73 @@
+#ifndef SIMD_SEARCH_H_
+#define SIMD_SEARCH_H_
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+
+/**
+ * @brief Search kernels implementations
+ */
+enum SimdLevel {
+    SIMD_SCALAR = 0,    //< plain loop
+    SIMD_SSE2   = 1,    //< 4 ints per compare
+    SIMD_AVX2   = 2,    //< 8 ints per compare
+};
+
+/**
+ * @brief Returns index of the first value in array
+ *
+ * @param arr
+ * @param n
+ * @param value
+ * @return size_t n if not found
+ */
+size_t int_find_first(const int* arr, const size_t n, const int value);
+
+/**
+ * @brief Returns number of values in array
+ *
+ * @param arr
+ * @param n
+ * @param value
+ * @return size_t
+ */
+size_t int_count(const int* arr, const size_t n, const int value);
+
+/**
+ * @brief Returns true if there is value in array
+ *
+ * @param arr
+ * @param n
+ * @param value
+ * @return true
+ * @return false
+ */
+inline bool int_contains(const int* arr, const size_t n, const int value) {
+    return int_find_first(arr, n, value) != n;
+}
+
+/**
+ * @brief Returns the best implementation supported by CPU
+ *
+ * @return SimdLevel
+ */
+SimdLevel simd_detect_level();
+
+/**
+ * @brief Returns implementation used by kernels
+ *
+ * @return SimdLevel
+ */
+SimdLevel simd_get_level();
+
+/**
+ * @brief Forces implementation (e.g. for benchmarks). Level is limited by simd_detect_level().
+ * Kernels are switched atomically, so it may be called while other threads search
+ *
+ * @param level
+ * @return SimdLevel actually set level
+ */
+SimdLevel simd_set_level(const SimdLevel level);
+
+#endif //< #ifndef SIMD_SEARCH_H_
@@ -0,0 +1,134 @@
+#include <unistd.h>
+
+#include "thread_pool.h"
+#include "macros.h"
+
+/**
+ * @brief Current run. Tasks are taken by index, workers join run while it has free places
+ */
+struct ThreadPoolJob {
+    ThreadPoolTask task = nullptr;
+    void* arg = nullptr;
+
+    size_t n    = 0;
+    size_t next = 0;        //< next task index (taken atomically)
+
+    size_t places = 0;      //< number of workers that may still join
+    size_t active = 0;      //< workers that joined and are not finished
+
+    size_t generation = 0;  //< run number, so worker joins each run once
+};
+
+struct ThreadPool {
+    pthread_mutex_t run_mutex = PTHREAD_MUTEX_INITIALIZER;     //< one run at a time
+
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t  has_job  = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t  job_done = PTHREAD_COND_INITIALIZER;
+
+    ThreadPoolJob job = {};
+
+    size_t workers = 0;
+    bool is_failed = false;     //< worker can't be started, no more attempts
+};
+
+static ThreadPool thread_pool = {};
+
+static void thread_pool_work_(ThreadPoolJob* job) {
+    assert(job);
+
+    size_t i = 0;
+    while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->n)
+        job->task(job->arg, i);
+}
+
+static void* thread_pool_worker_(void*) {
+    size_t generation = 0;
+
+    pthread_mutex_lock(&thread_pool.mutex);
+
+    while (true) {
+        while (thread_pool.job.places == 0 || thread_pool.job.generation == generation)
+            pthread_cond_wait(&thread_pool.has_job, &thread_pool.mutex);
+
+        generation = thread_pool.job.generation;
+        thread_pool.job.places--;
+        thread_pool.job.active++;
+
+        pthread_mutex_unlock(&thread_pool.mutex);
+
+        thread_pool_work_(&thread_pool.job);
+
+        pthread_mutex_lock(&thread_pool.mutex);
+
+        if (--thread_pool.job.active == 0)
+            pthread_cond_signal(&thread_pool.job_done);
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Starts workers up to count. Must be called under mutex
+ */
+static void thread_pool_start_(const size_t count) {
+    while (thread_pool.workers < count && !thread_pool.is_failed) {
+        pthread_t thread = {};
+        if (pthread_create(&thread, nullptr, thread_pool_worker_, nullptr) != 0) {
+            thread_pool.is_failed = true;
+            break;
+        }
+
+        pthread_detach(thread);
+        thread_pool.workers++;
+    }
+}
+
+void thread_pool_run(ThreadPoolTask task, void* arg, const size_t n, const size_t threads) {
+    assert(task);
+
+    size_t threads_cnt = (threads == 0) ? thread_pool_cpus() : threads;
+    threads_cnt = MIN(MIN(threads_cnt, n), ThreadPoolSettings::MAX_THREADS);
+
+    if (threads_cnt <= 1 || pthread_mutex_trylock(&thread_pool.run_mutex) != 0) {
+        for (size_t i = 0; i < n; i++)
+            task(arg, i);
+
+        return;
+    }
+
+    pthread_mutex_lock(&thread_pool.mutex);
+
+    thread_pool_start_(threads_cnt - 1);
+
+    ThreadPoolJob* job = &thread_pool.job;
+
+    job->task   = task;
+    job->arg    = arg;
+    job->n      = n;
+    job->next   = 0;
+    job->places = MIN(threads_cnt - 1, thread_pool.workers);
+    job->generation++;
+
+    pthread_cond_broadcast(&thread_pool.has_job);
+    pthread_mutex_unlock(&thread_pool.mutex);
+
+    thread_pool_work_(job);
+
+    pthread_mutex_lock(&thread_pool.mutex);
+
+    // all tasks are taken, late workers must not join
+    job->places = 0;
+    while (job->active > 0)
+        pthread_cond_wait(&thread_pool.job_done, &thread_pool.mutex);
+
+    pthread_mutex_unlock(&thread_pool.mutex);
+
+    pthread_mutex_unlock(&thread_pool.run_mutex);
+}
+
+size_t thread_pool_cpus() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cpus > 0 ? (size_t)cpus : 1;
+}
@@ -0,0 +1,34 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include <pthread.h>
+
+struct ThreadPoolSettings {
+    static const size_t MAX_THREADS = 64;   //< workers and calling thread
+};
+
+typedef void (*ThreadPoolTask)(void* arg, size_t i);
+
+/**
+ * @brief Calls task(arg, i) for every i in [0, n) on pool workers and calling thread.
+ * Returns when all calls are finished. Workers are started on first use.
+ * If pool is busy with other run (or workers can't be started), tasks are run in calling thread
+ *
+ * @param task
+ * @param arg
+ * @param n
+ * @param threads maximal number of threads (including calling one), 0 - number of CPUs
+ */
+void thread_pool_run(ThreadPoolTask task, void* arg, const size_t n, const size_t threads = 0);
+
+/**
+ * @brief Returns number of online CPUs
+ *
+ * @return size_t
+ */
+size_t thread_pool_cpus();
+
+#endif //< #ifndef THREAD_POOL_H_
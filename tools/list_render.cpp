@@ -0,0 +1,48 @@
+#include "../src/list_snapshot.h"
+
+LogFileData log_file = {"log"};
+
+/**
+ * @brief Renders binary list_dump() snapshots to html log with svg graphs
+ *
+ * Usage: list_render <snapshots file> [log dir]
+ */
+int main(int argc, const char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <snapshots file> [log dir]\n", argv[0]);
+        return 1;
+    }
+
+    if (argc > 2)
+        log_file.dir = argv[2];
+
+    FILE* file = fopen(argv[1], "rb");
+    if (file == nullptr) {
+        perror("Error opening snapshots file");
+        return 1;
+    }
+
+    if (!log_open_file(&log_file, "wb")) {
+        fclose(file);
+        return 1;
+    }
+
+    size_t rendered = 0;
+
+    ListSnapshot snapshot = {};
+    while (list_snapshot_read(file, &snapshot)) {
+        list_snapshot_render(&snapshot);
+        list_snapshot_dtor(&snapshot);
+
+        rendered++;
+    }
+
+    fclose(file);
+
+    graph_render_flush();
+    log_close_file(&log_file);
+
+    printf("%zu snapshots rendered to %slog.html\n", rendered, log_file.timestamp_dir);
+
+    return 0;
+}